@@ -0,0 +1,161 @@
+#include "AsyncVectorOperations.h"
+#include "SimdKernels.h"
+#include <numeric>
+#include <algorithm>
+
+AsyncVectorOperations::AsyncVectorOperations(ThreadPool& pool) : pool(pool) {
+	dispatcher = std::thread(&AsyncVectorOperations::DispatcherLoop, this);
+}
+
+AsyncVectorOperations::~AsyncVectorOperations() {
+	std::deque<PendingJob> left;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stop = true;
+		stopping = true;
+		left.swap(queue);
+	}
+	cv.notify_all();
+	for (PendingJob& job : left) {
+		job.value ? job.value->Finish(nullptr) : job.written->Finish(nullptr);
+	}
+	dispatcher.join();
+}
+
+void AsyncVectorOperations::Submit(PendingJob job) {
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		queue.push_back(std::move(job));
+	}
+	cv.notify_one();
+}
+
+// Method (47) Asynchronous sum
+AsyncJob<double> AsyncVectorOperations::sum(std::span<const double> data) {
+	auto state = std::make_shared<AsyncState<double>>();
+	Submit({ JobKind::Sum, data, {}, state, nullptr });
+	return AsyncJob<double>(state);
+}
+
+// Method (48) Asynchronous product
+AsyncJob<double> AsyncVectorOperations::product(std::span<const double> data) {
+	auto state = std::make_shared<AsyncState<double>>();
+	Submit({ JobKind::Product, data, {}, state, nullptr });
+	return AsyncJob<double>(state);
+}
+
+// Method (49) Asynchronous adjacent difference
+AsyncJob<bool> AsyncVectorOperations::adjacent_difference(std::span<const double> data, std::span<double> out) {
+	auto state = std::make_shared<AsyncState<bool>>();
+	if (out.size() != data.size()) {
+		const bool written = false;
+		state->Finish(&written);
+		return AsyncJob<bool>(state);
+	}
+	Submit({ JobKind::AdjDiff, data, out, nullptr, state });
+	return AsyncJob<bool>(state);
+}
+
+void AsyncVectorOperations::Pause() {
+	std::lock_guard<std::mutex> lock(mtx);
+	paused = true;
+}
+
+void AsyncVectorOperations::Resume() {
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		paused = false;
+	}
+	cv.notify_one();
+}
+
+namespace
+{
+	template <typename T>
+	bool CancelRequested(const std::shared_ptr<AsyncState<T>>& state) {
+		return state->cancel_requested.load(std::memory_order_relaxed);
+	}
+}
+
+// Takes the oldest job and every queued job on the same input, and runs them as one batch;
+// queued jobs already cancelled are finished without a pass
+void AsyncVectorOperations::DispatcherLoop() {
+	for (;;) {
+		std::vector<PendingJob> batch;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			cv.wait(lock, [&] { return stop || (!paused && !queue.empty()); });
+			if (stop) {
+				return;
+			}
+			const std::span<const double> input = queue.front().data;
+			auto same = [&](const PendingJob& job) { return job.data.data() == input.data() && job.data.size() == input.size(); };
+			std::copy_if(queue.begin(), queue.end(), std::back_inserter(batch), same);
+			queue.erase(std::remove_if(queue.begin(), queue.end(), same), queue.end());
+		}
+		std::vector<PendingJob> live;
+		for (PendingJob& job : batch) {
+			if (job.value ? CancelRequested(job.value) : CancelRequested(job.written)) {
+				job.value ? job.value->Finish(nullptr) : job.written->Finish(nullptr);
+			}
+			else {
+				live.push_back(job);
+			}
+		}
+		if (!live.empty()) {
+			RunBatch(live);
+		}
+	}
+}
+
+// One pass over the batch's input in work-stealing chunks: each chunk is summed, multiplied and differenced for the
+// jobs that need it while it is in cache. The pass stops early once every job of the batch is cancelled.
+void AsyncVectorOperations::RunBatch(const std::vector<PendingJob>& batch) {
+	const std::span<const double> data = batch.front().data;
+	bool NeedSum = false, NeedProduct = false;
+	for (const PendingJob& job : batch) {
+		NeedSum |= job.kind == JobKind::Sum;
+		NeedProduct |= job.kind == JobKind::Product;
+	}
+	auto Cancelled = [](const PendingJob& job) { return job.value ? CancelRequested(job.value) : CancelRequested(job.written); };
+	auto Live = [&] { return !stopping.load(std::memory_order_relaxed) && !std::all_of(batch.begin(), batch.end(), Cancelled); };
+	const std::size_t grain = AdaptiveGrain(data.size(), sizeof(double), pool.size());
+	const std::size_t NumOfChunks = NumOfGrains(data.size(), grain);
+	std::vector<double> Partial_Sums(NeedSum ? NumOfChunks : 0), Partial_Products(NeedProduct ? NumOfChunks : 0, 1.0);
+	std::atomic<bool> abandoned{false};
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelForStealing(NumOfChunks, [&](std::size_t chunk) {
+		if (abandoned.load(std::memory_order_relaxed) || !Live()) {
+			abandoned.store(true, std::memory_order_relaxed);
+			return;
+		}
+		const std::size_t start = chunk * grain, n = std::min(data.size(), start + grain) - start;
+		if (NeedSum) {
+			Partial_Sums[chunk] = kernels.sum(data.data() + start, n);
+		}
+		if (NeedProduct) {
+			Partial_Products[chunk] = kernels.product(data.data() + start, n);
+		}
+		for (const PendingJob& job : batch) {
+			if (job.kind == JobKind::AdjDiff && !Cancelled(job)) {
+				job.out[start] = start == 0 ? data[0] : data[start] - data[start - 1];
+				kernels.adjacent_difference(data.data() + start, n, job.out.data() + start);
+			}
+		}
+		});
+	++passes;
+	const double sum = std::accumulate(Partial_Sums.begin(), Partial_Sums.end(), 0.0);
+	const double product = std::accumulate(Partial_Products.begin(), Partial_Products.end(), 1.0, std::multiplies<double>());
+	const bool written = true;
+	for (const PendingJob& job : batch) {
+		if (abandoned || Cancelled(job)) {
+			job.value ? job.value->Finish(nullptr) : job.written->Finish(nullptr);
+		}
+		else if (job.kind == JobKind::AdjDiff) {
+			job.written->Finish(&written);
+		}
+		else {
+			job.value->Finish(job.kind == JobKind::Sum ? &sum : &product);
+		}
+	}
+}
@@ -0,0 +1,165 @@
+#ifndef ASYNCVECTOROPERATIONS_H
+#define ASYNCVECTOROPERATIONS_H
+
+#include "ThreadPool.h"
+#include <span>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <coroutine>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+// Result of an asynchronous job, shared by the library and every copy of the AsyncJob handle
+template <typename T>
+struct AsyncState {
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+    bool cancelled = false;
+    std::atomic<bool> cancel_requested{false};
+    T value{};
+    std::vector<std::function<void()>> callbacks;
+
+    // Finishes the job, with a value or cancelled; false (and nothing changes) if it was already finished
+    bool Finish(const T* result) {
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (done) {
+                return false;
+            }
+            done = true;
+            cancelled = result == nullptr;
+            if (result != nullptr) {
+                value = *result;
+            }
+            ready.swap(callbacks);
+        }
+        cv.notify_all();
+        for (auto& callback : ready) {
+            callback();
+        }
+        return true;
+    }
+    bool IsDone() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return done;
+    }
+};
+
+// Handle to a job submitted to AsyncVectorOperations. Get() waits for it; OnComplete() registers a callback;
+// co_await job suspends a coroutine until it finishes. A cancelled job gives std::nullopt.
+// Callbacks and resumed coroutines run on the dispatcher thread of the AsyncVectorOperations object (or on the
+// thread that registers them, if the job already finished). They must not wait for other jobs of the same
+// object: post to your own event loop instead.
+template <typename T>
+class AsyncJob {
+public:
+    explicit AsyncJob(std::shared_ptr<AsyncState<T>> state) : state(std::move(state)) {}
+
+    bool Ready() const { return state->IsDone(); }
+    void Wait() const {
+        std::unique_lock<std::mutex> lock(state->mtx);
+        state->cv.wait(lock, [&] { return state->done; });
+    }
+    std::optional<T> Get() const {
+        Wait();
+        std::lock_guard<std::mutex> lock(state->mtx);
+        return state->cancelled ? std::nullopt : std::optional<T>(state->value);
+    }
+    // Asks for the job to be cancelled; false if it already finished. The dispatcher finishes it as cancelled
+    // when it takes it from the queue, or at the end of its pass, which stops early once every job it serves is
+    // cancelled. Its buffers are in use until it finishes.
+    bool Cancel() const {
+        state->cancel_requested = true;
+        return !state->IsDone();
+    }
+    // Runs callback(result) once the job finishes, right away if it already has
+    void OnComplete(std::function<void(std::optional<T>)> callback) const {
+        std::shared_ptr<AsyncState<T>> shared = state;
+        auto run = [shared, callback] { callback(shared->cancelled ? std::nullopt : std::optional<T>(shared->value)); };
+        {
+            std::lock_guard<std::mutex> lock(state->mtx);
+            if (!state->done) {
+                state->callbacks.push_back(run);
+                return;
+            }
+        }
+        run();
+    }
+
+    // Awaitable: std::optional<T> result = co_await job;
+    bool await_ready() const { return Ready(); }
+    bool await_suspend(std::coroutine_handle<> handle) const {
+        std::lock_guard<std::mutex> lock(state->mtx);
+        if (state->done) {
+            return false;
+        }
+        state->callbacks.push_back([handle] { handle.resume(); });
+        return true;
+    }
+    std::optional<T> await_resume() const { return Get(); }
+
+private:
+    std::shared_ptr<AsyncState<T>> state;
+};
+
+// Non-blocking front end: methods 47-49 queue a job and return at once. A dispatcher thread owned by the object
+// takes the queued jobs, groups all those on the same input (same data pointer and size) into one batch and
+// runs it as a single pass over the data on `pool` (work-stealing chunks as in methods 41-44): a sum, a product
+// and any number of adjacent differences of the same vector read it once.
+// Pause() holds the queue so that jobs submitted together are sure to share a pass; Resume() releases it.
+// The input (and the output of an adjacent difference) must stay valid until the job finishes. Destroying the
+// object cancels the jobs that have not finished, stopping the current pass early.
+// Syntax: AsyncVectorOperations async; AsyncJob<double> s = async.sum(data); ... std::optional<double> v = s.Get();
+class AsyncVectorOperations {
+public:
+    explicit AsyncVectorOperations(ThreadPool& pool = ThreadPool::Global());
+    ~AsyncVectorOperations();
+    AsyncVectorOperations(const AsyncVectorOperations&) = delete;
+    AsyncVectorOperations& operator=(const AsyncVectorOperations&) = delete;
+
+    // Method 47: sum (as method 41)
+    AsyncJob<double> sum(std::span<const double> data);
+    // Method 48: product (as method 42)
+    AsyncJob<double> product(std::span<const double> data);
+    // Method 49: adjacent difference (same layout as method 7) into out; the result is false, right away,
+    // if out does not have the size of data
+    AsyncJob<bool> adjacent_difference(std::span<const double> data, std::span<double> out);
+
+    void Pause();
+    void Resume();
+    // Number of passes over input data run so far
+    std::size_t Passes() const { return passes.load(); }
+
+private:
+    enum class JobKind { Sum, Product, AdjDiff };
+    struct PendingJob {
+        JobKind kind;
+        std::span<const double> data;
+        std::span<double> out;
+        std::shared_ptr<AsyncState<double>> value;
+        std::shared_ptr<AsyncState<bool>> written;
+    };
+
+    void Submit(PendingJob job);
+    void DispatcherLoop();
+    void RunBatch(const std::vector<PendingJob>& batch);
+
+    ThreadPool& pool;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<PendingJob> queue;
+    bool paused = false;
+    bool stop = false;
+    std::atomic<bool> stopping{false}; // stop, readable by a running pass without the lock
+    std::atomic<std::size_t> passes{0};
+    std::thread dispatcher;
+};
+
+#endif
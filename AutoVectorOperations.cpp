@@ -0,0 +1,150 @@
+#include "AutoVectorOperations.h"
+#include <fstream>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+	// Best of `Repeats` wall-clock times of `call`, in seconds
+	double BestTime(const std::function<void()>& call, int Repeats) {
+		double best = std::numeric_limits<double>::max();
+		for (int i = 0; i < Repeats; ++i) {
+			auto start = std::chrono::high_resolution_clock::now();
+			call();
+			std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+			best = std::min(best, elapsed.count());
+		}
+		return best;
+	}
+
+	// Smallest N in `sizes` such that the pool wins at it and at every larger size
+	std::size_t Crossover(const std::vector<std::size_t>& sizes, const std::vector<bool>& PoolWins) {
+		std::size_t threshold = CrossoverTable::Never;
+		for (std::size_t i = sizes.size(); i-- > 0 && PoolWins[i]; ) {
+			threshold = sizes[i];
+		}
+		return threshold;
+	}
+}
+
+const std::vector<std::size_t> CrossoverTable::DefaultSizes = {1000, 3000, 10000, 30000, 100000, 300000, 1000000, 3000000, 10000000};
+
+CrossoverTable CrossoverTable::Calibrate(ThreadPool& pool, const std::vector<std::size_t>& sizes, std::size_t ElementsPerKernel) {
+	std::vector<bool> SumWins, ProductWins, AdjDiffWins;
+	const std::size_t MaxSize = sizes.empty() ? 0 : *std::max_element(sizes.begin(), sizes.end());
+	std::vector<double> data(MaxSize);
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = 1.0 + ((i % 7) - 3) * 1e-9; // keeps the product finite
+	}
+	std::vector<double> diff(MaxSize);
+	volatile double sink = 0.0;
+
+	for (std::size_t N : sizes) {
+		std::span<const double> view(data.data(), N);
+		SimpleVectorOperations operations(view);
+		MultiThreadVectorOperations MToperations(view, pool);
+		// Enough repetitions to touch ~ElementsPerKernel elements per kernel, at least 3
+		const int Repeats = static_cast<int>(std::max<std::size_t>(3, ElementsPerKernel / std::max<std::size_t>(N, 1)));
+		SumWins.push_back(BestTime([&] { sink = MToperations.ComputeSumThreadPool(false); }, Repeats)
+			< BestTime([&] { sink = operations.sumSimd(false); }, Repeats));
+		ProductWins.push_back(BestTime([&] { sink = MToperations.ComputeProductThreadPool(false); }, Repeats)
+			< BestTime([&] { sink = operations.productSimd(false); }, Repeats));
+		AdjDiffWins.push_back(BestTime([&] { MToperations.ComputeAdjDiffThreadPool(diff, false); }, Repeats)
+			< BestTime([&] { operations.adjacent_differenceSimd(diff, false); }, Repeats));
+	}
+	(void)sink;
+
+	CrossoverTable table;
+	table.SumThreshold = Crossover(sizes, SumWins);
+	table.ProductThreshold = Crossover(sizes, ProductWins);
+	table.AdjDiffThreshold = Crossover(sizes, AdjDiffWins);
+	table.NumOfThreads = pool.size();
+	return table;
+}
+
+// File format: one "key value" pair per line
+bool CrossoverTable::Save(const std::string& path) const {
+	std::ofstream file(path);
+	file << "threads " << NumOfThreads << "\n"
+		 << "sum " << SumThreshold << "\n"
+		 << "product " << ProductThreshold << "\n"
+		 << "adjacent_difference " << AdjDiffThreshold << "\n";
+	return static_cast<bool>(file);
+}
+
+bool CrossoverTable::Load(const std::string& path) {
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+	CrossoverTable loaded;
+	int found = 0;
+	std::string key;
+	unsigned long long value;
+	while (file >> key >> value) {
+		if (key == "threads") { loaded.NumOfThreads = static_cast<unsigned int>(value); found |= 1; }
+		else if (key == "sum") { loaded.SumThreshold = value; found |= 2; }
+		else if (key == "product") { loaded.ProductThreshold = value; found |= 4; }
+		else if (key == "adjacent_difference") { loaded.AdjDiffThreshold = value; found |= 8; }
+	}
+	if (found != 15 || !file.eof()) {
+		return false;
+	}
+	*this = loaded;
+	return true;
+}
+
+CrossoverTable CrossoverTable::LoadOrCalibrate(const std::string& path, ThreadPool& pool, const std::vector<std::size_t>& sizes,
+	std::size_t ElementsPerKernel) {
+	CrossoverTable table;
+	if (table.Load(path) && table.NumOfThreads == pool.size()) {
+		return table;
+	}
+	table = Calibrate(pool, sizes, ElementsPerKernel);
+	table.Save(path);
+	return table;
+}
+
+std::string CrossoverTable::DefaultPath() {
+	const char* path = std::getenv("VECTOROPERATIONS_CROSSOVER");
+	return path ? path : "vectoroperations_crossover.txt";
+}
+
+CrossoverTable& CrossoverTable::Global() {
+	static CrossoverTable table = [] {
+		CrossoverTable loaded;
+		if (!loaded.Load(DefaultPath()) || loaded.NumOfThreads != ThreadPool::Global().size()) {
+			loaded = CrossoverTable();
+		}
+		return loaded;
+	}();
+	return table;
+}
+
+double AutoVectorOperations::sum(bool Time) const {
+	Timer timeit(Time);
+	if (vec.size() >= table.SumThreshold) {
+		return MultiThreadVectorOperations(vec, pool).ComputeSumThreadPool(false);
+	}
+	return SimpleVectorOperations(vec).sumSimd(false);
+}
+
+double AutoVectorOperations::product(bool Time) const {
+	Timer timeit(Time);
+	if (vec.size() >= table.ProductThreshold) {
+		return MultiThreadVectorOperations(vec, pool).ComputeProductThreadPool(false);
+	}
+	return SimpleVectorOperations(vec).productSimd(false);
+}
+
+void AutoVectorOperations::adjacent_difference(std::vector<double>& diff, bool Time) const {
+	Timer timeit(Time);
+	if (vec.size() >= table.AdjDiffThreshold) {
+		diff.resize(vec.size());
+		MultiThreadVectorOperations(vec, pool).ComputeAdjDiffThreadPool(diff, false);
+		return;
+	}
+	SimpleVectorOperations(vec).adjacent_differenceSimd(diff, false);
+}
@@ -0,0 +1,62 @@
+#ifndef AUTOVECTOROPERATIONS_H
+#define AUTOVECTOROPERATIONS_H
+
+#include "VectorOperations.h"
+#include <string>
+#include <limits>
+#include <vector>
+
+// Vector sizes from which the multithreaded kernel beats the single thread SIMD one.
+// The defaults follow the "best method" table of test4 in the README; Calibrate()
+// measures them on the host instead, and Save()/Load() keep them in a small text file.
+struct CrossoverTable {
+    static constexpr std::size_t Never = std::numeric_limits<std::size_t>::max();
+
+    std::size_t SumThreshold = 1000000;
+    std::size_t ProductThreshold = 1000000;
+    std::size_t AdjDiffThreshold = 10000;
+    unsigned int NumOfThreads = 0; // pool size the thresholds were measured with, 0 = not measured
+
+    // Sizes Calibrate() measures by default, 1e3 ... 1e7
+    static const std::vector<std::size_t> DefaultSizes;
+
+    // Times the single thread SIMD and thread pool kernels on `pool` for every N in `sizes` (increasing), repeating
+    // each kernel to touch about ElementsPerKernel elements per size (at least 3 runs).
+    // A threshold is the smallest measured N from which the pool wins at every larger N (Never if it never wins).
+    static CrossoverTable Calibrate(ThreadPool& pool = ThreadPool::Global(), const std::vector<std::size_t>& sizes = DefaultSizes,
+                                    std::size_t ElementsPerKernel = 50000000);
+    bool Save(const std::string& path) const;
+    // Returns false (and leaves the table unchanged) if the file is missing or malformed
+    bool Load(const std::string& path);
+    // Loads `path` if it was calibrated for pool.size() threads, otherwise calibrates (with `sizes` and
+    // ElementsPerKernel) and saves it
+    static CrossoverTable LoadOrCalibrate(const std::string& path, ThreadPool& pool = ThreadPool::Global(),
+                                          const std::vector<std::size_t>& sizes = DefaultSizes, std::size_t ElementsPerKernel = 50000000);
+
+    // Default cache file: $VECTOROPERATIONS_CROSSOVER if set, else vectoroperations_crossover.txt
+    static std::string DefaultPath();
+    // Process-wide table used by AutoVectorOperations: loaded from DefaultPath() on first use if the file
+    // matches the global pool's thread count, otherwise the built-in defaults. It never calibrates by itself.
+    static CrossoverTable& Global();
+};
+
+// Size-aware front end: every call picks the single thread SIMD or the thread pool kernel from the
+// vector size and the crossover table, so callers do not have to choose a method by hand.
+// Syntax: double s = AutoVectorOperations(std::span<const double>(data)).sum(false);
+class AutoVectorOperations : public VectorOperationsBase {
+private:
+    const CrossoverTable& table;
+    ThreadPool& pool;
+public:
+    AutoVectorOperations(const std::vector<double>& vec, const CrossoverTable& table = CrossoverTable::Global(), ThreadPool& pool = ThreadPool::Global())
+        : VectorOperationsBase(vec), table(table), pool(pool) {}
+    AutoVectorOperations(std::span<const double> view, const CrossoverTable& table = CrossoverTable::Global(), ThreadPool& pool = ThreadPool::Global())
+        : VectorOperationsBase(view), table(table), pool(pool) {}
+
+    double sum(bool Time = true) const;
+    double product(bool Time = true) const;
+    // Same layout as std::adjacent_difference: diff is resized to size(), diff[0] = vec[0]
+    void adjacent_difference(std::vector<double>& diff, bool Time = true) const;
+};
+
+#endif
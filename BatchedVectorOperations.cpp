@@ -0,0 +1,96 @@
+#include "BatchedVectorOperations.h"
+#include "SimdKernels.h"
+#include "Timer.h"
+#include <algorithm>
+
+BatchedVectorOperations::BatchedVectorOperations(std::span<const double> data, std::span<const std::size_t> offsets, ThreadPool& pool)
+	: data(data), offsets(offsets), pool(pool) {
+	valid = offsets.empty() || (std::is_sorted(offsets.begin(), offsets.end()) && offsets.back() <= data.size());
+}
+
+template <typename Vectors>
+void BatchedVectorOperations::ForEachRun(Vectors&& vectors) const {
+	const std::size_t count = size();
+	if (count == 0) {
+		return;
+	}
+	// Weighted position of the start of vector i; it grows with i, so runs are found by binary search
+	auto Weight = [&](std::size_t i) { return offsets[i] - offsets[0] + i * VectorCost; };
+	const std::size_t total = Weight(count);
+	if (pool.size() <= 1 || total < ParallelThreshold) {
+		vectors(std::size_t(0), count);
+		return;
+	}
+	const unsigned int NumOfTasks = pool.size() * TasksPerThread;
+	auto RunBegin = [&](unsigned int task) -> std::size_t {
+		if (task >= NumOfTasks) {
+			return count;
+		}
+		// First vector starting at or after the task's share of the total weight
+		const std::size_t target = ChunkBegin(task, total, NumOfTasks);
+		std::size_t lo = 0, hi = count;
+		while (lo < hi) {
+			const std::size_t mid = lo + (hi - lo) / 2;
+			if (Weight(mid) < target) {
+				lo = mid + 1;
+			}
+			else {
+				hi = mid;
+			}
+		}
+		return lo;
+	};
+	pool.ParallelFor(NumOfTasks, [&](unsigned int task) {
+		const std::size_t first = RunBegin(task), last = RunBegin(task + 1);
+		if (first < last) {
+			vectors(first, last);
+		}
+		});
+}
+
+// Method (38) Per-vector sums of a ragged batch
+void BatchedVectorOperations::sums(std::vector<double>& out, bool Time) const {
+	Timer timeit(Time);
+	out.resize(size());
+	const SimdKernels& kernels = BestSimdKernels();
+	ForEachRun([&](std::size_t first, std::size_t last) {
+		for (std::size_t i = first; i < last; ++i) {
+			out[i] = kernels.sum(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+		}
+		});
+}
+
+// Method (39) Per-vector products of a ragged batch
+void BatchedVectorOperations::products(std::vector<double>& out, bool Time) const {
+	Timer timeit(Time);
+	out.resize(size());
+	const SimdKernels& kernels = BestSimdKernels();
+	ForEachRun([&](std::size_t first, std::size_t last) {
+		for (std::size_t i = first; i < last; ++i) {
+			out[i] = kernels.product(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+		}
+		});
+}
+
+// Method (40) Per-vector adjacent differences of a ragged batch
+// Elements outside every vector (before offsets[0] or after the last offset) are copied unchanged
+void BatchedVectorOperations::adjacent_differences(std::vector<double>& out, bool Time) const {
+	Timer timeit(Time);
+	out.resize(valid ? data.size() : 0);
+	if (size() == 0) {
+		std::copy(data.begin(), data.begin() + out.size(), out.begin());
+		return;
+	}
+	std::copy(data.begin(), data.begin() + offsets.front(), out.begin());
+	std::copy(data.begin() + offsets.back(), data.end(), out.begin() + offsets.back());
+	const SimdKernels& kernels = BestSimdKernels();
+	ForEachRun([&](std::size_t first, std::size_t last) {
+		for (std::size_t i = first; i < last; ++i) {
+			const std::size_t begin = offsets[i], n = offsets[i + 1] - begin;
+			if (n > 0) {
+				out[begin] = data[begin];
+				kernels.adjacent_difference(data.data() + begin, n, out.data() + begin);
+			}
+		}
+		});
+}
@@ -0,0 +1,51 @@
+#ifndef BATCHEDVECTOROPERATIONS_H
+#define BATCHEDVECTOROPERATIONS_H
+
+#include "ThreadPool.h"
+#include <span>
+#include <vector>
+#include <cstddef>
+
+// Reductions of many small vectors in one call. The batch is ragged: one flat data buffer and count + 1
+// offsets, vector i being data[offsets[i], offsets[i + 1]) (the layout of a CSR matrix's rows).
+// Parallelism is across vectors, not within them: the batch is cut into a few tasks per pool thread, each
+// a run of whole vectors holding about the same number of elements (plus a fixed cost per vector), and
+// every vector is reduced by the SIMD kernels on the thread that owns it. Batches too small to pay for
+// waking the pool run on the calling thread.
+// The object views the data and the offsets, so both must outlive it.
+// Syntax: std::vector<double> sums; BatchedVectorOperations(data, offsets).sums(sums, false);
+class BatchedVectorOperations {
+private:
+    std::span<const double> data;
+    std::span<const std::size_t> offsets;
+    ThreadPool& pool;
+    bool valid;
+
+    // Runs vectors(first, last) for consecutive runs [first, last) of vectors covering the batch
+    template <typename Vectors>
+    void ForEachRun(Vectors&& vectors) const;
+public:
+    // Weight of one vector for the load balancing, in elements: the call and loop overhead of a reduction
+    static constexpr std::size_t VectorCost = 32;
+    // Tasks per pool thread, so threads that finish early take over the rest of the batch
+    static constexpr unsigned int TasksPerThread = 4;
+    // Batches with fewer weighted elements than this run on the calling thread
+    static constexpr std::size_t ParallelThreshold = 32768;
+
+    // offsets must be non-decreasing and end within data; otherwise the batch is invalid and seen as empty
+    BatchedVectorOperations(std::span<const double> data, std::span<const std::size_t> offsets, ThreadPool& pool = ThreadPool::Global());
+
+    bool IsValid() const { return valid; }
+    // Number of vectors
+    std::size_t size() const { return valid && !offsets.empty() ? offsets.size() - 1 : 0; }
+
+    // Method 38: out[i] = sum of vector i (method 18 on each vector); out is resized to size()
+    void sums(std::vector<double>& out, bool Time = true) const;
+    // Method 39: out[i] = product of vector i (method 19 on each vector); out is resized to size()
+    void products(std::vector<double>& out, bool Time = true) const;
+    // Method 40: adjacent difference of every vector (same layout as method 7 within each vector) into out,
+    // which is resized to the data size and has the same offsets
+    void adjacent_differences(std::vector<double>& out, bool Time = true) const;
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include "BenchmarkHarness.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+
+std::string BenchmarkResult::Key() const {
+	return name + "/" + std::to_string(elements) + "/" + std::to_string(threads) + "/" + cache;
+}
+
+double Quantile(std::vector<double> samples, double q) {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	std::sort(samples.begin(), samples.end());
+	const double rank = std::clamp(q, 0.0, 1.0) * (samples.size() - 1);
+	const std::size_t below = static_cast<std::size_t>(rank);
+	const std::size_t above = std::min(below + 1, samples.size() - 1);
+	return samples[below] + (rank - below) * (samples[above] - samples[below]);
+}
+
+double RelativeErrorOfMedian(std::vector<double> samples) {
+	if (samples.size() < 2) {
+		return 0.0;
+	}
+	const double median = Quantile(samples, 0.5);
+	if (median == 0.0) {
+		return 0.0;
+	}
+	for (double& sample : samples) {
+		sample = std::fabs(sample - median);
+	}
+	// sigma ~ 1.4826 MAD for normal noise, and the median's standard error ~ 1.2533 sigma / sqrt(n)
+	const double sigma = 1.4826 * Quantile(samples, 0.5);
+	return 1.2533 * sigma / std::sqrt(static_cast<double>(samples.size())) / median;
+}
+
+namespace
+{
+	// Writes every cache line of the buffer, evicting the benchmark's data from every cache level
+	void FlushCaches(std::vector<unsigned char>& buffer) {
+		for (std::size_t i = 0; i < buffer.size(); i += 64) {
+			buffer[i] += 1;
+		}
+		volatile unsigned char sink = buffer[buffer.size() / 2];
+		(void)sink;
+	}
+}
+
+BenchmarkResult RunBenchmark(const BenchmarkCase& benchmark, const BenchmarkOptions& options) {
+	BenchmarkResult result;
+	result.name = benchmark.name;
+	result.elements = benchmark.elements;
+	result.threads = benchmark.threads;
+	result.cache = options.FlushCache ? "cold" : "hot";
+	std::vector<unsigned char> FlushBuffer(options.FlushCache ? options.FlushBytes : 0);
+	const double Budget = options.MaxSeconds * 1e9;
+	Timer budget(false);
+	for (std::size_t i = 0; i < options.WarmupRuns && (i == 0 || budget.ElapsedNanoseconds() < Budget); ++i) {
+		benchmark.run();
+	}
+	const bool WasProfiling = Profiler::Enabled();
+	if (options.Counters) {
+		Profiler::TakeRecords(); // drops the warm-up runs' profiles
+		Profiler::Enable(true);
+		benchmark.run();
+		for (const MethodProfile& profile : Profiler::TakeRecords()) {
+			result.counts = profile.TotalCounts();
+			result.startup_ns = profile.StartupNs();
+			result.skew_ns = profile.SkewNs();
+		}
+	}
+	Profiler::Enable(false);
+	std::vector<double> samples;
+	while (samples.size() < std::max<std::size_t>(options.MaxSamples, 1)) {
+		if (options.FlushCache) {
+			FlushCaches(FlushBuffer);
+		}
+		{
+			Timer timeit(false);
+			benchmark.run();
+			samples.push_back(static_cast<double>(timeit.ElapsedNanoseconds()));
+		}
+		if (samples.size() >= options.MinSamples && RelativeErrorOfMedian(samples) <= options.RelativePrecision) {
+			result.stable = true;
+			break;
+		}
+		if (budget.ElapsedNanoseconds() >= Budget) {
+			break;
+		}
+	}
+	Profiler::Enable(WasProfiling);
+	result.samples = samples.size();
+	result.median_ns = Quantile(samples, 0.5);
+	result.p95_ns = Quantile(samples, 0.95);
+	result.min_ns = *std::min_element(samples.begin(), samples.end());
+	result.relative_error = RelativeErrorOfMedian(samples);
+	if (result.median_ns > 0.0) {
+		result.gb_per_s = benchmark.bytes / result.median_ns;
+		result.elements_per_ns = benchmark.elements / result.median_ns;
+	}
+	return result;
+}
+
+namespace
+{
+	constexpr const char* CsvHeader = "name,elements,threads,cache,samples,median_ns,p95_ns,min_ns,relative_error,gb_per_s,elements_per_ns,stable,"
+		"counters,cycles,instructions,llc_misses,branch_misses,startup_ns,skew_ns";
+	constexpr const char* CsvHeaderWithoutCounters = "name,elements,threads,cache,samples,median_ns,p95_ns,min_ns,relative_error,gb_per_s,elements_per_ns,stable";
+
+	std::string JsonString(const std::string& text) {
+		std::string quoted = "\"";
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				quoted += '\\';
+			}
+			quoted += c;
+		}
+		return quoted + "\"";
+	}
+}
+
+void WriteBenchmarkJson(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+	out << std::setprecision(9) << "[\n";
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& r = results[i];
+		out << "  {\"name\": " << JsonString(r.name) << ", \"elements\": " << r.elements << ", \"threads\": " << r.threads
+			<< ", \"cache\": " << JsonString(r.cache) << ", \"samples\": " << r.samples << ", \"median_ns\": " << r.median_ns
+			<< ", \"p95_ns\": " << r.p95_ns << ", \"min_ns\": " << r.min_ns << ", \"relative_error\": " << r.relative_error
+			<< ", \"gb_per_s\": " << r.gb_per_s << ", \"elements_per_ns\": " << r.elements_per_ns
+			<< ", \"stable\": " << (r.stable ? "true" : "false") << ", \"counters\": " << (r.counts.valid ? "true" : "false")
+			<< ", \"cycles\": " << r.counts.cycles << ", \"instructions\": " << r.counts.instructions << ", \"llc_misses\": " << r.counts.llc_misses
+			<< ", \"branch_misses\": " << r.counts.branch_misses << ", \"startup_ns\": " << r.startup_ns << ", \"skew_ns\": " << r.skew_ns << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "]\n";
+}
+
+void WriteBenchmarkCsv(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+	out << std::setprecision(9) << CsvHeader << "\n";
+	for (const BenchmarkResult& r : results) {
+		out << r.name << "," << r.elements << "," << r.threads << "," << r.cache << "," << r.samples << "," << r.median_ns << ","
+			<< r.p95_ns << "," << r.min_ns << "," << r.relative_error << "," << r.gb_per_s << "," << r.elements_per_ns << ","
+			<< (r.stable ? 1 : 0) << "," << (r.counts.valid ? 1 : 0) << "," << r.counts.cycles << "," << r.counts.instructions << ","
+			<< r.counts.llc_misses << "," << r.counts.branch_misses << "," << r.startup_ns << "," << r.skew_ns << "\n";
+	}
+}
+
+bool ReadBenchmarkCsv(const std::string& path, std::vector<BenchmarkResult>& results) {
+	std::ifstream file(path);
+	std::string line;
+	if (!file || !std::getline(file, line) || (line != CsvHeader && line != CsvHeaderWithoutCounters)) {
+		return false;
+	}
+	const std::size_t Columns = line == CsvHeader ? 19 : 12;
+	std::vector<BenchmarkResult> loaded;
+	while (std::getline(file, line)) {
+		if (line.empty()) {
+			continue;
+		}
+		std::vector<std::string> fields;
+		std::stringstream row(line);
+		for (std::string field; std::getline(row, field, ',');) {
+			fields.push_back(field);
+		}
+		if (fields.size() != Columns) {
+			return false;
+		}
+		BenchmarkResult r;
+		try {
+			r.name = fields[0];
+			r.elements = std::stoull(fields[1]);
+			r.threads = static_cast<unsigned int>(std::stoul(fields[2]));
+			r.cache = fields[3];
+			r.samples = std::stoull(fields[4]);
+			r.median_ns = std::stod(fields[5]);
+			r.p95_ns = std::stod(fields[6]);
+			r.min_ns = std::stod(fields[7]);
+			r.relative_error = std::stod(fields[8]);
+			r.gb_per_s = std::stod(fields[9]);
+			r.elements_per_ns = std::stod(fields[10]);
+			r.stable = fields[11] == "1";
+			if (Columns == 19) {
+				r.counts = PerfCounts{std::stoull(fields[13]), std::stoull(fields[14]), std::stoull(fields[15]), std::stoull(fields[16]), fields[12] == "1"};
+				r.startup_ns = std::stoll(fields[17]);
+				r.skew_ns = std::stoll(fields[18]);
+			}
+		}
+		catch (const std::exception&) {
+			return false;
+		}
+		loaded.push_back(r);
+	}
+	results = std::move(loaded);
+	return true;
+}
+
+std::vector<BenchmarkComparison> CompareBenchmarks(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double threshold) {
+	std::map<std::string, const BenchmarkResult*> base;
+	for (const BenchmarkResult& r : baseline) {
+		base[r.Key()] = &r;
+	}
+	std::vector<BenchmarkComparison> comparisons;
+	for (const BenchmarkResult& r : current) {
+		auto found = base.find(r.Key());
+		if (found == base.end() || found->second->median_ns <= 0.0) {
+			continue;
+		}
+		BenchmarkComparison c;
+		c.key = r.Key();
+		c.baseline_ns = found->second->median_ns;
+		c.current_ns = r.median_ns;
+		c.ratio = c.current_ns / c.baseline_ns;
+		const double noise = 2.0 * std::hypot(found->second->relative_error, r.relative_error);
+		c.regression = c.ratio - 1.0 > std::max(threshold, noise);
+		comparisons.push_back(c);
+	}
+	return comparisons;
+}
@@ -0,0 +1,88 @@
+#ifndef BENCHMARKHARNESS_H
+#define BENCHMARKHARNESS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+#include "PerfCounters.h"
+
+// Statistical benchmark runner used by the separate bench binary (bench/main.cpp); the tests keep the print-only
+// Timer. Every sample times one call the way Timer times a scope. A case is first run WarmupRuns times, then
+// sampled until the median is known to RelativePrecision (estimated from the median absolute deviation) or
+// MaxSeconds / MaxSamples is reached. With FlushCache every sample is preceded by a pass over a buffer larger than
+// the last-level cache, outside the timed scope, so the data is read cold from memory. With Counters one more call,
+// not among the samples, runs with the Profiler enabled (a build with -DVECTOROPERATIONS_PERF) and fills the counter
+// fields of the result; the Profiler is off while the samples are taken.
+struct BenchmarkOptions {
+    std::size_t WarmupRuns = 3;
+    std::size_t MinSamples = 10;
+    std::size_t MaxSamples = 1000;
+    double MaxSeconds = 2.0;          // sampling budget per case, warm-up and cache flushes included
+    double RelativePrecision = 0.01;  // target relative standard error of the median
+    bool FlushCache = false;
+    std::size_t FlushBytes = std::size_t(256) << 20;
+    bool Counters = false;
+};
+
+// One benchmarked call: `run` processes `elements` elements, reading and writing `bytes` bytes in total
+struct BenchmarkCase {
+    std::string name;
+    std::size_t elements = 0;
+    unsigned int threads = 1;
+    std::size_t bytes = 0;
+    std::function<void()> run;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    std::size_t elements = 0;
+    unsigned int threads = 1;
+    std::string cache;         // "hot" or "cold"
+    std::size_t samples = 0;
+    double median_ns = 0.0;
+    double p95_ns = 0.0;
+    double min_ns = 0.0;
+    double relative_error = 0.0; // estimated relative standard error of median_ns
+    double gb_per_s = 0.0;       // bytes / median
+    double elements_per_ns = 0.0;
+    bool stable = false;         // RelativePrecision was reached
+    // Options.Counters: the profiled call's counters over all its threads (counts.valid is false if perf events
+    // could not be opened or the Profiler is not compiled in), its latest task start and its task finishing skew
+    PerfCounts counts;
+    long long startup_ns = 0;
+    long long skew_ns = 0;
+
+    // Identifies the same measurement in another run: name, elements, threads and cache
+    std::string Key() const;
+};
+
+// Median absolute deviation based relative standard error of the median of `samples` (0 for fewer than 2)
+double RelativeErrorOfMedian(std::vector<double> samples);
+// q-quantile (q in [0, 1]) of `samples`, interpolated between the nearest ranks; 0 for no samples
+double Quantile(std::vector<double> samples, double q);
+
+BenchmarkResult RunBenchmark(const BenchmarkCase& benchmark, const BenchmarkOptions& options = BenchmarkOptions());
+
+// Machine-readable output: a JSON array of objects, or CSV with a header line (the format ReadBenchmarkCsv reads back)
+void WriteBenchmarkJson(std::ostream& out, const std::vector<BenchmarkResult>& results);
+void WriteBenchmarkCsv(std::ostream& out, const std::vector<BenchmarkResult>& results);
+// Returns false (and leaves results unchanged) if the file is missing or malformed. CSV files written before the
+// counter columns were added are read as well, with no counters.
+bool ReadBenchmarkCsv(const std::string& path, std::vector<BenchmarkResult>& results);
+
+struct BenchmarkComparison {
+    std::string key;
+    double baseline_ns = 0.0;
+    double current_ns = 0.0;
+    double ratio = 0.0;      // current / baseline median
+    bool regression = false;
+};
+
+// Compares every current result with the baseline result of the same key. A case regressed when its median grew by
+// more than `threshold` (relative) and by more than twice the combined relative errors of the two medians, so a
+// noisy case is not flagged for noise alone. Results without a baseline are skipped.
+std::vector<BenchmarkComparison> CompareBenchmarks(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double threshold = 0.05);
+
+#endif
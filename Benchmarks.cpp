@@ -0,0 +1,821 @@
+#include "Benchmarks.h"
+#include "VectorOperations.h"
+#include "SimdKernels.h"
+#include "StreamingVectorOperations.h"
+#include "IncrementalAggregates.h"
+#include "VectorExpressions.h"
+#include "BatchedVectorOperations.h"
+#include "NumaVector.h"
+#include "AsyncVectorOperations.h"
+#include "RollingAggregates.h"
+#include "ShardedVectorOperations.h"
+#include "FixedVectorOperations.h"
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <numeric>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <thread>
+#include <sys/resource.h>
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+#include <array>
+
+namespace
+{
+    // Peak resident set size of the process so far, in KiB (Linux reports ru_maxrss in KiB)
+    long PeakRSSKiB() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    // Average wall-clock time of one call, in microseconds, over `Calls` calls
+    double MicrosecondsPerCall(const std::function<void()>& call, std::size_t Calls) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < Calls; ++i) {
+            call();
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count() / Calls;
+    }
+}
+
+// (Construction cost) Owning copy vs. non-owning view of the same vector.
+// The view path runs first: the peak RSS only grows, so measuring the copy second
+// shows exactly the extra memory the copy needs on top of the caller's vector.
+void bench1()
+{
+    std::cout << "\n---- Benchmark 1: construction cost and peak memory, copy vs. view ----\n" << std::endl;
+    for (std::size_t N : {1000000, 10000000, 50000000}) {
+        std::vector<double> data(N, 1.0);
+        std::cout << "For the vector size " << N << "\n";
+        {
+            long before = PeakRSSKiB();
+            std::unique_ptr<SimpleVectorOperations> operations;
+            std::cout << "View construction (std::span):";
+            {
+                Timer timeit(true);
+                operations = std::make_unique<SimpleVectorOperations>(std::span<const double>(data));
+            }
+            std::cout << "Peak RSS growth: " << PeakRSSKiB() - before << " KiB, sum: " << operations->sum1(false) << "\n";
+        }
+        {
+            long before = PeakRSSKiB();
+            std::unique_ptr<SimpleVectorOperations> operations;
+            std::cout << "Copy construction (std::vector):";
+            {
+                Timer timeit(true);
+                operations = std::make_unique<SimpleVectorOperations>(data);
+            }
+            std::cout << "Peak RSS growth: " << PeakRSSKiB() - before << " KiB, sum: " << operations->sum1(false) << "\n\n";
+        }
+    }
+}
+
+// (Per-call latency) Spawn-per-call threads (methods 9, 11, 12, 13) vs. the persistent thread pool (methods 15, 16, 17)
+void bench2()
+{
+    std::cout << "\n---- Benchmark 2: per-call latency (us), spawn-per-call vs. persistent thread pool ----\n" << std::endl;
+    volatile double sink = 0.0;
+    for (std::size_t N : {1000, 10000, 100000, 1000000, 10000000}) {
+        std::vector<double> data(N, 1.0);
+        std::vector<double> diff(N);
+        MultiThreadVectorOperations MToperations(std::span<const double>(data), ThreadPool::Global());
+        const std::size_t Calls = std::max<std::size_t>(10, 20000000 / N);
+        MToperations.ComputeSumThreadPool(false); // warm-up: starts the global pool's workers
+
+        std::cout << "N = " << N << " (" << Calls << " calls, " << ThreadPool::Global().size() << " threads)\n";
+        std::cout << "  Sum     Method 9 (std::thread): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumMultiThreadSum1(false); }, Calls)
+                  << " | Method 11 (std::async): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumMultiThreadSum3(false); }, Calls)
+                  << " | Method 15 (pool): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumThreadPool(false); }, Calls) << "\n";
+        std::cout << "  Product Method 12 (std::async): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumMultiThreadProduct(false); }, Calls)
+                  << " | Method 16 (pool): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeProductThreadPool(false); }, Calls) << "\n";
+        std::cout << "  AdjDiff Method 13 (std::async): " << MicrosecondsPerCall([&] { MToperations.ComputeAdjDiffMultiThread1(diff, false); }, Calls)
+                  << " | Method 17 (pool): " << MicrosecondsPerCall([&] { MToperations.ComputeAdjDiffThreadPool(diff, false); }, Calls) << "\n";
+    }
+    (void)sink;
+}
+
+// (SIMD throughput) Scalar methods 1, 4, 7 vs. the SIMD kernels of every instruction set the host supports
+void bench3()
+{
+    std::cout << "\n---- Benchmark 3: per-call time (us), scalar methods vs. SIMD kernels ----\n" << std::endl;
+    volatile double sink = 0.0;
+    for (std::size_t N : {1000, 100000, 10000000}) {
+        std::vector<double> data(N, 1.0);
+        std::vector<double> diff(N);
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        const std::size_t Calls = std::max<std::size_t>(10, 20000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        std::cout << "  Method 1 (sum): " << MicrosecondsPerCall([&] { sink = operations.sum1(false); }, Calls)
+                  << " | Method 4 (product): " << MicrosecondsPerCall([&] { sink = operations.product1(false); }, Calls)
+                  << " | Method 7 (adjacent difference): " << MicrosecondsPerCall([&] { operations.adjacent_difference2(diff, false); }, Calls) << "\n";
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            const SimdKernels& kernels = GetSimdKernels(level);
+            if (kernels.level != level) {
+                continue; // not supported on this host
+            }
+            std::cout << "  " << kernels.name << " (sum): " << MicrosecondsPerCall([&] { sink = kernels.sum(data.data(), N); }, Calls)
+                      << " | (product): " << MicrosecondsPerCall([&] { sink = kernels.product(data.data(), N); }, Calls)
+                      << " | (adjacent difference): " << MicrosecondsPerCall([&] { kernels.adjacent_difference(data.data(), N, diff.data()); }, Calls) << "\n";
+        }
+    }
+    (void)sink;
+}
+
+// (Summation accuracy and throughput) Methods 1, 2, 3 vs. the compensated methods 21, 22, 23.
+// The error is relative to a long double Neumaier sum, on data whose large terms cancel.
+void bench4()
+{
+    std::cout << "\n---- Benchmark 4: summation time (us) and relative error, methods 1, 2, 3 vs. 21, 22, 23 ----\n" << std::endl;
+    std::default_random_engine generator(2023);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-20, 20);
+    for (std::size_t N : {1000, 100000, 10000000}) {
+        std::vector<double> data(N);
+        for (auto& x : data) {
+            x = std::ldexp(mantissa(generator), exponent(generator));
+        }
+        long double sum = 0.0L, compensation = 0.0L;
+        for (double x : data) {
+            long double t = sum + x;
+            compensation += std::fabs(sum) >= std::fabs(static_cast<long double>(x)) ? (sum - t) + x : (x - t) + sum;
+            sum = t;
+        }
+        const long double Reference = sum + compensation;
+
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+        const std::size_t Calls = std::max<std::size_t>(10, 20000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        auto Report = [&](const char* name, const std::function<double()>& method) {
+            double result = 0.0;
+            double us = MicrosecondsPerCall([&] { result = method(); }, Calls);
+            std::cout << "  " << name << ": " << us << " us, relative error " << static_cast<double>(std::fabs((result - Reference) / Reference)) << "\n";
+        };
+        Report("Method 1 (+=)               ", [&] { return operations.sum1(false); });
+        Report("Method 2 (std::accumulate)  ", [&] { return operations.sum2(false); });
+        Report("Method 3 (Kahan)            ", [&] { return operations.KahanSummation(false); });
+        Report("Method 21 (Neumaier SIMD)   ", [&] { return operations.NeumaierSummationSimd(false); });
+        Report("Method 22 (pairwise)        ", [&] { return operations.PairwiseSummation(false); });
+        Report("Method 23 (Neumaier threads)", [&] { return MToperations.ComputeCompensatedSumThreadPool(false); });
+    }
+}
+
+// (Deterministic reductions) Methods 15 and 16 (order depends on the thread count) vs. methods 24 and 25 (fixed order)
+void bench5()
+{
+    std::cout << "\n---- Benchmark 5: per-call time (us), thread pool vs. deterministic reductions ----\n" << std::endl;
+    volatile double sink = 0.0;
+    for (std::size_t N : {10000, 1000000, 10000000}) {
+        std::vector<double> data(N, 1.0);
+        MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+        const std::size_t Calls = std::max<std::size_t>(10, 20000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls, " << ThreadPool::Global().size() << " threads)\n";
+        std::cout << "  Sum     Method 15: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumThreadPool(false); }, Calls)
+                  << " | Method 24 (deterministic): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumDeterministic(false); }, Calls) << "\n";
+        std::cout << "  Product Method 16: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeProductThreadPool(false); }, Calls)
+                  << " | Method 25 (deterministic): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeProductDeterministic(false); }, Calls) << "\n";
+    }
+    (void)sink;
+}
+
+// (Overflow-safe product) Methods 4 and 12 vs. the scaled products of methods 26 and 27, up to 1e8 elements
+void bench6()
+{
+    std::cout << "\n---- Benchmark 6: product time (ms), plain vs. overflow-safe scaled product ----\n" << std::endl;
+    for (std::size_t N : {1000000, 10000000, 100000000}) {
+        std::vector<double> data(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = (i % 2 ? -1.0 : 1.0) * (1.0 + (i % 1000) * 1e-3);
+        }
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+        std::cout << "N = " << N << "\n";
+        std::cout << "  Method 4 (*=):";
+        std::cout << "  result " << operations.product1() << "\n";
+        std::cout << "  Method 12 (std::async and std::mutex):";
+        std::cout << "  result " << MToperations.ComputeSumMultiThreadProduct() << "\n";
+        std::cout << "  Method 26 (scaled):";
+        std::cout << "  log|P| " << operations.productScaled().LogAbs() << "\n";
+        std::cout << "  Method 27 (scaled, thread pool):";
+        std::cout << "  log|P| " << MToperations.ComputeProductScaledThreadPool().LogAbs() << "\n";
+    }
+}
+
+// (Scaling) Methods 9 (shared partial sums), 11 (CAS on an atomic) and 12 (mutex) vs. the padded,
+// contention-free thread pool methods 15 and 16, from 1 thread to every hardware thread
+void bench7()
+{
+    std::cout << "\n---- Benchmark 7: time per call (ms) from 1 to all hardware threads, N = 10,000,000 ----\n" << std::endl;
+    const unsigned int MaxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> ThreadCounts;
+    for (unsigned int k = 1; k < MaxThreads; k *= 2) {
+        ThreadCounts.push_back(k);
+    }
+    ThreadCounts.push_back(MaxThreads);
+
+    std::vector<double> data(10000000, 1.0);
+    volatile double sink = 0.0;
+    for (unsigned int k : ThreadCounts) {
+        ThreadPool pool(k);
+        MultiThreadVectorOperations MToperations(std::span<const double>(data), pool);
+        MToperations.SetNumOfSpawnedThreads(k);
+        const std::size_t Calls = 10;
+        std::cout << "Threads = " << k << "\n";
+        std::cout << "  Sum     Method 9: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumMultiThreadSum1(false); }, Calls) / 1000
+                  << " | Method 11: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumMultiThreadSum3(false); }, Calls) / 1000
+                  << " | Method 15 (padded, pool): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumThreadPool(false); }, Calls) / 1000 << "\n";
+        std::cout << "  Product Method 12: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumMultiThreadProduct(false); }, Calls) / 1000
+                  << " | Method 16 (padded, pool): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeProductThreadPool(false); }, Calls) / 1000 << "\n";
+    }
+    (void)sink;
+}
+
+// (Fused statistics) Six separate passes (scalar methods, then SIMD kernels) vs. the one-pass methods 28 and 29
+void bench8()
+{
+    std::cout << "\n---- Benchmark 8: time (ms) for sum, compensated sum, product, min/max, mean and variance ----\n" << std::endl;
+    volatile double sink = 0.0;
+    for (std::size_t N : {100000, 10000000, 50000000}) {
+        std::vector<double> data(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = 1.0 + ((i * 7919) % 1000) * 1e-6;
+        }
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+        const SimdKernels& kernels = BestSimdKernels();
+        const std::size_t Calls = std::max<std::size_t>(3, 20000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        std::cout << "  Separate scalar passes (methods 2, 3, 4, std::minmax_element, two-pass variance): "
+                  << MicrosecondsPerCall([&] {
+                         double mean = operations.sum2(false) / N;
+                         sink = operations.KahanSummation(false);
+                         sink = operations.product1(false);
+                         auto extremes = std::minmax_element(data.begin(), data.end());
+                         sink = *extremes.first + *extremes.second;
+                         double m2 = 0.0;
+                         for (double x : data) {
+                             m2 += (x - mean) * (x - mean);
+                         }
+                         sink = m2;
+                     }, Calls) / 1000 << "\n";
+        std::cout << "  Separate SIMD passes (methods 18, 21, 19, min_max and squared_deviation kernels):   "
+                  << MicrosecondsPerCall([&] {
+                         double mean = operations.sumSimd(false) / N;
+                         sink = operations.NeumaierSummationSimd(false);
+                         sink = operations.productSimd(false);
+                         sink = kernels.min_max(data.data(), N).min;
+                         sink = kernels.squared_deviation(data.data(), N, mean);
+                     }, Calls) / 1000 << "\n";
+        std::cout << "  Method 28 (fused, one pass):                " << MicrosecondsPerCall([&] { sink = operations.Statistics(StatAll, false).m2; }, Calls) / 1000 << "\n";
+        std::cout << "  Method 29 (fused, one pass, thread pool):   " << MicrosecondsPerCall([&] { sink = MToperations.ComputeStatisticsThreadPool(StatAll, false).m2; }, Calls) / 1000 << "\n";
+    }
+    (void)sink;
+}
+
+// (Prefix sums) std::partial_sum vs. the SIMD and two-pass thread pool scans, and the adjacent difference
+// into a second buffer (method 17) vs. in place (method 34)
+void bench9()
+{
+    std::cout << "\n---- Benchmark 9: time per call (ms) of prefix sums and adjacent differences ----\n" << std::endl;
+    for (std::size_t N : {100000, 10000000}) {
+        std::vector<double> data(N), out(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = 1.0 + ((i * 7919) % 1000) * 1e-6;
+        }
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+        const std::size_t Calls = std::max<std::size_t>(5, 20000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        std::cout << "  Inclusive scan std::partial_sum: " << MicrosecondsPerCall([&] { std::partial_sum(data.begin(), data.end(), out.begin()); }, Calls) / 1000
+                  << " | Method 30 (SIMD): " << MicrosecondsPerCall([&] { operations.inclusive_scanSimd(out, 0.0, false); }, Calls) / 1000
+                  << " | Method 32 (pool): " << MicrosecondsPerCall([&] { MToperations.ComputeInclusiveScanThreadPool(out, 0.0, false); }, Calls) / 1000 << "\n";
+        std::cout << "  Exclusive scan Method 31 (SIMD): " << MicrosecondsPerCall([&] { operations.exclusive_scanSimd(out, 0.0, false); }, Calls) / 1000
+                  << " | Method 33 (pool): " << MicrosecondsPerCall([&] { MToperations.ComputeExclusiveScanThreadPool(out, 0.0, false); }, Calls) / 1000 << "\n";
+        // Differencing the same buffer over and over only doubles its values at most once per call
+        std::cout << "  Adjacent difference Method 17 (" << N * sizeof(double) / 1024 << " KiB output buffer): "
+                  << MicrosecondsPerCall([&] { MToperations.ComputeAdjDiffThreadPool(out, false); }, Calls) / 1000
+                  << " | Method 34 (in place, no buffer): " << MicrosecondsPerCall([&] { AdjDiffInPlace(out, ThreadPool::Global(), false); }, Calls) / 1000 << "\n";
+    }
+}
+
+// (Element types) Sum of the same values stored as double, as float (converted to double first, or summed
+// directly with double or float accumulation) and as int64, single thread SIMD and on the thread pool
+void bench10()
+{
+    std::cout << "\n---- Benchmark 10: time per call (ms) of the sum for each element type ----\n" << std::endl;
+    volatile double sink = 0.0;
+    for (std::size_t N : {100000, 10000000, 50000000}) {
+        std::vector<double> data(N);
+        std::vector<float> floats(N);
+        std::vector<std::int64_t> integers(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            integers[i] = static_cast<std::int64_t>((i * 7919) % 1000);
+            data[i] = floats[i] = static_cast<float>(integers[i]);
+        }
+        const std::size_t Calls = std::max<std::size_t>(3, 20000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        BasicSimpleVectorOperations<float, double> mixed{std::span<const float>(floats)};
+        BasicSimpleVectorOperations<float, float> single{std::span<const float>(floats)};
+        BasicSimpleVectorOperations<std::int64_t> checked{std::span<const std::int64_t>(integers)};
+        std::cout << "  Method 18  double: " << MicrosecondsPerCall([&] { sink = operations.sumSimd(false); }, Calls) / 1000
+                  << " | float -> std::vector<double> -> method 18: " << MicrosecondsPerCall([&] {
+                         std::vector<double> converted(floats.begin(), floats.end());
+                         sink = SimpleVectorOperations(std::span<const double>(converted)).sumSimd(false);
+                     }, Calls) / 1000
+                  << " | float, double acc.: " << MicrosecondsPerCall([&] { sink = mixed.sumSimd(false); }, Calls) / 1000
+                  << " | float, float acc.: " << MicrosecondsPerCall([&] { sink = single.sumSimd(false); }, Calls) / 1000
+                  << " | int64, checked: " << MicrosecondsPerCall([&] { sink = static_cast<double>(checked.sumSimd(false).Value()); }, Calls) / 1000 << "\n";
+        MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+        BasicMultiThreadVectorOperations<float, double> MTmixed{std::span<const float>(floats)};
+        BasicMultiThreadVectorOperations<float, float> MTsingle{std::span<const float>(floats)};
+        BasicMultiThreadVectorOperations<std::int64_t> MTchecked{std::span<const std::int64_t>(integers)};
+        std::cout << "  Method 15  double: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumThreadPool(false); }, Calls) / 1000
+                  << " | float, double acc.: " << MicrosecondsPerCall([&] { sink = MTmixed.ComputeSumThreadPool(false); }, Calls) / 1000
+                  << " | float, float acc.: " << MicrosecondsPerCall([&] { sink = MTsingle.ComputeSumThreadPool(false); }, Calls) / 1000
+                  << " | int64, checked: " << MicrosecondsPerCall([&] { sink = static_cast<double>(MTchecked.ComputeSumThreadPool(false).Value()); }, Calls) / 1000 << "\n";
+    }
+    (void)sink;
+}
+
+// Helpers used for bench11
+namespace
+{
+    // Writes the file back and evicts it from the page cache, so the next read comes from the disk
+    void DropFromPageCache(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+}
+
+// (Vector files) Sum of a float64 file: read into a std::vector then method 15, a plain view of the mapping then
+// method 15, and the streaming method 35, from a cold and a warm page cache; then the adjacent difference into an
+// output file (method 37). $VECTOROPERATIONS_BENCH_FILE_ELEMENTS adds a file size, e.g. one larger than RAM
+// (the read-into-vector column is skipped for files larger than half the physical memory).
+void bench11()
+{
+    std::cout << "\n---- Benchmark 11: time (ms) to sum a vector file, cold and warm page cache ----\n" << std::endl;
+    std::vector<std::size_t> Sizes = {10000000, 50000000};
+    if (const char* elements = std::getenv("VECTOROPERATIONS_BENCH_FILE_ELEMENTS")) {
+        Sizes.push_back(std::strtoull(elements, nullptr, 10));
+    }
+    const std::size_t PhysicalBytes = static_cast<std::size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::string path = "bench11_input.vec", OutputPath = "bench11_output.vec";
+    volatile double sink = 0.0;
+    for (std::size_t N : Sizes) {
+        {
+            // Filled through a read-write mapping, so files larger than RAM can be written too
+            MappedVectorFile file(path, VectorDType::Float64, N);
+            std::span<double> data = file.MutableData<double>();
+            for (std::size_t i = 0; i < N; ++i) {
+                data[i] = 1.0 + ((i * 7919) % 1000) * 1e-6;
+            }
+            file.Sync();
+        }
+        const bool FitsInMemory = N * sizeof(double) < PhysicalBytes / 2;
+        std::cout << "N = " << N << " (" << N * sizeof(double) / (1 << 20) << " MiB)\n";
+        for (bool cold : {true, false}) {
+            std::cout << (cold ? "  Cold" : "  Warm") << " read into std::vector + method 15: ";
+            if (FitsInMemory) {
+                if (cold) {
+                    DropFromPageCache(path);
+                }
+                std::cout << MicrosecondsPerCall([&] {
+                    std::vector<double> data;
+                    ReadVectorFile(path, data);
+                    sink = MultiThreadVectorOperations(std::span<const double>(data)).ComputeSumThreadPool(false);
+                }, 1) / 1000;
+            }
+            else {
+                std::cout << "skipped";
+            }
+            if (cold) {
+                DropFromPageCache(path);
+            }
+            std::cout << " | mmap view + method 15: " << MicrosecondsPerCall([&] {
+                MappedVectorFile file(path);
+                sink = MultiThreadVectorOperations(file.data<double>()).ComputeSumThreadPool(false);
+            }, 1) / 1000;
+            if (cold) {
+                DropFromPageCache(path);
+            }
+            std::cout << " | method 35 (streaming): " << MicrosecondsPerCall([&] {
+                MappedVectorFile file(path);
+                sink = StreamingVectorOperations(file).sum(false);
+            }, 1) / 1000 << "\n";
+        }
+        std::cout << "  Adjacent difference into a file, method 37: " << MicrosecondsPerCall([&] {
+            MappedVectorFile file(path);
+            StreamingVectorOperations(file).adjacent_difference(OutputPath, false);
+        }, 1) / 1000 << "\n";
+        std::remove(OutputPath.c_str());
+    }
+    std::remove(path.c_str());
+    (void)sink;
+}
+
+// (Incremental aggregates) One update followed by a query: the segment tree vs. recomputing the whole vector
+// (method 2) or the queried range, and the build cost against one full pass
+void bench12()
+{
+    std::cout << "\n---- Benchmark 12: time per operation (us) of update + query, incremental aggregates vs. recomputing ----\n" << std::endl;
+    std::mt19937_64 generator(12);
+    volatile double sink = 0.0;
+    for (std::size_t N : {1000000, 10000000}) {
+        std::vector<double> data = std::vector<double>(N, 1.0);
+        std::uniform_real_distribution<double> values(0.5, 2.0);
+        for (double& value : data) {
+            value = values(generator);
+        }
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        const std::size_t Calls = std::max<std::size_t>(3, 50000000 / N);
+        std::cout << "N = " << N << "\n";
+        const double build = MicrosecondsPerCall([&] { IncrementalAggregates tree(data); sink = tree.Sum(); }, 3);
+        std::cout << "  Build (sum, product, min/max): " << build << " | method 2, one pass: " << MicrosecondsPerCall([&] { sink = operations.sum2(false); }, 3) << "\n";
+        IncrementalAggregates tree(data);
+        auto Update = [&] {
+            const std::size_t i = generator() % N;
+            data[i] = 0.5 + (generator() % 1000) * 1.5e-3;
+            return i;
+        };
+        std::cout << "  Update + total sum, method 2: " << MicrosecondsPerCall([&] { Update(); sink = operations.sum2(false); }, Calls)
+                  << " | tree: " << MicrosecondsPerCall([&] { const std::size_t i = Update(); tree.Set(i, data[i]); sink = tree.Sum(); }, 1000000) << "\n";
+        std::cout << "  Update + total product, method 26: " << MicrosecondsPerCall([&] { Update(); sink = operations.productScaled(false).LogAbs(); }, Calls)
+                  << " | tree: " << MicrosecondsPerCall([&] { const std::size_t i = Update(); tree.Set(i, data[i]); sink = tree.Product().LogAbs(); }, 1000000) << "\n";
+        auto Range = [&] {
+            std::size_t begin = generator() % (N + 1), end = generator() % (N + 1);
+            return std::pair{std::min(begin, end), std::max(begin, end)};
+        };
+        std::cout << "  Random range sum, std::accumulate: " << MicrosecondsPerCall([&] { auto [begin, end] = Range(); sink = std::accumulate(data.begin() + begin, data.begin() + end, 0.0); }, Calls)
+                  << " | tree: " << MicrosecondsPerCall([&] { auto [begin, end] = Range(); sink = tree.Sum(begin, end); }, 1000000)
+                  << " | tree min/max: " << MicrosecondsPerCall([&] { auto [begin, end] = Range(); sink = tree.MinMax(begin, end).max; }, 1000000) << "\n";
+    }
+    (void)sink;
+}
+
+// (Lazy expressions) Sum of squared adjacent differences and the scaled product of a scaled vector:
+// every step materialized into a std::vector vs. one fused expression on each backend
+void bench13()
+{
+    std::cout << "\n---- Benchmark 13: time per call (ms) of chained operations, materialized vs. fused expressions ----\n" << std::endl;
+    volatile double sink = 0.0;
+    for (std::size_t N : {100000, 10000000, 50000000}) {
+        std::vector<double> data(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = 1.0 + 1e-3 * std::sin(0.001 * i);
+        }
+        const std::size_t Calls = std::max<std::size_t>(3, 20000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        SimpleVectorOperations operations{std::span<const double>(data)};
+        std::cout << "  Sum of squared differences, method 7 + squares + method 18: " << MicrosecondsPerCall([&] {
+                std::vector<double> diff, squares(N);
+                operations.adjacent_difference2(diff, false);
+                std::transform(diff.begin(), diff.end(), squares.begin(), [](double x) { return x * x; });
+                sink = SimpleVectorOperations(std::span<const double>(squares)).sumSimd(false);
+            }, Calls) / 1000;
+        for (auto [backend, name] : {std::pair{ExpressionBackend::Scalar, "scalar"}, std::pair{ExpressionBackend::Simd, "SIMD"}, std::pair{ExpressionBackend::MultiThread, "thread pool"}}) {
+            std::cout << " | fused, " << name << ": " << MicrosecondsPerCall([&] { sink = Sum(Square(Diff(data)), backend); }, Calls) / 1000;
+        }
+        std::cout << "\n  Scaled product of 2 * data, scaled copy + method 26: " << MicrosecondsPerCall([&] {
+                std::vector<double> scaled(N);
+                std::transform(data.begin(), data.end(), scaled.begin(), [](double x) { return 2.0 * x; });
+                sink = SimpleVectorOperations(std::span<const double>(scaled)).productScaled(false).LogAbs();
+            }, Calls) / 1000;
+        for (auto [backend, name] : {std::pair{ExpressionBackend::Simd, "SIMD"}, std::pair{ExpressionBackend::MultiThread, "thread pool"}}) {
+            std::cout << " | fused, " << name << ": " << MicrosecondsPerCall([&] { sink = ProductScaled(2.0 * View(data), backend).LogAbs(); }, Calls) / 1000;
+        }
+        std::cout << "\n";
+    }
+    (void)sink;
+}
+
+// (Batched operations) Throughput in vectors per second of 10000 small vectors: one SimpleVectorOperations per
+// vector (owning copy or view) vs. one call of methods 38-40 on the ragged batch.
+// The per-vector adjacent difference reuses one output vector that stays in cache, while method 40 writes
+// the differences of the whole batch, so for large batches it is bounded by memory bandwidth.
+void bench14()
+{
+    std::cout << "\n---- Benchmark 14: throughput (million vectors/s) of many small vectors, one object per vector vs. batched ----\n" << std::endl;
+    std::mt19937_64 generator(14);
+    volatile double sink = 0.0;
+    const std::size_t count = 10000;
+    for (std::size_t MeanSize : {100, 1000, 10000}) {
+        std::vector<std::vector<double>> vectors(count);
+        std::vector<std::size_t> offsets{0};
+        std::vector<double> data;
+        for (std::vector<double>& vector : vectors) {
+            vector.assign(MeanSize / 2 + generator() % MeanSize, 1.0 + 1e-4);
+            data.insert(data.end(), vector.begin(), vector.end());
+            offsets.push_back(data.size());
+        }
+        const std::size_t Calls = std::max<std::size_t>(3, 100000000 / data.size());
+        auto Throughput = [&](const std::function<void()>& call) { return count / MicrosecondsPerCall(call, Calls); };
+        BatchedVectorOperations batch(data, offsets);
+        // The output of method 40 is allocated and touched once, outside the timings
+        std::vector<double> out, diffs(data.size());
+        std::cout << "Mean size " << MeanSize << " (" << data.size() << " elements, " << Calls << " calls)\n";
+        std::cout << "  Sums, copy + method 18 per vector: " << Throughput([&] { for (const std::vector<double>& vector : vectors) sink = SimpleVectorOperations(vector).sumSimd(false); })
+                  << " | view + method 18 per vector: " << Throughput([&] { for (const std::vector<double>& vector : vectors) sink = SimpleVectorOperations(std::span<const double>(vector)).sumSimd(false); })
+                  << " | method 38: " << Throughput([&] { batch.sums(out, false); }) << "\n";
+        std::cout << "  Products, view + method 19 per vector: " << Throughput([&] { for (const std::vector<double>& vector : vectors) sink = SimpleVectorOperations(std::span<const double>(vector)).productSimd(false); })
+                  << " | method 39: " << Throughput([&] { batch.products(out, false); }) << "\n";
+        std::cout << "  Adjacent differences, view + method 20 per vector: " << Throughput([&] {
+                std::vector<double> diff;
+                for (const std::vector<double>& vector : vectors) {
+                    diff.resize(vector.size());
+                    SimpleVectorOperations(std::span<const double>(vector)).adjacent_differenceSimd(diff, false);
+                }
+            })
+                  << " | method 40: " << Throughput([&] { batch.adjacent_differences(diffs, false); }) << "\n";
+    }
+    (void)sink;
+}
+
+// (Work stealing) Latency distribution of the static chunk methods 15, 17 and 32 vs. the work-stealing methods
+// 41, 44 and 43, idle and with busy-looping background threads pinned to half of the cores (at least one).
+// The pool is pinned one thread per core, so the threads on loaded cores really share them.
+void bench15()
+{
+    std::cout << "\n---- Benchmark 15: latency (ms: median / p90 / max over 40 calls), static chunks vs. work stealing, N = 1e7 ----\n" << std::endl;
+    const unsigned int NumOfCores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> cores(NumOfCores);
+    std::iota(cores.begin(), cores.end(), 0);
+    ThreadPool pool(NumOfCores, cores);
+    std::vector<double> data = std::vector<double>(10000000, 1.0 + 1e-9);
+    MultiThreadVectorOperations MToperations{std::span<const double>(data), pool};
+    std::vector<double> out(data.size());
+    volatile double sink = 0.0;
+    auto Latencies = [&](const std::function<void()>& call) {
+        std::vector<double> times;
+        for (int i = 0; i < 40; ++i) {
+            times.push_back(MicrosecondsPerCall(call, 1) / 1000);
+        }
+        std::sort(times.begin(), times.end());
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(2) << times[times.size() / 2] << " / " << times[times.size() * 9 / 10] << " / " << times.back();
+        return text.str();
+    };
+    for (bool loaded : {false, true}) {
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> background;
+        if (loaded) {
+            for (unsigned int core = 0; core < std::max(1u, NumOfCores / 2); ++core) {
+                background.emplace_back([&stop] { while (!stop.load(std::memory_order_relaxed)) {} });
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(core, &cpus);
+                pthread_setaffinity_np(background.back().native_handle(), sizeof(cpus), &cpus);
+            }
+        }
+        std::cout << (loaded ? "Background load on " + std::to_string(background.size()) + " of " : "Idle, ") << NumOfCores << " cores\n";
+        std::cout << "  Sum, method 15: " << Latencies([&] { sink = MToperations.ComputeSumThreadPool(false); })
+                  << " | method 41: " << Latencies([&] { sink = MToperations.ComputeSumWorkStealing(false); }) << "\n";
+        std::cout << "  Inclusive scan, method 32: " << Latencies([&] { MToperations.ComputeInclusiveScanThreadPool(out, 0.0, false); })
+                  << " | method 43: " << Latencies([&] { MToperations.ComputeInclusiveScanWorkStealing(out, 0.0, false); }) << "\n";
+        std::cout << "  Adjacent difference, method 17: " << Latencies([&] { MToperations.ComputeAdjDiffThreadPool(out, false); })
+                  << " | method 44: " << Latencies([&] { MToperations.ComputeAdjDiffWorkStealing(out, false); }) << "\n";
+        stop = true;
+        for (std::thread& t : background) {
+            t.join();
+        }
+    }
+    (void)sink;
+}
+
+// (NUMA placement) A vector filled by one thread and read by methods 15 and 17 vs. a NumaVector filled in
+// parallel on its nodes and read by methods 45 and 46, with the pool pinned node by node (NumaTopology::Cpus).
+// On a single-node host this measures the cost of the placement machinery, which should be close to none.
+void bench16()
+{
+    const NumaTopology& topology = NumaTopology::Host();
+    std::cout << "\n---- Benchmark 16: time per call (ms), single-thread first touch vs. NUMA placement ("
+              << topology.NumOfNodes() << " node(s), " << topology.NumOfCpus() << " CPU(s)) ----\n" << std::endl;
+    ThreadPool pool(static_cast<unsigned int>(topology.NumOfCpus()), topology.Cpus());
+    volatile double sink = 0.0;
+    auto Value = [](std::size_t i) { return 1.0 + 1e-9 * static_cast<double>(i % 1000); };
+    for (std::size_t N : {1000000, 50000000}) {
+        const std::size_t Calls = std::max<std::size_t>(3, 100000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        std::vector<double> data;
+        std::cout << "  Fill, one thread: " << MicrosecondsPerCall([&] {
+                data = std::vector<double>();
+                data.resize(N);
+                for (std::size_t i = 0; i < N; ++i) {
+                    data[i] = Value(i);
+                }
+            }, 3) / 1000;
+        std::cout << " | NumaVector, pool: " << MicrosecondsPerCall([&] { NumaVector numa(N, Value, pool); sink = numa[N - 1]; }, 3) / 1000 << "\n";
+        NumaVector numa(N, Value, pool), NumaDiff(N, pool);
+        std::vector<double> diff(N);
+        MultiThreadVectorOperations MToperations{std::span<const double>(data), pool};
+        NumaVectorOperations NumaOperations(numa, pool);
+        std::cout << "  Sum, method 15: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumThreadPool(false); }, Calls) / 1000
+                  << " | method 45: " << MicrosecondsPerCall([&] { sink = NumaOperations.sum(false); }, Calls) / 1000 << "\n";
+        std::cout << "  Adjacent difference, method 17: " << MicrosecondsPerCall([&] { MToperations.ComputeAdjDiffThreadPool(diff, false); }, Calls) / 1000
+                  << " | method 46: " << MicrosecondsPerCall([&] { NumaOperations.adjacent_difference(NumaDiff, false); }, Calls) / 1000 << "\n";
+    }
+    (void)sink;
+}
+
+// (Asynchronous operations) Time the calling thread is blocked: a synchronous sum (method 41) vs. submitting
+// method 47, and the total latency of a sum, a product and an adjacent difference of the same vector as three
+// synchronous calls (methods 41, 42, 44) vs. three jobs batched into one pass (methods 47-49)
+void bench17()
+{
+    std::cout << "\n---- Benchmark 17: time (ms), blocking calls vs. asynchronous jobs ----\n" << std::endl;
+    volatile double sink = 0.0;
+    AsyncVectorOperations async;
+    for (std::size_t N : {100000, 10000000}) {
+        std::vector<double> data = std::vector<double>(N, 1.0 + 1e-9), diff(N);
+        MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+        const std::size_t Calls = std::max<std::size_t>(3, 100000000 / N);
+        std::cout << "N = " << N << " (" << Calls << " calls)\n";
+        std::cout << "  Caller blocked, method 41: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumWorkStealing(false); }, Calls) / 1000;
+        std::vector<AsyncJob<double>> jobs;
+        jobs.reserve(Calls);
+        std::cout << " | submitting method 47: " << MicrosecondsPerCall([&] { jobs.push_back(async.sum(data)); }, Calls) / 1000;
+        for (const AsyncJob<double>& job : jobs) {
+            job.Wait();
+        }
+        std::cout << " | method 47 until done: " << MicrosecondsPerCall([&] { sink = *async.sum(data).Get(); }, Calls) / 1000 << "\n";
+        std::cout << "  Sum + product + adjacent difference, methods 41, 42, 44: " << MicrosecondsPerCall([&] {
+                sink = MToperations.ComputeSumWorkStealing(false) + MToperations.ComputeProductWorkStealing(false);
+                MToperations.ComputeAdjDiffWorkStealing(diff, false);
+            }, Calls) / 1000
+                  << " | methods 47-49 in one pass: " << MicrosecondsPerCall([&] {
+                async.Pause();
+                AsyncJob<double> sum = async.sum(data), product = async.product(data);
+                AsyncJob<bool> written = async.adjacent_difference(data, diff);
+                async.Resume();
+                sink = *sum.Get() + *product.Get() + *written.Get();
+            }, Calls) / 1000 << "\n";
+    }
+    (void)sink;
+}
+
+// (Rolling windows) Every window recomputed with the SIMD kernels (Neumaier sum, product, min/max), timed on the
+// first windows and scaled to all of them, vs. methods 50-52 (one thread) and 53-55 (thread pool)
+void bench18()
+{
+    std::cout << "\n---- Benchmark 18: time (ms), rolling sum, product and min/max, per window vs. rolling ----\n" << std::endl;
+    volatile double sink = 0.0;
+    const std::size_t N = 1000000;
+    std::vector<double> data = std::vector<double>(N, 1.0 + 1e-9), Sums, Products, Min, Max;
+    RollingVectorOperations operations(data);
+    const SimdKernels& kernels = BestSimdKernels();
+    for (std::size_t Window : {16, 1024, 65536}) {
+        const std::size_t NumOfWindows = N - Window + 1, Sampled = std::min<std::size_t>(NumOfWindows, 20000000 / Window);
+        const double Scale = double(NumOfWindows) / Sampled;
+        std::cout << "W = " << Window << "\n";
+        std::cout << "  Sum     per window: " << MicrosecondsPerCall([&] {
+                for (std::size_t j = 0; j < Sampled; ++j) {
+                    sink = kernels.compensated_sum(data.data() + j, Window).Result();
+                }
+            }, 1) * Scale / 1000
+                  << " | method 50: " << MicrosecondsPerCall([&] { operations.RollingSum(Window, Sums, false); }, 3) / 1000
+                  << " | method 53: " << MicrosecondsPerCall([&] { operations.RollingSumThreadPool(Window, Sums, false); }, 3) / 1000 << "\n";
+        std::cout << "  Product per window: " << MicrosecondsPerCall([&] {
+                for (std::size_t j = 0; j < Sampled; ++j) {
+                    sink = kernels.product(data.data() + j, Window);
+                }
+            }, 1) * Scale / 1000
+                  << " | method 51: " << MicrosecondsPerCall([&] { operations.RollingProduct(Window, Products, false); }, 3) / 1000
+                  << " | method 54: " << MicrosecondsPerCall([&] { operations.RollingProductThreadPool(Window, Products, false); }, 3) / 1000 << "\n";
+        std::cout << "  Min/max per window: " << MicrosecondsPerCall([&] {
+                for (std::size_t j = 0; j < Sampled; ++j) {
+                    sink = kernels.min_max(data.data() + j, Window).max;
+                }
+            }, 1) * Scale / 1000
+                  << " | method 52: " << MicrosecondsPerCall([&] { operations.RollingMinMax(Window, Min, Max, false); }, 3) / 1000
+                  << " | method 55: " << MicrosecondsPerCall([&] { operations.RollingMinMaxThreadPool(Window, Min, Max, false); }, 3) / 1000 << "\n";
+    }
+    (void)sink;
+}
+
+// (Exact summation) Cost of the exact methods 56 and 57 against the plain (2), compensated (3, 21) and multi
+// threaded compensated (23) sums, on well-conditioned data and on data whose sum cancels across many binades
+void bench19()
+{
+    std::cout << "\n---- Benchmark 19: time (ms), plain and compensated vs. exact summation ----\n" << std::endl;
+    volatile double sink = 0.0;
+    std::mt19937_64 engine(19);
+    std::uniform_real_distribution<double> Uniform(-1.0, 1.0);
+    std::uniform_int_distribution<int> Exponents(-300, 300);
+    for (std::size_t N : {1000000, 10000000}) {
+        std::vector<double> Conditioned(N), Cancelling(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            Conditioned[i] = Uniform(engine);
+            Cancelling[i] = std::ldexp(Uniform(engine), Exponents(engine));
+        }
+        const std::size_t Calls = std::max<std::size_t>(3, 100000000 / N);
+        for (const auto& [Name, data] : {std::pair<const char*, const std::vector<double>&>{"uniform (-1, 1)", Conditioned}, {"2^-300 to 2^300", Cancelling}}) {
+            SimpleVectorOperations operations{std::span<const double>(data)};
+            MultiThreadVectorOperations MToperations{std::span<const double>(data)};
+            std::cout << "N = " << N << ", " << Name << "\n";
+            std::cout << "  Method 2: " << MicrosecondsPerCall([&] { sink = operations.sum2(false); }, Calls) / 1000
+                      << " | method 3: " << MicrosecondsPerCall([&] { sink = operations.KahanSummation(false); }, Calls) / 1000
+                      << " | method 21: " << MicrosecondsPerCall([&] { sink = operations.NeumaierSummationSimd(false); }, Calls) / 1000
+                      << " | method 56: " << MicrosecondsPerCall([&] { sink = operations.ExactSum(false); }, Calls) / 1000 << "\n";
+            std::cout << "  Method 23: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeCompensatedSumThreadPool(false); }, Calls) / 1000
+                      << " | method 57: " << MicrosecondsPerCall([&] { sink = MToperations.ComputeExactSumThreadPool(false); }, Calls) / 1000 << "\n";
+        }
+    }
+    (void)sink;
+}
+
+// (Sharded operations) Methods 61, 62 and 64 on 1 to N worker processes, N = max(4, hardware threads), against
+// method 15 on a thread pool of as many threads, on 1e7 elements in shared memory
+void bench20()
+{
+    std::cout << "\n---- Benchmark 20: time (ms) and speedup vs. one process, sharded over local worker processes ----\n" << std::endl;
+    const std::size_t N = 10000000;
+    std::mt19937_64 engine(21);
+    std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+    std::vector<double> V(N);
+    for (double& x : V) {
+        x = Uniform(engine);
+    }
+    SharedVector data(V), diff(N);
+    volatile double sink = 0.0;
+    const std::size_t Calls = 10;
+    const unsigned int MaxProcesses = std::max(4u, std::thread::hardware_concurrency());
+    double one_process = 0.0;
+    for (unsigned int processes = 1; processes <= MaxProcesses; processes *= 2) {
+        ShardWorkers workers(processes);
+        ThreadPool pool(processes);
+        ShardedVectorOperations sharded(data, workers);
+        MultiThreadVectorOperations MToperations{std::span<const double>(V), pool};
+        sink = sharded.ComputeSum(false); // maps the data in every worker
+        const double sum = MicrosecondsPerCall([&] { sink = sharded.ComputeSum(false); }, Calls) / 1000;
+        one_process = processes == 1 ? sum : one_process;
+        std::cout << "  " << processes << " process(es): Method 61: " << sum << " (x" << one_process / sum << ")"
+                  << " | method 62: " << MicrosecondsPerCall([&] { sink = sharded.ComputeCompensatedSum(false); }, Calls) / 1000
+                  << " | method 64: " << MicrosecondsPerCall([&] { sharded.ComputeAdjDiff(diff, false); }, Calls) / 1000
+                  << " | method 15, " << processes << " thread(s): " << MicrosecondsPerCall([&] { sink = MToperations.ComputeSumThreadPool(false); }, Calls) / 1000 << "\n";
+    }
+    (void)sink;
+}
+
+namespace
+{
+    template <std::size_t N>
+    void FixedVersusSimple(std::mt19937_64& engine) {
+        std::uniform_real_distribution<double> Uniform(0.5, 2.0);
+        std::array<double, N> values;
+        for (double& x : values) {
+            x = Uniform(engine);
+        }
+        const std::vector<double> V(values.begin(), values.end());
+        const SimpleVectorOperations simple{std::span<const double>(V)};
+        const FixedVectorOperations<N> fixed = MakeVectorOperations(values);
+        std::vector<double> diff;
+        std::array<double, N> fixed_diff;
+        volatile double sink = 0.0;
+        const std::size_t Calls = 2000000;
+        auto ns = [&](const std::function<void()>& call) { return MicrosecondsPerCall(call, Calls) * 1000; };
+        std::cout << "  N = " << N << "\n"
+                  << "    Sum (method 1):       simple " << ns([&] { sink = simple.sum1(false); })
+                  << " | fixed " << ns([&] { sink = fixed.sum1(false); }) << "\n"
+                  << "    Kahan (method 3):     simple " << ns([&] { sink = simple.KahanSummation(false); })
+                  << " | fixed " << ns([&] { sink = fixed.KahanSummation(false); }) << "\n"
+                  << "    Product (method 4):   simple " << ns([&] { sink = simple.product1(false); })
+                  << " | fixed " << ns([&] { sink = fixed.product1(false); }) << "\n"
+                  << "    Adj. diff (method 7): simple " << ns([&] { simple.adjacent_difference2(diff, false); })
+                  << " | fixed " << ns([&] { fixed.adjacent_difference2(fixed_diff, false); }) << "\n"
+                  << "    Construct + sum:      simple (owning) " << ns([&] { sink = SimpleVectorOperations(V).sum1(false); })
+                  << " | fixed " << ns([&] { sink = FixedVectorOperations<N>(values).sum1(false); }) << "\n";
+        (void)sink;
+    }
+}
+
+// (Fixed-size vectors) Latency of one call on a short vector, where the loop, the size check and, for an owning
+// object, the heap copy weigh more than the arithmetic
+void bench21()
+{
+    std::cout << "\n---- Benchmark 21: ns per call, FixedVectorOperations vs. SimpleVectorOperations on short vectors ----\n" << std::endl;
+    std::mt19937_64 engine(22);
+    FixedVersusSimple<4>(engine);
+    FixedVersusSimple<7>(engine);
+    FixedVersusSimple<20>(engine);
+    FixedVersusSimple<64>(engine);
+}
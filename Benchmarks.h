@@ -0,0 +1,30 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Benchmarks for the vector operations library.
+// Unlike the tests they assert nothing; each prints the timings (through Timer)
+// of the compared code paths so the right method can be picked for a given size.
+// They are run with: <executable> --bench
+
+void bench1();
+void bench2();
+void bench3();
+void bench4();
+void bench5();
+void bench6();
+void bench7();
+void bench8();
+void bench9();
+void bench10();
+void bench11();
+void bench12();
+void bench13();
+void bench14();
+void bench15();
+void bench16();
+void bench17();
+void bench18();
+void bench19();
+void bench20();
+void bench21();
+#endif
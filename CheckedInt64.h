@@ -0,0 +1,35 @@
+#ifndef CHECKEDINT64_H
+#define CHECKEDINT64_H
+
+#include <cstdint>
+
+// Overflow-checked accumulator for int64 data. Sums are kept in 128 bits, so partial sums (lanes, chunks)
+// may leave the int64 range and come back: Overflow() is true only if the final sum does not fit.
+// Products keep a sticky flag once a partial product leaves 128 bits; a zero factor anywhere still gives 0.
+struct CheckedInt64 {
+    __int128 value = 0;
+    bool overflow = false;
+
+    CheckedInt64(std::int64_t x = 0) : value(x) {}
+
+    CheckedInt64& operator+=(const CheckedInt64& other) {
+        overflow |= other.overflow | __builtin_add_overflow(value, other.value, &value);
+        return *this;
+    }
+    CheckedInt64& operator*=(const CheckedInt64& other) {
+        if ((value == 0 && !overflow) || (other.value == 0 && !other.overflow)) {
+            value = 0;
+            overflow = false;
+        }
+        else {
+            overflow |= other.overflow | __builtin_mul_overflow(value, other.value, &value);
+        }
+        return *this;
+    }
+
+    bool Overflow() const { return overflow || value > INT64_MAX || value < INT64_MIN; }
+    // The result, meaningful only if !Overflow()
+    std::int64_t Value() const { return static_cast<std::int64_t>(value); }
+};
+
+#endif
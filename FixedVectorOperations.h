@@ -0,0 +1,135 @@
+#ifndef FIXEDVECTOROPERATIONS_H
+#define FIXEDVECTOROPERATIONS_H
+
+#include "VectorOperations.h"
+#include <array>
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+// Largest size taken by FixedVectorOperations: every method is unrolled into one operation per element, which pays
+// off for short vectors only; longer arrays go to SimpleVectorOperations (see MakeVectorOperations below)
+constexpr std::size_t FixedVectorMaxSize = 64;
+
+// Kernels for a size N known at compile time, unrolled over the elements by fold expressions: no loop, no
+// allocation, no thread, and usable in constant expressions. They operate in index order, as the loops of methods 1-7,
+// so they give the same bits as those methods on the same data.
+template <std::size_t N>
+constexpr double FixedSum(std::span<const double, N> x) {
+    return [&]<std::size_t... I>(std::index_sequence<I...>) { return (0.0 + ... + x[I]); }(std::make_index_sequence<N>());
+}
+
+template <std::size_t N>
+constexpr double FixedProduct(std::span<const double, N> x) {
+    return [&]<std::size_t... I>(std::index_sequence<I...>) { return (1.0 * ... * x[I]); }(std::make_index_sequence<N>());
+}
+
+// The steps of method 3, one per element
+template <std::size_t N>
+constexpr double FixedKahanSum(std::span<const double, N> x) {
+    double sum = 0.0;
+    double c = 0.0;
+    auto step = [&](double num) {
+        const double y = num - c;
+        const double t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    };
+    [&]<std::size_t... I>(std::index_sequence<I...>) { (step(x[I]), ...); }(std::make_index_sequence<N>());
+    return sum;
+}
+
+// Same layout as std::adjacent_difference (method 7): diff[0] = x[0], diff[i] = x[i] - x[i - 1].
+// diff must not overlap x.
+template <std::size_t N>
+constexpr void FixedAdjacentDifference(std::span<const double, N> x, std::span<double, N> diff) {
+    if constexpr (N > 0) {
+        diff[0] = x[0];
+        [&]<std::size_t... I>(std::index_sequence<I...>) { ((diff[I + 1] = x[I + 1] - x[I]), ...); }(std::make_index_sequence<N - 1>());
+    }
+}
+
+namespace FixedVectorDetail {
+    // The Timer is not a literal type, so the constexpr methods time their kernel through this function
+    template <typename F>
+    auto Timed(F&& f) {
+        Timer timeit(true);
+        return f();
+    }
+}
+
+// SimpleVectorOperations for a vector of N doubles, N known at compile time: methods 1-5 and 7 under the same names
+// and numbers, on the kernels above. The elements are copied into the object (an std::array, no heap memory), so it
+// stays valid after the caller's data goes away. Outside constant evaluation Time = true prints the time as the other
+// classes do; with Time = false a call is the unrolled kernel alone.
+// Syntax: constexpr std::array<double, 3> V = {1.0, 2.0, 3.0};
+//         constexpr double s = FixedVectorOperations(V).sum1(false);
+//         auto operations = MakeVectorOperations(V); // FixedVectorOperations<3>
+template <std::size_t N>
+class FixedVectorOperations {
+    static_assert(N <= FixedVectorMaxSize, "FixedVectorOperations is meant for short vectors, use SimpleVectorOperations");
+public:
+    constexpr FixedVectorOperations(const std::array<double, N>& values) : values(values) {}
+    constexpr FixedVectorOperations(std::span<const double, N> view) { std::copy(view.begin(), view.end(), values.begin()); }
+
+    constexpr bool IsView() const { return false; }
+    static constexpr std::size_t size() { return N; }
+
+    constexpr double sum1(bool Time = true) const { return Run(Time, [this] { return FixedSum(data()); }); }
+    constexpr double sum2(bool Time = true) const { return Run(Time, [this] { return FixedSum(data()); }); }
+    constexpr double KahanSummation(bool Time = true) const { return Run(Time, [this] { return FixedKahanSum(data()); }); }
+    constexpr double product1(bool Time = true) const { return Run(Time, [this] { return FixedProduct(data()); }); }
+    constexpr double product2(bool Time = true) const { return Run(Time, [this] { return FixedProduct(data()); }); }
+    // diff is an array of the same size instead of a vector to resize, so nothing is allocated
+    constexpr void adjacent_difference2(std::array<double, N>& diff, bool Time = true) const {
+        Run(Time, [this, &diff] { FixedAdjacentDifference(data(), std::span<double, N>(diff)); });
+    }
+
+private:
+    constexpr std::span<const double, N> data() const { return std::span<const double, N>(values); }
+
+    template <typename F>
+    static constexpr auto Run(bool Time, F f) {
+        if (!std::is_constant_evaluated() && Time) {
+            return FixedVectorDetail::Timed(f);
+        }
+        return f();
+    }
+
+    std::array<double, N> values{};
+};
+
+// One entry point whatever the caller has: an std::array of at most FixedVectorMaxSize elements or a span of fixed
+// extent gives a FixedVectorOperations of that size, anything else (a vector, a dynamic span, a longer array)
+// a SimpleVectorOperations viewing the data, which must then outlive it; a temporary vector or longer array is
+// copied into an owning SimpleVectorOperations instead, as a view of it would dangle.
+template <std::size_t N>
+    requires (N <= FixedVectorMaxSize)
+constexpr FixedVectorOperations<N> MakeVectorOperations(const std::array<double, N>& values) {
+    return FixedVectorOperations<N>(values);
+}
+
+template <std::size_t N>
+    requires (N != std::dynamic_extent && N <= FixedVectorMaxSize)
+constexpr FixedVectorOperations<N> MakeVectorOperations(std::span<const double, N> view) {
+    return FixedVectorOperations<N>(view);
+}
+
+inline SimpleVectorOperations MakeVectorOperations(std::span<const double> view) {
+    return SimpleVectorOperations(view);
+}
+
+inline SimpleVectorOperations MakeVectorOperations(std::vector<double>&& values) {
+    return SimpleVectorOperations(values);
+}
+
+template <std::size_t N>
+    requires (N > FixedVectorMaxSize)
+SimpleVectorOperations MakeVectorOperations(std::array<double, N>&& values) {
+    return SimpleVectorOperations(std::vector<double>(values.begin(), values.end()));
+}
+
+#endif
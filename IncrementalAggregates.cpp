@@ -0,0 +1,142 @@
+#include "IncrementalAggregates.h"
+#include <algorithm>
+
+void RangeAggregate::Merge(const RangeAggregate& other, unsigned int flags) {
+	if (flags & StatSum) {
+		sum += other.sum;
+	}
+	if (flags & StatProduct) {
+		product.Merge(other.product);
+	}
+	if (flags & StatMinMax) {
+		// Ties keep this range's index: it comes first
+		if (other.min_max.min < min_max.min || min_max.min_index == std::numeric_limits<std::size_t>::max()) {
+			min_max.min = other.min_max.min;
+			min_max.min_index = other.min_max.min_index;
+		}
+		if (other.min_max.max > min_max.max || min_max.max_index == std::numeric_limits<std::size_t>::max()) {
+			min_max.max = other.min_max.max;
+			min_max.max_index = other.min_max.max_index;
+		}
+	}
+}
+
+IncrementalAggregates::IncrementalAggregates(std::span<const double> data, unsigned int flags, ThreadPool& pool)
+	: data(data.begin(), data.end()), flags(flags) {
+	const std::size_t NumOfBlocks = (data.size() + BlockSize - 1) / BlockSize;
+	NumOfLeaves = 1;
+	while (NumOfLeaves < NumOfBlocks) {
+		NumOfLeaves *= 2;
+	}
+	tree.resize(2 * NumOfLeaves);
+
+	// Leaves, then every level from the one above the leaves up to the root; the upper levels are too
+	// small to be worth a dispatch and are merged by the calling thread
+	const unsigned int NumOfThreads = pool.size();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		for (std::size_t block = ChunkBegin(i, NumOfBlocks, NumOfThreads); block < ChunkBegin(i + 1, NumOfBlocks, NumOfThreads); ++block) {
+			tree[NumOfLeaves + block] = Compute(block * BlockSize, std::min(data.size(), (block + 1) * BlockSize));
+		}
+		});
+	constexpr std::size_t ParallelLevel = 4096;
+	for (std::size_t first = NumOfLeaves / 2; first >= 1; first /= 2) {
+		auto MergeNodes = [&](std::size_t begin, std::size_t end) {
+			for (std::size_t k = begin; k < end; ++k) {
+				tree[k] = tree[2 * k];
+				tree[k].Merge(tree[2 * k + 1], flags);
+			}
+		};
+		if (first >= ParallelLevel) {
+			pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+				MergeNodes(first + ChunkBegin(i, first, NumOfThreads), first + ChunkBegin(i + 1, first, NumOfThreads));
+				});
+		}
+		else {
+			MergeNodes(first, 2 * first);
+		}
+	}
+}
+
+RangeAggregate IncrementalAggregates::Compute(std::size_t begin, std::size_t end) const {
+	RangeAggregate result;
+	if (begin >= end) {
+		return result;
+	}
+	const SimdKernels& kernels = BestSimdKernels();
+	const std::size_t n = end - begin;
+	if (flags & StatSum) {
+		result.sum = kernels.sum(data.data() + begin, n);
+	}
+	if (flags & StatProduct) {
+		result.product = ScaledProductOf(data.data() + begin, n);
+	}
+	if (flags & StatMinMax) {
+		const MinMaxIndex local = kernels.min_max(data.data() + begin, n);
+		if (local.min_index < n) {
+			result.min_max = {local.min, local.max, begin + local.min_index, begin + local.max_index};
+		}
+	}
+	return result;
+}
+
+void IncrementalAggregates::Set(std::size_t i, double value) {
+	Set(i, std::span<const double>(&value, 1));
+}
+
+void IncrementalAggregates::Set(std::size_t begin, std::span<const double> values) {
+	if (values.empty()) {
+		return;
+	}
+	std::copy(values.begin(), values.end(), data.begin() + begin);
+	const std::size_t FirstBlock = begin / BlockSize, LastBlock = (begin + values.size() - 1) / BlockSize;
+	for (std::size_t block = FirstBlock; block <= LastBlock; ++block) {
+		tree[NumOfLeaves + block] = Compute(block * BlockSize, std::min(data.size(), (block + 1) * BlockSize));
+	}
+	// The touched nodes of every level are a contiguous range
+	for (std::size_t lo = (NumOfLeaves + FirstBlock) / 2, hi = (NumOfLeaves + LastBlock) / 2; lo >= 1; lo /= 2, hi /= 2) {
+		for (std::size_t k = lo; k <= hi; ++k) {
+			tree[k] = tree[2 * k];
+			tree[k].Merge(tree[2 * k + 1], flags);
+		}
+	}
+}
+
+RangeAggregate IncrementalAggregates::Query(std::size_t begin, std::size_t end) const {
+	end = std::min(end, data.size());
+	if (begin >= end) {
+		return RangeAggregate();
+	}
+	// Whole blocks [FirstBlock, LastBlock) through the tree, the partial blocks at both ends from the data
+	const std::size_t FirstBlock = (begin + BlockSize - 1) / BlockSize, LastBlock = end / BlockSize;
+	if (FirstBlock >= LastBlock) {
+		return Compute(begin, end);
+	}
+	RangeAggregate left = Compute(begin, FirstBlock * BlockSize);
+	RangeAggregate right;
+	// Bottom-up walk: nodes taken on the left are appended to `left`, those on the right prepended to `right`
+	for (std::size_t lo = NumOfLeaves + FirstBlock, hi = NumOfLeaves + LastBlock; lo < hi; lo /= 2, hi /= 2) {
+		if (lo & 1) {
+			left.Merge(tree[lo++], flags);
+		}
+		if (hi & 1) {
+			RangeAggregate node = tree[--hi];
+			node.Merge(right, flags);
+			right = node;
+		}
+	}
+	left.Merge(right, flags);
+	left.Merge(Compute(LastBlock * BlockSize, end), flags);
+	return left;
+}
+
+double IncrementalAggregates::Sum(std::size_t begin, std::size_t end) const {
+	return Query(begin, end).sum;
+}
+
+ScaledProduct IncrementalAggregates::Product(std::size_t begin, std::size_t end) const {
+	return Query(begin, end).product;
+}
+
+MinMaxIndex IncrementalAggregates::MinMax(std::size_t begin, std::size_t end) const {
+	return Query(begin, end).min_max;
+}
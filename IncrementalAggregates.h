@@ -0,0 +1,69 @@
+#ifndef INCREMENTALAGGREGATES_H
+#define INCREMENTALAGGREGATES_H
+
+#include "ThreadPool.h"
+#include "ScaledProduct.h"
+#include "SimdKernels.h"
+#include "VectorStatistics.h"
+#include <vector>
+#include <span>
+#include <limits>
+
+// Sum, overflow-safe product and min/max (first index of each extreme, NaNs ignored, SIZE_MAX when no
+// element qualifies) of one range. Only the fields selected by the flags of the structure are kept.
+struct RangeAggregate {
+    double sum = 0.0;
+    ScaledProduct product;
+    MinMaxIndex min_max{std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                        std::numeric_limits<std::size_t>::max(), std::numeric_limits<std::size_t>::max()};
+
+    // Appends the aggregates of the range that follows this one
+    void Merge(const RangeAggregate& other, unsigned int flags);
+};
+
+// Updatable aggregates of a vector it owns a copy of: a segment tree over blocks of BlockSize elements.
+// Every leaf holds the aggregates of one block and every inner node the merge of its two children.
+// Set() rewrites elements and recomputes their blocks and the O(log(N / BlockSize)) nodes above them;
+// a query merges the O(log(N / BlockSize)) nodes covering the whole blocks of the range with the
+// partial blocks at both ends, computed directly from the data with the SIMD kernels.
+// Nodes are recomputed from their children, never patched with deltas (as a Fenwick tree would),
+// so the sums do not drift after many updates and products and min/max need no inverse.
+// flags selects the aggregates to keep, from StatSum, StatProduct and StatMinMax (VectorStatistics.h).
+// Syntax: IncrementalAggregates tree(data); tree.Set(7, 2.5); double s = tree.Sum(0, 1000);
+class IncrementalAggregates {
+public:
+    static constexpr std::size_t BlockSize = 64;
+    static constexpr unsigned int AllFlags = StatSum | StatProduct | StatMinMax;
+
+    // Copies data and builds the tree: the blocks in parallel on the pool, then the levels bottom-up
+    IncrementalAggregates(std::span<const double> data, unsigned int flags = AllFlags, ThreadPool& pool = ThreadPool::Global());
+
+    std::size_t size() const { return data.size(); }
+    double operator[](std::size_t i) const { return data[i]; }
+    const std::vector<double>& values() const { return data; }
+
+    // data[i] = value, or data[begin + k] = values[k] for a run of consecutive elements (each touched block
+    // and node is recomputed once)
+    void Set(std::size_t i, double value);
+    void Set(std::size_t begin, std::span<const double> values);
+
+    // Aggregates of [begin, end); the whole-vector forms read the root in O(1)
+    double Sum(std::size_t begin, std::size_t end) const;
+    ScaledProduct Product(std::size_t begin, std::size_t end) const;
+    MinMaxIndex MinMax(std::size_t begin, std::size_t end) const;
+    RangeAggregate Query(std::size_t begin, std::size_t end) const;
+    double Sum() const { return tree[1].sum; }
+    ScaledProduct Product() const { return tree[1].product; }
+    MinMaxIndex MinMax() const { return tree[1].min_max; }
+
+private:
+    // Aggregates of data[begin, end), computed from the data
+    RangeAggregate Compute(std::size_t begin, std::size_t end) const;
+
+    std::vector<double> data;
+    unsigned int flags;
+    std::size_t NumOfLeaves;            // power of two >= number of blocks; leaf b is tree[NumOfLeaves + b]
+    std::vector<RangeAggregate> tree;   // tree[1] is the root, tree[k] merges tree[2k] and tree[2k + 1]
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "NumaVector.h"
+#include "SimdKernels.h"
+#include "Timer.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <numeric>
+#include <sched.h>
+#include <new>
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(VECTOROPERATIONS_LIBNUMA) && __has_include(<numa.h>)
+#include <numa.h>
+#define VECTOROPERATIONS_HAS_LIBNUMA 1
+#endif
+
+namespace
+{
+	// Parses a sysfs CPU list such as "0-3,8-11"
+	std::vector<int> ParseCpuList(const std::string& text) {
+		std::vector<int> cpus;
+		std::stringstream ranges(text);
+		std::string range;
+		while (std::getline(ranges, range, ',')) {
+			const std::size_t dash = range.find('-');
+			try {
+				const int first = std::stoi(range.substr(0, dash));
+				const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+				for (int cpu = first; cpu <= last; ++cpu) {
+					cpus.push_back(cpu);
+				}
+			}
+			catch (...) {
+				// an empty or malformed range adds no CPU
+			}
+		}
+		return cpus;
+	}
+
+	NumaTopology ReadTopology() {
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+			for (int cpu = 0; cpu < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); ++cpu) {
+				CPU_SET(cpu, &allowed);
+			}
+		}
+		NumaTopology topology;
+		// Node ids may have gaps (e.g. offline nodes), so look a little past the last one found
+		for (int node = 0, missing = 0; missing < 64; ++node) {
+			std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+			std::string text;
+			if (!list || !std::getline(list, text)) {
+				++missing;
+				continue;
+			}
+			missing = 0;
+			std::vector<int> cpus;
+			for (int cpu : ParseCpuList(text)) {
+				if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+					cpus.push_back(cpu);
+				}
+			}
+			if (!cpus.empty()) {
+				topology.NodeCpus.push_back(cpus);
+				topology.NodeIds.push_back(node);
+			}
+		}
+		if (topology.NodeCpus.empty()) {
+			topology.NodeCpus.emplace_back();
+			topology.NodeIds.push_back(0);
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+				if (CPU_ISSET(cpu, &allowed)) {
+					topology.NodeCpus[0].push_back(cpu);
+				}
+			}
+		}
+		for (std::size_t node = 0; node < topology.NodeCpus.size(); ++node) {
+			for (int cpu : topology.NodeCpus[node]) {
+				if (cpu >= static_cast<int>(topology.CpuNode.size())) {
+					topology.CpuNode.resize(cpu + 1, -1);
+				}
+				topology.CpuNode[cpu] = static_cast<int>(node);
+			}
+		}
+		return topology;
+	}
+}
+
+std::size_t NumaTopology::NumOfCpus() const {
+	std::size_t cpus = 0;
+	for (const std::vector<int>& node : NodeCpus) {
+		cpus += node.size();
+	}
+	return std::max<std::size_t>(cpus, 1);
+}
+
+std::vector<int> NumaTopology::Cpus() const {
+	std::vector<int> cpus;
+	for (const std::vector<int>& node : NodeCpus) {
+		cpus.insert(cpus.end(), node.begin(), node.end());
+	}
+	return cpus;
+}
+
+std::size_t NumaTopology::CurrentNode() const {
+	const int cpu = sched_getcpu();
+	if (cpu < 0 || cpu >= static_cast<int>(CpuNode.size()) || CpuNode[cpu] < 0) {
+		return 0;
+	}
+	return static_cast<std::size_t>(CpuNode[cpu]);
+}
+
+const NumaTopology& NumaTopology::Host() {
+	static const NumaTopology topology = ReadTopology();
+	return topology;
+}
+
+// Splits [0, count) over the nodes in proportion to their CPUs and maps the memory without touching it
+void NumaVector::Map() {
+	const std::size_t NumOfNodes = topology.NumOfNodes();
+	const std::size_t NumOfCpus = topology.NumOfCpus();
+	NodeBegins.assign(NumOfNodes + 1, count);
+	NodeBegins[0] = 0;
+	for (std::size_t node = 1, CpusBefore = topology.NodeCpus[0].size(); node < NumOfNodes; CpusBefore += topology.NodeCpus[node++].size()) {
+		const std::size_t begin = static_cast<std::size_t>(static_cast<long double>(count) * CpusBefore / NumOfCpus) / NodeAlignment * NodeAlignment;
+		NodeBegins[node] = std::max(begin, NodeBegins[node - 1]);
+	}
+	if (count == 0) {
+		return;
+	}
+	// mmap only aligns to a page: map 2 MiB more, keep the 2 MiB aligned range and unmap the slack on both sides, so
+	// the node parts (2 MiB multiples from the base) are huge page aligned in memory as well
+	constexpr std::size_t AlignmentBytes = NodeAlignment * sizeof(double);
+	MappedBytes = count * sizeof(double);
+	const std::size_t OverMapped = MappedBytes + AlignmentBytes;
+	void* map = mmap(nullptr, OverMapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (map == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+	const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(map);
+	const std::uintptr_t aligned = (address + AlignmentBytes - 1) / AlignmentBytes * AlignmentBytes;
+	if (aligned > address) {
+		munmap(map, aligned - address);
+	}
+	const std::uintptr_t PageBytes = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+	const std::uintptr_t end = (aligned + MappedBytes + PageBytes - 1) / PageBytes * PageBytes;
+	if (address + OverMapped > end) {
+		munmap(reinterpret_cast<void*>(end), address + OverMapped - end);
+	}
+	values = reinterpret_cast<double*>(aligned);
+#ifdef VECTOROPERATIONS_HAS_LIBNUMA
+	if (NumOfNodes > 1 && numa_available() >= 0) {
+		for (std::size_t node = 0; node < NumOfNodes; ++node) {
+			if (NodeBegins[node] < NodeBegins[node + 1]) {
+				numa_tonode_memory(values + NodeBegins[node], (NodeBegins[node + 1] - NodeBegins[node]) * sizeof(double), topology.NodeIds[node]);
+			}
+		}
+	}
+#endif
+}
+
+NumaVector::NumaVector(std::size_t size, ThreadPool& pool, const NumaTopology& topology) : count(size), topology(topology) {
+	Map();
+	ForEachLocalChunk(pool, [&](std::size_t begin, std::size_t end) { std::fill(values + begin, values + end, 0.0); });
+}
+
+NumaVector::NumaVector(std::span<const double> source, ThreadPool& pool, const NumaTopology& topology) : count(source.size()), topology(topology) {
+	Map();
+	ForEachLocalChunk(pool, [&](std::size_t begin, std::size_t end) { std::copy(source.begin() + begin, source.begin() + end, values + begin); });
+}
+
+NumaVector::~NumaVector() {
+	if (values != nullptr) {
+		munmap(values, MappedBytes);
+	}
+}
+
+// Method (45) Sum of a NumaVector, every chunk summed on its node
+double NumaVectorOperations::sum(bool Time) const {
+	Timer timeit(Time);
+	const SimdKernels& kernels = BestSimdKernels();
+	std::vector<double> Partial_Sums((numa.size() + NumaVector::ChunkElements - 1) / NumaVector::ChunkElements);
+	numa.ForEachLocalChunk(pool, [&](std::size_t begin, std::size_t end) {
+		Partial_Sums[begin / NumaVector::ChunkElements] = kernels.sum(numa.data() + begin, end - begin);
+		});
+	return std::accumulate(Partial_Sums.begin(), Partial_Sums.end(), 0.0);
+}
+
+// Method (46) Adjacent difference of a NumaVector into another one, every chunk read and written on its node
+bool NumaVectorOperations::adjacent_difference(NumaVector& diff, bool Time) const {
+	Timer timeit(Time);
+	if (diff.size() != numa.size()) {
+		return false;
+	}
+	const SimdKernels& kernels = BestSimdKernels();
+	numa.ForEachLocalChunk(pool, [&](std::size_t begin, std::size_t end) {
+		diff[begin] = begin == 0 ? numa[0] : numa[begin] - numa[begin - 1];
+		kernels.adjacent_difference(numa.data() + begin, end - begin, diff.data() + begin);
+		});
+	return true;
+}
@@ -0,0 +1,131 @@
+#ifndef NUMAVECTOR_H
+#define NUMAVECTOR_H
+
+#include "VectorOperations.h"
+#include <vector>
+#include <span>
+#include <atomic>
+#include <algorithm>
+#include <concepts>
+
+// NUMA nodes of the host, read from /sys/devices/system/node and restricted to the CPUs this process may run on.
+// Machines without that information (or with one node) are seen as a single node holding every allowed CPU.
+struct NumaTopology {
+    std::vector<std::vector<int>> NodeCpus; // allowed CPUs of every node that has some
+    std::vector<int> NodeIds;               // kernel id of each of those nodes
+    std::vector<int> CpuNode;               // CPU id -> index into NodeCpus, -1 for CPUs not in the list
+
+    std::size_t NumOfNodes() const { return NodeCpus.size(); }
+    std::size_t NumOfCpus() const;
+    // Every allowed CPU, node by node: ThreadPool(NumOfCpus(), Cpus()) pins one pool thread per CPU, so the
+    // threads of each node are those that process the part of a NumaVector placed on it
+    std::vector<int> Cpus() const;
+    // Node index of the CPU the calling thread runs on (0 if unknown)
+    std::size_t CurrentNode() const;
+
+    static const NumaTopology& Host();
+};
+
+// Vector of doubles whose pages are spread over the NUMA nodes: node k holds a contiguous part proportional to
+// its number of CPUs, starting on a 2 MiB boundary of the address space (the mapping is 2 MiB aligned, so a
+// transparent huge page never straddles two parts).
+// The memory is mapped untouched and every part is first written by pool threads running on its node, which
+// places its pages there (Linux first-touch policy). Built with -DVECTOROPERATIONS_LIBNUMA -lnuma, the parts
+// are also bound to their nodes with libnuma before the first touch.
+// ForEachLocalChunk runs the same placement when reading: each pool thread processes the chunks of its own
+// node first and then helps the other nodes, so with a pinned pool (NumaTopology::Cpus) most reads are local.
+// On a single node it is a plain vector filled and processed in parallel.
+// Syntax: ThreadPool pool(NumaTopology::Host().NumOfCpus(), NumaTopology::Host().Cpus());
+//         NumaVector data(N, [](std::size_t i) { return 1.0 / (i + 1); }, pool);
+class NumaVector {
+public:
+    // Elements per chunk handed to a thread (64 KiB), and alignment of the node parts (2 MiB)
+    static constexpr std::size_t ChunkElements = 8192;
+    static constexpr std::size_t NodeAlignment = std::size_t(1) << 18;
+
+    // size zero elements, first touched in parallel on their nodes
+    explicit NumaVector(std::size_t size, ThreadPool& pool = ThreadPool::Global(), const NumaTopology& topology = NumaTopology::Host());
+    // values[i] = f(i), each element first written on its node (one pass, unlike NumaVector(size) then Generate)
+    template <typename F> requires std::invocable<F&, std::size_t>
+    NumaVector(std::size_t size, F&& f, ThreadPool& pool = ThreadPool::Global(), const NumaTopology& topology = NumaTopology::Host())
+        : count(size), topology(topology) {
+        Map();
+        Generate(f, pool);
+    }
+    // Parallel copy of source, placed the same way
+    explicit NumaVector(std::span<const double> source, ThreadPool& pool = ThreadPool::Global(), const NumaTopology& topology = NumaTopology::Host());
+    ~NumaVector();
+    NumaVector(const NumaVector&) = delete;
+    NumaVector& operator=(const NumaVector&) = delete;
+
+    std::size_t size() const { return count; }
+    double* data() { return values; }
+    const double* data() const { return values; }
+    double& operator[](std::size_t i) { return values[i]; }
+    double operator[](std::size_t i) const { return values[i]; }
+    std::span<const double> view() const { return std::span<const double>(values, count); }
+    std::span<double> view() { return std::span<double>(values, count); }
+
+    const NumaTopology& Topology() const { return topology; }
+    // First element of node k's part, for k in [0, NumOfNodes()]; NodeBegin(NumOfNodes()) == size()
+    std::size_t NodeBegin(std::size_t node) const { return NodeBegins[node]; }
+
+    // Runs task(begin, end) on the pool for every chunk [begin, end) of ChunkElements elements (chunks never
+    // cross a node part), each on a thread of the chunk's node when one is free. begin / ChunkElements numbers the chunks.
+    template <typename Task>
+    void ForEachLocalChunk(ThreadPool& pool, Task&& task) const;
+
+    // values[i] = f(i) for every i, written on the nodes the elements are placed on
+    template <typename F>
+    void Generate(F&& f, ThreadPool& pool = ThreadPool::Global()) {
+        ForEachLocalChunk(pool, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                values[i] = f(i);
+            }
+            });
+    }
+
+private:
+    void Map();
+
+    double* values = nullptr;
+    std::size_t count;
+    std::size_t MappedBytes = 0;
+    const NumaTopology& topology;
+    std::vector<std::size_t> NodeBegins;
+};
+
+template <typename Task>
+void NumaVector::ForEachLocalChunk(ThreadPool& pool, Task&& task) const {
+    const std::size_t NumOfNodes = topology.NumOfNodes();
+    std::vector<CacheLinePadded<std::atomic<std::size_t>>> Next(NumOfNodes);
+    pool.ParallelFor(pool.size(), [&](unsigned int) {
+        const std::size_t home = topology.CurrentNode();
+        for (std::size_t k = 0; k < NumOfNodes; ++k) {
+            const std::size_t node = (home + k) % NumOfNodes;
+            const std::size_t begin = NodeBegins[node], end = NodeBegins[node + 1];
+            for (std::size_t start = begin + Next[node].value.fetch_add(ChunkElements); start < end; start = begin + Next[node].value.fetch_add(ChunkElements)) {
+                task(start, std::min(end, start + ChunkElements));
+            }
+        }
+        });
+}
+
+// Operations on a NumaVector through ForEachLocalChunk, so each thread reads the part placed on its node.
+// The object views the vector, so it must outlive it.
+// Syntax: double s = NumaVectorOperations(data, pool).sum(false);
+class NumaVectorOperations : public VectorOperationsBase {
+private:
+    const NumaVector& numa;
+    ThreadPool& pool;
+public:
+    NumaVectorOperations(const NumaVector& numa, ThreadPool& pool = ThreadPool::Global()) : VectorOperationsBase(numa.view()), numa(numa), pool(pool) {}
+
+    // Method 45: sum with the SIMD kernels, per-chunk sums merged in chunk order (same bits for any schedule)
+    double sum(bool Time = true) const;
+    // Method 46: adjacent difference (same layout as method 7) into diff, a NumaVector of the same size, so every
+    // chunk is read and written on the same node; false if the sizes differ
+    bool adjacent_difference(NumaVector& diff, bool Time = true) const;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "OutputBuffers.h"
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/mman.h>
+
+AlignedBuffer::AlignedBuffer(std::size_t size) {
+	resize(size);
+}
+
+AlignedBuffer::~AlignedBuffer() {
+	std::free(values);
+}
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+	: values(std::exchange(other.values, nullptr)), count(std::exchange(other.count, 0)), allocated(std::exchange(other.allocated, 0)) {}
+
+AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) noexcept {
+	if (this != &other) {
+		std::free(values);
+		values = std::exchange(other.values, nullptr);
+		count = std::exchange(other.count, 0);
+		allocated = std::exchange(other.allocated, 0);
+	}
+	return *this;
+}
+
+void AlignedBuffer::resize(std::size_t size) {
+	if (size <= allocated) {
+		count = size;
+		return;
+	}
+	std::free(values);
+	values = nullptr;
+	count = allocated = 0;
+	const std::size_t align = size * sizeof(double) >= HugePageBytes ? HugePageBytes : Alignment;
+	const std::size_t bytes = (size * sizeof(double) + align - 1) / align * align;
+	void* memory = std::aligned_alloc(align, bytes);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	if (align == HugePageBytes) {
+		madvise(memory, bytes, MADV_HUGEPAGE); // best effort
+	}
+	values = static_cast<double*>(memory);
+	count = size;
+	allocated = bytes / sizeof(double);
+}
+
+BufferArena::Lease::Lease(Lease&& other) noexcept : arena(std::exchange(other.arena, nullptr)), buffer(std::move(other.buffer)) {}
+
+BufferArena::Lease& BufferArena::Lease::operator=(Lease&& other) noexcept {
+	if (this != &other) {
+		Return();
+		arena = std::exchange(other.arena, nullptr);
+		buffer = std::move(other.buffer);
+	}
+	return *this;
+}
+
+BufferArena::Lease::~Lease() {
+	Return();
+}
+
+void BufferArena::Lease::Return() {
+	if (arena == nullptr) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(arena->mtx);
+	arena->idle.push_back(std::move(buffer));
+	arena = nullptr;
+}
+
+BufferArena::Lease BufferArena::Acquire(std::size_t size) {
+	AlignedBuffer buffer;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		// Smallest idle buffer that fits, otherwise the largest one is grown
+		auto best = idle.end();
+		for (auto it = idle.begin(); it != idle.end(); ++it) {
+			if (it->capacity() >= size && (best == idle.end() || best->capacity() < size || it->capacity() < best->capacity())) {
+				best = it;
+			}
+			else if (best == idle.end() || (best->capacity() < size && it->capacity() > best->capacity())) {
+				best = it;
+			}
+		}
+		if (best != idle.end()) {
+			buffer = std::move(*best);
+			*best = std::move(idle.back());
+			idle.pop_back();
+		}
+		if (buffer.capacity() < size) {
+			++allocations;
+		}
+	}
+	buffer.resize(size);
+	return Lease(this, std::move(buffer));
+}
+
+std::size_t BufferArena::Allocations() const {
+	std::lock_guard<std::mutex> lock(mtx);
+	return allocations;
+}
+
+std::size_t BufferArena::IdleBuffers() const {
+	std::lock_guard<std::mutex> lock(mtx);
+	return idle.size();
+}
+
+void BufferArena::Trim() {
+	std::vector<AlignedBuffer> freed;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		freed.swap(idle);
+	}
+}
+
+std::size_t LastLevelCacheBytes() {
+	static const std::size_t bytes = [] {
+		for (int level : {_SC_LEVEL4_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE, _SC_LEVEL2_CACHE_SIZE}) {
+			const long size = sysconf(level);
+			if (size > 0) {
+				return static_cast<std::size_t>(size);
+			}
+		}
+		return std::size_t(32) << 20;
+	}();
+	return bytes;
+}
@@ -0,0 +1,102 @@
+#ifndef OUTPUTBUFFERS_H
+#define OUTPUTBUFFERS_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <mutex>
+
+// Uninitialized buffer of doubles aligned to a cache line (64 bytes), so vector stores never split a line.
+// From HugePageBytes on it is aligned to 2 MiB and marked with madvise(MADV_HUGEPAGE), letting the kernel back it with
+// transparent huge pages: a long stream over it then takes one TLB entry per 2 MiB instead of per 4 KiB.
+class AlignedBuffer {
+public:
+    static constexpr std::size_t Alignment = 64;
+    static constexpr std::size_t HugePageBytes = std::size_t(2) << 20;
+
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(std::size_t size);
+    ~AlignedBuffer();
+    AlignedBuffer(AlignedBuffer&& other) noexcept;
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return allocated; }
+    double* data() { return values; }
+    const double* data() const { return values; }
+    double& operator[](std::size_t i) { return values[i]; }
+    double operator[](std::size_t i) const { return values[i]; }
+    std::span<double> span() { return std::span<double>(values, count); }
+    std::span<const double> view() const { return std::span<const double>(values, count); }
+    bool HugePages() const { return allocated * sizeof(double) >= HugePageBytes; }
+
+    // Sets the size. The memory is kept when it already holds `size` elements; otherwise it is replaced and the
+    // contents are lost (the buffers are outputs, so nothing is copied)
+    void resize(std::size_t size);
+
+private:
+    double* values = nullptr;
+    std::size_t count = 0;
+    std::size_t allocated = 0;
+};
+
+// Recycles output buffers across calls. Acquire(size) hands out the smallest idle buffer holding `size` elements,
+// and allocates only if there is none; the Lease gives the buffer back when it is destroyed. Once a repeated workload
+// has run, every Acquire is served from the idle buffers and a call makes no heap allocation. Thread-safe; leases
+// must not outlive their arena.
+// Syntax: BufferArena arena; { BufferArena::Lease diff = operations.adjacent_differenceArena(arena); use(diff.span()); }
+class BufferArena {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        std::size_t size() const { return buffer.size(); }
+        double* data() { return buffer.data(); }
+        const double* data() const { return buffer.data(); }
+        double& operator[](std::size_t i) { return buffer[i]; }
+        double operator[](std::size_t i) const { return buffer[i]; }
+        std::span<double> span() { return buffer.span(); }
+        std::span<const double> view() const { return buffer.view(); }
+
+    private:
+        friend class BufferArena;
+        Lease(BufferArena* arena, AlignedBuffer&& buffer) : arena(arena), buffer(std::move(buffer)) {}
+        void Return();
+
+        BufferArena* arena = nullptr;
+        AlignedBuffer buffer;
+    };
+
+    BufferArena() = default;
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    Lease Acquire(std::size_t size);
+    // Buffers allocated (or grown) since construction, and buffers currently idle
+    std::size_t Allocations() const;
+    std::size_t IdleBuffers() const;
+    // Frees the idle buffers; leases still out return theirs as usual
+    void Trim();
+
+private:
+    mutable std::mutex mtx;
+    std::vector<AlignedBuffer> idle;
+    std::size_t allocations = 0;
+};
+
+// Last-level cache size of the host (sysconf), 32 MiB if unknown
+std::size_t LastLevelCacheBytes();
+// Outputs are written with non-temporal stores once input and output together exceed the last-level cache: the
+// output would not stay cached anyway, and writing it through the cache costs a read of every line (read for
+// ownership) and evicts the input
+inline bool UseNonTemporalStores(std::size_t size) {
+    return 2 * size * sizeof(double) > LastLevelCacheBytes();
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include "PerfCounters.h"
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#ifdef VECTOROPERATIONS_PERF
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+void PerfCounts::Add(const PerfCounts& other) {
+	cycles += other.cycles;
+	instructions += other.instructions;
+	llc_misses += other.llc_misses;
+	branch_misses += other.branch_misses;
+	valid = valid && other.valid;
+}
+
+PerfCounts MethodProfile::TotalCounts() const {
+	PerfCounts total = counts;
+	for (const ThreadSpan& span : spans) {
+		if (span.thread != thread) {
+			total.Add(span.counts);
+		}
+	}
+	return total;
+}
+
+long long MethodProfile::StartupNs() const {
+	long long latest = 0;
+	for (const ThreadSpan& span : spans) {
+		latest = std::max(latest, span.start_ns);
+	}
+	return latest;
+}
+
+long long MethodProfile::SkewNs() const {
+	if (spans.empty()) {
+		return 0;
+	}
+	auto [first, last] = std::minmax_element(spans.begin(), spans.end(), [](const ThreadSpan& a, const ThreadSpan& b) { return a.finish_ns < b.finish_ns; });
+	return last->finish_ns - first->finish_ns;
+}
+
+namespace
+{
+#ifdef VECTOROPERATIONS_PERF
+	bool EnabledAtStartup() {
+		const char* value = std::getenv("VECTOROPERATIONS_PERF");
+		return value != nullptr && std::strcmp(value, "1") == 0;
+	}
+	std::atomic<bool> ProfilerEnabled{EnabledAtStartup()};
+#else
+	std::atomic<bool> ProfilerEnabled{false};
+#endif
+	std::mutex RecordsMutex;
+	std::vector<MethodProfile> Records;
+}
+
+void Profiler::Enable(bool on) {
+#ifdef VECTOROPERATIONS_PERF
+	ProfilerEnabled.store(on, std::memory_order_relaxed);
+#else
+	(void)on;
+#endif
+}
+
+bool Profiler::Enabled() {
+	return ProfilerEnabled.load(std::memory_order_relaxed);
+}
+
+std::vector<MethodProfile> Profiler::TakeRecords() {
+	std::lock_guard<std::mutex> lock(RecordsMutex);
+	std::vector<MethodProfile> taken;
+	taken.swap(Records);
+	return taken;
+}
+
+#ifdef VECTOROPERATIONS_PERF
+namespace
+{
+	long ThreadId() {
+		return static_cast<long>(syscall(SYS_gettid));
+	}
+
+	// The four counters of the calling thread as one group (read together in one system call), opened on first use
+	// and kept until the thread exits
+	class ThreadCounters {
+	public:
+		ThreadCounters() {
+			const std::uint64_t events[4] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+			for (int k = 0; k < 4; ++k) {
+				perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = events[k];
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_GROUP;
+				fds[k] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, k == 0 ? -1 : fds[0], 0));
+				if (fds[k] < 0) {
+					Close();
+					return;
+				}
+			}
+		}
+		~ThreadCounters() { Close(); }
+
+		PerfCounts Read() const {
+			std::uint64_t values[5]; // number of counters, then their values in opening order
+			if (fds[0] < 0 || read(fds[0], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[0] != 4) {
+				return PerfCounts();
+			}
+			return PerfCounts{values[1], values[2], values[3], values[4], true};
+		}
+
+	private:
+		void Close() {
+			for (int& fd : fds) {
+				if (fd >= 0) {
+					close(fd);
+				}
+				fd = -1;
+			}
+		}
+		int fds[4] = {-1, -1, -1, -1};
+	};
+
+	PerfCounts ReadThreadCounters() {
+		thread_local ThreadCounters counters;
+		return counters.Read();
+	}
+
+	PerfCounts Difference(const PerfCounts& end, const PerfCounts& start) {
+		if (!end.valid || !start.valid) {
+			return PerfCounts();
+		}
+		return PerfCounts{end.cycles - start.cycles, end.instructions - start.instructions, end.llc_misses - start.llc_misses,
+			end.branch_misses - start.branch_misses, true};
+	}
+
+	thread_local ProfileScope* CurrentScope = nullptr;
+}
+
+ProfileScope::ProfileScope(const char* method) {
+	if (!Profiler::Enabled() || CurrentScope != nullptr) {
+		return;
+	}
+	active = true;
+	CurrentScope = this;
+	profile.method = method;
+	profile.thread = ThreadId();
+	start = ReadThreadCounters();
+	begin = std::chrono::steady_clock::now();
+}
+
+ProfileScope::~ProfileScope() {
+	if (!active) {
+		return;
+	}
+	profile.wall_ns = ElapsedNs();
+	profile.counts = Difference(ReadThreadCounters(), start);
+	CurrentScope = nullptr;
+	std::lock_guard<std::mutex> lock(RecordsMutex);
+	Records.push_back(std::move(profile));
+}
+
+ProfileScope* ProfileScope::Current() {
+	return CurrentScope;
+}
+
+long long ProfileScope::ElapsedNs() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void ProfileScope::AddSpan(const ThreadSpan& span) {
+	std::lock_guard<std::mutex> lock(mtx);
+	profile.spans.push_back(span);
+}
+
+SpanScope::SpanScope(ProfileScope* profile, unsigned int task) : profile(profile) {
+	if (profile == nullptr) {
+		return;
+	}
+	span.task = task;
+	span.thread = ThreadId();
+	start = ReadThreadCounters();
+	span.start_ns = profile->ElapsedNs();
+}
+
+SpanScope::~SpanScope() {
+	if (profile == nullptr) {
+		return;
+	}
+	span.finish_ns = profile->ElapsedNs();
+	span.counts = Difference(ReadThreadCounters(), start);
+	profile->AddSpan(span);
+}
+#endif
@@ -0,0 +1,115 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+// Hardware counters of one thread over a span of work, from Linux perf_event_open (user space only).
+// valid is false where the counters cannot be opened (not Linux, a container without perf events, or a strict
+// /proc/sys/kernel/perf_event_paranoid); the timestamps of the profiles are recorded all the same.
+struct PerfCounts {
+    std::uint64_t cycles = 0;
+    std::uint64_t instructions = 0;
+    std::uint64_t llc_misses = 0;
+    std::uint64_t branch_misses = 0;
+    bool valid = false;
+
+    void Add(const PerfCounts& other);
+    double InstructionsPerCycle() const { return cycles ? static_cast<double>(instructions) / cycles : 0.0; }
+};
+
+// One task of a profiled method: the thread it ran on, when it started and finished (ns from the start of the
+// method) and its counters
+struct ThreadSpan {
+    unsigned int task = 0;
+    long thread = 0; // kernel thread id
+    long long start_ns = 0;
+    long long finish_ns = 0;
+    PerfCounts counts;
+};
+
+struct MethodProfile {
+    std::string method;
+    long thread = 0;               // calling thread
+    long long wall_ns = 0;
+    PerfCounts counts;             // calling thread over the whole method, tasks it ran itself included
+    std::vector<ThreadSpan> spans; // tasks on the pool or on threads the method spawned, in finishing order
+
+    // Counters of the calling thread plus those of the tasks other threads ran
+    PerfCounts TotalCounts() const;
+    // Latest task start: how long the last thread took to begin (a thread creation or a pool wake-up)
+    long long StartupNs() const;
+    // Spread of the task finishing times: how long the first thread to finish waited for the last one
+    long long SkewNs() const;
+};
+
+// Run-time switch and results of the instrumentation, which is only compiled in with -DVECTOROPERATIONS_PERF.
+// Without it Enable() does nothing and the scopes below are empty, so the methods carry no instrumentation at all;
+// with it, a disabled profiler costs one relaxed atomic load per method. $VECTOROPERATIONS_PERF=1 enables it at startup.
+// Syntax: Profiler::Enable(true); operations.sumSimd(false); for (const MethodProfile& p : Profiler::TakeRecords()) { ... }
+struct Profiler {
+    static void Enable(bool on);
+    static bool Enabled();
+    // Profiles recorded since the last call, oldest first
+    static std::vector<MethodProfile> TakeRecords();
+};
+
+#ifdef VECTOROPERATIONS_PERF
+class ProfileScope;
+
+// Records one task of a profiled method as a ThreadSpan, on the thread that runs it (nothing for a null profile)
+class SpanScope {
+public:
+    SpanScope(ProfileScope* profile, unsigned int task);
+    ~SpanScope();
+    SpanScope(const SpanScope&) = delete;
+    SpanScope& operator=(const SpanScope&) = delete;
+
+private:
+    ProfileScope* profile;
+    ThreadSpan span;
+    PerfCounts start;
+};
+
+// Profiles a method from construction to destruction while the profiler is enabled. Only the outermost scope of
+// a thread records, so a method calling another gives one profile. ThreadPool::ParallelFor records a span for each
+// task it runs while its caller is inside a scope; methods spawning their own threads call Span(task) in each.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* method);
+    ~ProfileScope();
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    SpanScope Span(unsigned int task) { return SpanScope(active ? this : nullptr, task); }
+    // Recording scope of the calling thread, nullptr if none
+    static ProfileScope* Current();
+
+private:
+    friend class SpanScope;
+    long long ElapsedNs() const;
+    void AddSpan(const ThreadSpan& span);
+
+    bool active = false;
+    std::chrono::steady_clock::time_point begin;
+    PerfCounts start;
+    std::mutex mtx; // guards profile.spans
+    MethodProfile profile;
+};
+#else
+class SpanScope {
+public:
+    ~SpanScope() {}
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char*) {}
+    SpanScope Span(unsigned int) const { return SpanScope(); }
+};
+#endif
+
+#endif
@@ -0,0 +1,203 @@
+#include "RollingAggregates.h"
+#include "Timer.h"
+#include <cmath>
+
+namespace
+{
+	// How one aggregate is accumulated: Add appends one element, Merge appends an aggregate of later elements
+	struct SumPolicy {
+		using Aggregate = CompensatedSum;
+		static void Add(Aggregate& a, double x) { a.Add(x); }
+		static void Merge(Aggregate& a, const Aggregate& b) { a.Merge(b); }
+	};
+
+	struct ProductPolicy {
+		struct Aggregate {
+			double product = 1.0;
+		};
+		static void Add(Aggregate& a, double x) { a.product *= x; }
+		static void Merge(Aggregate& a, const Aggregate& b) { a.product *= b.product; }
+	};
+
+	struct MinMaxPolicy {
+		// NaNs never compare smaller or larger, so they are ignored
+		struct Aggregate {
+			double min = std::numeric_limits<double>::infinity();
+			double max = -std::numeric_limits<double>::infinity();
+		};
+		static void Add(Aggregate& a, double x) {
+			a.min = x < a.min ? x : a.min;
+			a.max = x > a.max ? x : a.max;
+		}
+		static void Merge(Aggregate& a, const Aggregate& b) {
+			a.min = b.min < a.min ? b.min : a.min;
+			a.max = b.max > a.max ? b.max : a.max;
+		}
+	};
+
+	// Calls emit(j, aggregate of data[j, j + Window)) for every j in [first, last), in order.
+	// Blocks of Window windows start at first; for the block starting at s the suffixes of data[s, s + Window)
+	// are stored, and the prefixes of data[s + Window, s + 2 Window - 1) are accumulated while emitting.
+	template <typename Policy, typename Emit>
+	void RollingWindows(const double* data, std::size_t Window, std::size_t first, std::size_t last, Emit&& emit) {
+		using Aggregate = typename Policy::Aggregate;
+		std::vector<Aggregate> Suffixes(Window);
+		for (std::size_t s = first; s < last; s += Window) {
+			Aggregate suffix;
+			for (std::size_t t = Window; t-- > 0;) {
+				// suffix covers data[s + t, s + Window): the new element goes in front of the later ones
+				Aggregate element;
+				Policy::Add(element, data[s + t]);
+				Policy::Merge(element, suffix);
+				suffix = element;
+				Suffixes[t] = suffix;
+			}
+			emit(s, Suffixes[0]);
+			Aggregate prefix;
+			for (std::size_t t = 1; t < Window && s + t < last; ++t) {
+				Policy::Add(prefix, data[s + Window + t - 1]);
+				Aggregate window = Suffixes[t];
+				Policy::Merge(window, prefix);
+				emit(s + t, window);
+			}
+		}
+	}
+
+	// Runs RollingWindows over all windows of vec, on one thread or split over the pool
+	template <typename Policy, typename Emit>
+	bool ForEachWindow(std::span<const double> vec, std::size_t Window, ThreadPool* pool, Emit&& emit) {
+		if (Window == 0 || Window > vec.size()) {
+			return false;
+		}
+		const std::size_t NumOfWindows = vec.size() - Window + 1;
+		if (pool == nullptr) {
+			RollingWindows<Policy>(vec.data(), Window, 0, NumOfWindows, emit);
+			return true;
+		}
+		const unsigned int NumOfThreads = pool->size();
+		pool->ParallelFor(NumOfThreads, [&](unsigned int i) {
+			RollingWindows<Policy>(vec.data(), Window, ChunkBegin(i, NumOfWindows, NumOfThreads), ChunkBegin(i + 1, NumOfWindows, NumOfThreads), emit);
+			});
+		return true;
+	}
+
+	void RollingSumOf(std::span<const double> vec, std::size_t Window, std::vector<double>& out, ThreadPool* pool) {
+		out.resize(Window == 0 || Window > vec.size() ? 0 : vec.size() - Window + 1);
+		ForEachWindow<SumPolicy>(vec, Window, pool, [&](std::size_t j, const CompensatedSum& window) { out[j] = window.Result(); });
+	}
+
+	void RollingProductOf(std::span<const double> vec, std::size_t Window, std::vector<double>& out, ThreadPool* pool) {
+		out.resize(Window == 0 || Window > vec.size() ? 0 : vec.size() - Window + 1);
+		ForEachWindow<ProductPolicy>(vec, Window, pool, [&](std::size_t j, const ProductPolicy::Aggregate& window) { out[j] = window.product; });
+	}
+
+	void RollingMinMaxOf(std::span<const double> vec, std::size_t Window, std::vector<double>& min, std::vector<double>& max, ThreadPool* pool) {
+		min.resize(Window == 0 || Window > vec.size() ? 0 : vec.size() - Window + 1);
+		max.resize(min.size());
+		ForEachWindow<MinMaxPolicy>(vec, Window, pool, [&](std::size_t j, const MinMaxPolicy::Aggregate& window) {
+			min[j] = window.min;
+			max[j] = window.max;
+			});
+	}
+}
+
+// Method (50) Rolling sum
+void RollingVectorOperations::RollingSum(std::size_t Window, std::vector<double>& out, bool Time) const {
+	Timer timeit(Time);
+	RollingSumOf(vec, Window, out, nullptr);
+}
+
+// Method (51) Rolling product
+void RollingVectorOperations::RollingProduct(std::size_t Window, std::vector<double>& out, bool Time) const {
+	Timer timeit(Time);
+	RollingProductOf(vec, Window, out, nullptr);
+}
+
+// Method (52) Rolling min and max
+void RollingVectorOperations::RollingMinMax(std::size_t Window, std::vector<double>& min, std::vector<double>& max, bool Time) const {
+	Timer timeit(Time);
+	RollingMinMaxOf(vec, Window, min, max, nullptr);
+}
+
+// Method (53) Rolling sum on the thread pool
+void RollingVectorOperations::RollingSumThreadPool(std::size_t Window, std::vector<double>& out, bool Time) const {
+	Timer timeit(Time);
+	RollingSumOf(vec, Window, out, &pool);
+}
+
+// Method (54) Rolling product on the thread pool
+void RollingVectorOperations::RollingProductThreadPool(std::size_t Window, std::vector<double>& out, bool Time) const {
+	Timer timeit(Time);
+	RollingProductOf(vec, Window, out, &pool);
+}
+
+// Method (55) Rolling min and max on the thread pool
+void RollingVectorOperations::RollingMinMaxThreadPool(std::size_t Window, std::vector<double>& min, std::vector<double>& max, bool Time) const {
+	Timer timeit(Time);
+	RollingMinMaxOf(vec, Window, min, max, &pool);
+}
+
+void RollingWindow::Aggregate::Add(double x) {
+	sum.Add(x);
+	product *= x;
+	min = x < min ? x : min;
+	max = x > max ? x : max;
+}
+
+void RollingWindow::Aggregate::Merge(const Aggregate& other) {
+	sum.Merge(other.sum);
+	product *= other.product;
+	min = other.min < min ? other.min : min;
+	max = other.max > max ? other.max : max;
+}
+
+RollingWindow::RollingWindow(std::size_t Window) : Window(std::max<std::size_t>(Window, 1)) {
+	back.reserve(this->Window);
+	front.reserve(this->Window);
+}
+
+void RollingWindow::Push(double x) {
+	if (Full()) {
+		if (front.empty()) {
+			// Newest first, so every entry aggregates itself and the newer entries below it
+			Aggregate newer;
+			for (std::size_t k = back.size(); k-- > 0;) {
+				Aggregate entry;
+				entry.Add(back[k]);
+				entry.Merge(newer);
+				newer = entry;
+				front.push_back(entry);
+			}
+			back.clear();
+			BackTotal = Aggregate();
+		}
+		front.pop_back();
+	}
+	back.push_back(x);
+	BackTotal.Add(x);
+}
+
+RollingWindow::Aggregate RollingWindow::Total() const {
+	if (front.empty()) {
+		return BackTotal;
+	}
+	Aggregate total = front.back();
+	total.Merge(BackTotal);
+	return total;
+}
+
+double RollingWindow::Sum() const {
+	return Total().sum.Result();
+}
+
+double RollingWindow::Product() const {
+	return Total().product;
+}
+
+double RollingWindow::Min() const {
+	return Total().min;
+}
+
+double RollingWindow::Max() const {
+	return Total().max;
+}
@@ -0,0 +1,77 @@
+#ifndef ROLLINGAGGREGATES_H
+#define ROLLINGAGGREGATES_H
+
+#include "VectorOperations.h"
+#include <vector>
+#include <span>
+
+// Aggregates of every window of `Window` consecutive elements: out[j] covers vec[j, j + Window) for j in
+// [0, size() - Window], so out has size() - Window + 1 elements (none if Window is 0 or larger than size()).
+// All of them run in O(N) whatever the window, with no subtraction or division (van Herk / Gil-Werman): the
+// windows are taken Window at a time, and for each such block of windows the suffixes of the block's first
+// Window elements and the prefixes of the next Window elements are accumulated once; window j is then the
+// suffix from j combined with the prefix up to j + Window - 1. So nothing drifts along the series, an infinity
+// or a NaN only affects the windows holding it, and zeros and sign changes in a product are exact.
+// Sums accumulate the suffixes and prefixes as CompensatedSum (Neumaier), products are plain doubles (no
+// overflow protection, like method 19), and min/max ignore NaNs (+inf/-inf for a window of NaNs only).
+// Methods 53-55 give each pool thread a contiguous range of windows, and so of the data plus a Window - 1 overlap.
+// Syntax: std::vector<double> sums; RollingVectorOperations(data).RollingSum(20, sums, false);
+class RollingVectorOperations : public VectorOperationsBase {
+private:
+    ThreadPool& pool;
+public:
+    RollingVectorOperations(const std::vector<double>& vec, ThreadPool& pool = ThreadPool::Global()) : VectorOperationsBase(vec), pool(pool) {}
+    RollingVectorOperations(std::span<const double> view, ThreadPool& pool = ThreadPool::Global()) : VectorOperationsBase(view), pool(pool) {}
+
+    // Methods 50-52: one thread
+    void RollingSum(std::size_t Window, std::vector<double>& out, bool Time = true) const;
+    void RollingProduct(std::size_t Window, std::vector<double>& out, bool Time = true) const;
+    void RollingMinMax(std::size_t Window, std::vector<double>& min, std::vector<double>& max, bool Time = true) const;
+    // Methods 53-55: the same on the pool, with the same results
+    void RollingSumThreadPool(std::size_t Window, std::vector<double>& out, bool Time = true) const;
+    void RollingProductThreadPool(std::size_t Window, std::vector<double>& out, bool Time = true) const;
+    void RollingMinMaxThreadPool(std::size_t Window, std::vector<double>& min, std::vector<double>& max, bool Time = true) const;
+};
+
+// Streaming form: Push() appends one value, dropping the oldest once the window is full, and the aggregates
+// of the values in the window are available after every push in amortized O(1).
+// The window is a queue made of two stacks: values are pushed on the back stack, which keeps their running
+// aggregate; when the oldest value must go and the front stack is empty, the back stack is moved onto the
+// front one, each entry keeping the aggregate of itself and every newer entry of the front stack. The window
+// aggregate is then the front top's combined with the back's, again without subtraction or division.
+// Syntax: RollingWindow window(20); for (double x : series) { window.Push(x); if (window.Full()) use(window.Sum()); }
+class RollingWindow {
+public:
+    // Window must be at least 1
+    explicit RollingWindow(std::size_t Window);
+
+    void Push(double x);
+    // Number of values in the window, at most Window
+    std::size_t size() const { return front.size() + back.size(); }
+    bool Full() const { return size() == Window; }
+
+    double Sum() const;
+    double Product() const;
+    // +inf / -inf while the window holds no number
+    double Min() const;
+    double Max() const;
+
+private:
+    struct Aggregate {
+        CompensatedSum sum;
+        double product = 1.0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+
+        void Add(double x);
+        void Merge(const Aggregate& other);
+    };
+    Aggregate Total() const;
+
+    std::size_t Window;
+    std::vector<double> back;      // newest values, oldest first
+    Aggregate BackTotal;
+    std::vector<Aggregate> front;  // oldest values; front.back() is the oldest and aggregates the whole stack
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "ScaledProduct.h"
+#include "SimdKernels.h"
+#include <cmath>
+#include <limits>
+
+void ScaledProduct::Multiply(double x) {
+	if (std::isnan(x)) {
+		nan = true;
+		return;
+	}
+	negative ^= std::signbit(x);
+	if (x == 0.0) {
+		zero = true;
+		return;
+	}
+	if (std::isinf(x)) {
+		infinite = true;
+		return;
+	}
+	int e;
+	mantissa *= std::frexp(std::fabs(x), &e); // [0.25, 1)
+	exponent += e;
+	mantissa = std::frexp(mantissa, &e);
+	exponent += e;
+}
+
+void ScaledProduct::Merge(const ScaledProduct& other) {
+	negative ^= other.negative;
+	zero |= other.zero;
+	infinite |= other.infinite;
+	nan |= other.nan;
+	int e;
+	mantissa = std::frexp(mantissa * other.mantissa, &e);
+	exponent += other.exponent + e;
+}
+
+double ScaledProduct::ToDouble() const {
+	if (nan || (zero && infinite)) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+	double magnitude;
+	if (zero) {
+		magnitude = 0.0;
+	}
+	else if (infinite || exponent > std::numeric_limits<int>::max()) {
+		magnitude = std::numeric_limits<double>::infinity();
+	}
+	else if (exponent < std::numeric_limits<int>::min()) {
+		magnitude = 0.0;
+	}
+	else {
+		magnitude = std::ldexp(mantissa, static_cast<int>(exponent));
+	}
+	return negative ? -magnitude : magnitude;
+}
+
+double ScaledProduct::LogAbs() const {
+	if (nan || (zero && infinite)) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+	if (zero) {
+		return -std::numeric_limits<double>::infinity();
+	}
+	if (infinite) {
+		return std::numeric_limits<double>::infinity();
+	}
+	return std::log(mantissa) + static_cast<double>(exponent) * std::log(2.0);
+}
+
+ScaledProduct ScaledProductOf(const double* data, std::size_t size) {
+	return BestSimdKernels().scaled_product(data, size);
+}
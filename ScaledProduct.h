@@ -0,0 +1,35 @@
+#ifndef SCALEDPRODUCT_H
+#define SCALEDPRODUCT_H
+
+#include <cstddef>
+
+// Product kept as a sign, a mantissa in [0.5, 1) (1.0 for the empty product) and a 64-bit binary exponent, so it
+// neither overflows nor underflows: |product| = mantissa * 2^exponent.
+// Zeros, infinities and NaNs are tracked as flags and give the IEEE result in ToDouble().
+struct ScaledProduct {
+    bool negative = false;
+    bool zero = false;
+    bool infinite = false;
+    bool nan = false;
+    double mantissa = 1.0;
+    long long exponent = 0;
+
+    // Multiplies by one factor (the slow, exact path; ScaledProductOf batches it)
+    void Multiply(double x);
+    // Multiplies by another partial product, so per-thread results combine in any order
+    void Merge(const ScaledProduct& other);
+
+    // The product as a double: +-inf or +-0 when it does not fit, NaN for 0 * inf or a NaN factor
+    double ToDouble() const;
+    // Natural logarithm of |product|: -inf for a zero product, +inf for an infinite one
+    double LogAbs() const;
+    int Sign() const { return nan || zero ? 0 : (negative ? -1 : 1); }
+};
+
+// Product of data[0, size), on the SIMD kernels of the host (the scaled_product kernel of SimdKernels.h).
+// Works on batches of 8 lanes x 32 elements: every element is split into its exponent bits (summed as
+// integers) and its mantissa in [1, 2) (multiplied, at most 2^32 per lane), and the lanes are renormalized
+// after each batch. A batch holding a zero, a subnormal, an infinity or a NaN is redone element by element.
+ScaledProduct ScaledProductOf(const double* data, std::size_t size);
+
+#endif
@@ -0,0 +1,413 @@
+#include "ShardedVectorOperations.h"
+#include "SimdKernels.h"
+#include "ThreadPool.h"
+#include "VectorFile.h"
+#include "Timer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <system_error>
+#include <thread>
+#include <mutex>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+bool SharedVector::Create(std::size_t size) {
+	fd = memfd_create("VectorOperations", MFD_CLOEXEC);
+	if (fd < 0 || ftruncate(fd, static_cast<off_t>(size * sizeof(double))) != 0) {
+		return false;
+	}
+	count = size;
+	writable = true;
+	if (size > 0) {
+		map_size = size * sizeof(double);
+		map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED) {
+			map = nullptr;
+			return false;
+		}
+		values = static_cast<double*>(map);
+	}
+	return true;
+}
+
+SharedVector::SharedVector(std::size_t size) {
+	valid = Create(size);
+}
+
+SharedVector::SharedVector(std::span<const double> data) {
+	valid = Create(data.size());
+	if (valid) {
+		std::copy(data.begin(), data.end(), values);
+	}
+}
+
+SharedVector::SharedVector(const std::string& VectorFilePath) {
+	{
+		MappedVectorFile file(VectorFilePath);
+		if (!file.IsValid() || file.dtype() != VectorDType::Float64) {
+			return;
+		}
+		offset = file.header().data_offset;
+		count = file.size();
+	}
+	fd = open(VectorFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return;
+	}
+	map_size = offset + count * sizeof(double);
+	map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		map = nullptr;
+		return;
+	}
+	values = reinterpret_cast<double*>(static_cast<unsigned char*>(map) + offset);
+	valid = true;
+}
+
+SharedVector::~SharedVector() {
+	if (map != nullptr) {
+		munmap(map, map_size);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+namespace
+{
+	enum ShardOp : std::uint32_t { ShardSum = 1, ShardCompensatedSum, ShardProduct, ShardAdjDiff };
+
+	// One message each way on the SOCK_SEQPACKET socket. The file descriptors of the input (and of the output for
+	// ShardAdjDiff) travel with the request as SCM_RIGHTS; the worker maps bytes [0, *_bytes) of each.
+	struct ShardRequest {
+		std::uint64_t call;
+		std::uint32_t op;
+		std::uint64_t begin;
+		std::uint64_t end;
+		std::uint64_t input_offset;
+		std::uint64_t input_bytes;
+		std::uint64_t output_bytes;
+	};
+
+	// Shard [begin, end) of data (non-empty); out is only written by ShardAdjDiff
+	ShardResult ComputeShard(std::uint64_t call, std::uint32_t op, std::size_t begin, std::size_t end, const double* data, double* out) {
+		const SimdKernels& kernels = BestSimdKernels();
+		ShardResult result;
+		result.call = call;
+		result.begin = begin;
+		result.end = end;
+		result.first = data[begin];
+		result.last = data[end - 1];
+		if (op == ShardSum) {
+			result.value = kernels.sum(data + begin, end - begin);
+		}
+		else if (op == ShardCompensatedSum) {
+			const CompensatedSum partial = kernels.compensated_sum(data + begin, end - begin);
+			result.value = partial.sum;
+			result.compensation = partial.compensation;
+		}
+		else if (op == ShardProduct) {
+			result.value = kernels.product(data + begin, end - begin);
+		}
+		else if (op == ShardAdjDiff) {
+			out[begin] = data[begin];
+			kernels.adjacent_difference(data + begin, end - begin, out + begin);
+		}
+		return result;
+	}
+
+	bool SendRequest(int socket, const ShardRequest& request, int input, int output) {
+		iovec io{const_cast<ShardRequest*>(&request), sizeof(request)};
+		const int fds[2] = {input, output};
+		const std::size_t NumOfFds = output >= 0 ? 2 : 1;
+		alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+		msghdr message{};
+		message.msg_iov = &io;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = CMSG_SPACE(NumOfFds * sizeof(int));
+		cmsghdr* header = CMSG_FIRSTHDR(&message);
+		header->cmsg_level = SOL_SOCKET;
+		header->cmsg_type = SCM_RIGHTS;
+		header->cmsg_len = CMSG_LEN(NumOfFds * sizeof(int));
+		std::memcpy(CMSG_DATA(header), fds, NumOfFds * sizeof(int));
+		return sendmsg(socket, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(request));
+	}
+
+	// A worker's mapping of an input or output, kept while the same file (and length) comes back
+	struct WorkerMapping {
+		dev_t device = 0;
+		ino_t inode = 0;
+		std::size_t bytes = 0;
+		bool writable = false;
+		void* map = nullptr;
+
+		// Maps fd (which it closes), or returns the current mapping if fd is the same file
+		unsigned char* Map(int fd, std::size_t length, bool write) {
+			struct stat status;
+			if (fstat(fd, &status) != 0) {
+				close(fd);
+				return nullptr;
+			}
+			if (map == nullptr || status.st_dev != device || status.st_ino != inode || length != bytes || write != writable) {
+				if (map != nullptr) {
+					munmap(map, bytes);
+					map = nullptr;
+				}
+				void* mapped = mmap(nullptr, length, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+				if (mapped != MAP_FAILED) {
+					map = mapped;
+					device = status.st_dev;
+					inode = status.st_ino;
+					bytes = length;
+					writable = write;
+				}
+			}
+			close(fd);
+			return static_cast<unsigned char*>(map);
+		}
+	};
+
+	// Body of a worker process: answers requests until it reads end of file, once the coordinator has closed its end of
+	// the socket or exited
+	[[noreturn]] void WorkerMain(int socket) {
+		WorkerMapping input, output;
+		for (;;) {
+			ShardRequest request;
+			iovec io{&request, sizeof(request)};
+			alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))];
+			msghdr message{};
+			message.msg_iov = &io;
+			message.msg_iovlen = 1;
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+			if (recvmsg(socket, &message, MSG_CMSG_CLOEXEC) != static_cast<ssize_t>(sizeof(request))) {
+				_exit(0);
+			}
+			int fds[2] = {-1, -1};
+			cmsghdr* header = CMSG_FIRSTHDR(&message);
+			if (header == nullptr || header->cmsg_type != SCM_RIGHTS) {
+				_exit(1);
+			}
+			std::memcpy(fds, CMSG_DATA(header), header->cmsg_len - CMSG_LEN(0));
+			const unsigned char* in = input.Map(fds[0], request.input_bytes, false);
+			unsigned char* out = fds[1] >= 0 ? output.Map(fds[1], request.output_bytes, true) : nullptr;
+			if (in == nullptr || (request.op == ShardAdjDiff && out == nullptr) || request.begin >= request.end) {
+				_exit(1);
+			}
+			const ShardResult result = ComputeShard(request.call, request.op, request.begin, request.end,
+				reinterpret_cast<const double*>(in + request.input_offset), reinterpret_cast<double*>(out));
+			if (send(socket, &result, sizeof(result), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(result))) {
+				_exit(0);
+			}
+		}
+	}
+}
+
+ShardWorkers::ShardWorkers(unsigned int NumOfWorkers, const ShardWorkerOptions& options)
+	: options(options), workers(NumOfWorkers ? NumOfWorkers : std::max(1u, std::thread::hardware_concurrency())) {
+	BestSimdKernels(); // detected once here, so the children do not run the detection's static initialization
+	try {
+		for (unsigned int i = 0; i < workers.size(); ++i) {
+			Spawn(i);
+		}
+	}
+	catch (...) {
+		for (Worker& worker : workers) {
+			Stop(worker);
+		}
+		throw;
+	}
+}
+
+ShardWorkers::~ShardWorkers() {
+	for (Worker& worker : workers) {
+		Stop(worker);
+	}
+}
+
+// Each step is guarded: a slot left empty by a failed Replace has pid and socket -1, and kill(-1) signals every process
+// of the user
+void ShardWorkers::Stop(Worker& worker) {
+	if (worker.socket >= 0) {
+		close(worker.socket);
+	}
+	if (worker.pid > 0) {
+		kill(worker.pid, SIGKILL);
+		waitpid(worker.pid, nullptr, 0);
+	}
+	worker = Worker();
+}
+
+void ShardWorkers::Spawn(unsigned int i) {
+	int sockets[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets) != 0) {
+		throw std::system_error(errno, std::generic_category(), "socketpair");
+	}
+	const pid_t pid = fork();
+	if (pid < 0) {
+		const int error = errno;
+		close(sockets[0]);
+		close(sockets[1]);
+		throw std::system_error(error, std::generic_category(), "fork");
+	}
+	if (pid == 0) {
+		// Holding the coordinator's end of another worker's socket would keep that worker from seeing it closed
+		for (const Worker& other : workers) {
+			if (other.socket >= 0) {
+				close(other.socket);
+			}
+		}
+		close(sockets[0]);
+		WorkerMain(sockets[1]);
+	}
+	close(sockets[1]);
+	workers[i].pid = pid;
+	workers[i].socket = sockets[0];
+}
+
+void ShardWorkers::Replace(unsigned int i) {
+	Stop(workers[i]);
+	++replaced;
+	try {
+		Spawn(i);
+	}
+	catch (const std::system_error&) {
+		// Left empty: Run computes the shards of this slot in-process
+	}
+}
+
+// Sends shard s to worker s and collects the replies, holding the workers for the whole call. A failed send, a closed
+// socket, a short reply, a reply for another range or a timeout replaces the worker and sends the shard again; after
+// MaxAttempts, or at once if the slot has no worker, the coordinator computes the shard itself. A reply numbered for
+// an earlier call (left queued when that call threw) is dropped.
+std::vector<ShardResult> ShardedVectorOperations::Run(unsigned int op, SharedVector* out) const {
+	std::lock_guard<std::mutex> dispatch(workers.dispatch_mtx);
+	const std::uint64_t call = ++workers.calls;
+	const std::size_t size = source.IsValid() ? source.size() : 0;
+	const unsigned int NumOfShards = static_cast<unsigned int>(std::min<std::size_t>(workers.size(), size));
+	std::vector<ShardResult> results(NumOfShards);
+	std::vector<unsigned int> attempts(NumOfShards, 0);
+	std::vector<bool> done(NumOfShards, false);
+	std::vector<std::chrono::steady_clock::time_point> deadlines(NumOfShards);
+	const ShardWorkerOptions& options = workers.options;
+
+	auto Dispatch = [&](unsigned int s) {
+		const ShardRequest request{call, op, ChunkBegin(s, size, NumOfShards), ChunkBegin(s + 1, size, NumOfShards), source.offset,
+			source.offset + size * sizeof(double), out != nullptr ? size * sizeof(double) : 0};
+		while (attempts[s] < options.MaxAttempts && workers.workers[s].socket >= 0) {
+			++attempts[s];
+			if (SendRequest(workers.workers[s].socket, request, source.fd, out != nullptr ? out->fd : -1)) {
+				deadlines[s] = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.TimeoutMs);
+				return;
+			}
+			workers.Replace(s);
+		}
+		results[s] = ComputeShard(call, op, request.begin, request.end, source.values, out != nullptr ? out->values : nullptr);
+		done[s] = true;
+		++workers.local;
+	};
+	auto Retry = [&](unsigned int s) {
+		workers.Replace(s);
+		Dispatch(s);
+	};
+
+	for (unsigned int s = 0; s < NumOfShards; ++s) {
+		Dispatch(s);
+	}
+	std::vector<pollfd> polled;
+	std::vector<unsigned int> shards;
+	for (;;) {
+		polled.clear();
+		shards.clear();
+		auto deadline = std::chrono::steady_clock::time_point::max();
+		for (unsigned int s = 0; s < NumOfShards; ++s) {
+			if (!done[s]) {
+				polled.push_back({workers.workers[s].socket, POLLIN, 0});
+				shards.push_back(s);
+				deadline = std::min(deadline, deadlines[s]);
+			}
+		}
+		if (polled.empty()) {
+			break;
+		}
+		const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+		if (poll(polled.data(), polled.size(), static_cast<int>(std::max<long long>(0, wait) + 1)) < 0 && errno != EINTR) {
+			throw std::system_error(errno, std::generic_category(), "poll");
+		}
+		const auto now = std::chrono::steady_clock::now();
+		for (std::size_t k = 0; k < polled.size(); ++k) {
+			const unsigned int s = shards[k];
+			if (polled[k].revents & POLLIN) {
+				ShardResult result;
+				const bool received = recv(polled[k].fd, &result, sizeof(result), 0) == static_cast<ssize_t>(sizeof(result));
+				if (received && result.call != call) {
+					continue;
+				}
+				if (received && result.begin == ChunkBegin(s, size, NumOfShards) && result.end == ChunkBegin(s + 1, size, NumOfShards)) {
+					results[s] = result;
+					done[s] = true;
+					continue;
+				}
+				Retry(s);
+			}
+			else if (polled[k].revents & (POLLHUP | POLLERR) || now >= deadlines[s]) {
+				Retry(s);
+			}
+		}
+	}
+	return results;
+}
+
+// Method (61) Sum over worker processes, partial sums added in shard order
+double ShardedVectorOperations::ComputeSum(bool Time) const {
+	Timer timeit(Time);
+	double total_sum = 0.0;
+	for (const ShardResult& shard : Run(ShardSum, nullptr)) {
+		total_sum += shard.value;
+	}
+	return total_sum;
+}
+
+// Method (62) Neumaier compensated sum over worker processes, the shards' pairs merged in shard order
+double ShardedVectorOperations::ComputeCompensatedSum(bool Time) const {
+	Timer timeit(Time);
+	CompensatedSum total;
+	for (const ShardResult& shard : Run(ShardCompensatedSum, nullptr)) {
+		total.Merge(CompensatedSum{shard.value, shard.compensation});
+	}
+	return total.Result();
+}
+
+// Method (63) Product over worker processes, partial products multiplied in shard order
+double ShardedVectorOperations::ComputeProduct(bool Time) const {
+	Timer timeit(Time);
+	double product = 1.0;
+	for (const ShardResult& shard : Run(ShardProduct, nullptr)) {
+		product *= shard.value;
+	}
+	return product;
+}
+
+// Method (64) Adjacent difference over worker processes into shared memory
+bool ShardedVectorOperations::ComputeAdjDiff(SharedVector& diff, bool Time) const {
+	Timer timeit(Time);
+	if (!diff.IsValid() || !diff.writable || diff.size() != source.size()) {
+		return false;
+	}
+	const std::vector<ShardResult> shards = Run(ShardAdjDiff, &diff);
+	// Step 2 of method 13: every shard but the first started from its own first element
+	for (std::size_t s = 1; s < shards.size(); ++s) {
+		diff.values[shards[s].begin] = shards[s].first - shards[s - 1].last;
+	}
+	return true;
+}
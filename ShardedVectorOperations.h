@@ -0,0 +1,127 @@
+#ifndef SHARDEDVECTOROPERATIONS_H
+#define SHARDEDVECTOROPERATIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+#include <mutex>
+#include <sys/types.h>
+
+// Vector of doubles in memory that other processes can map: a shared memory file (memfd) holding `size` zeros or a
+// copy of a span, or the data of a Float64 vector file in the library's format (VectorFile.h), mapped from the file
+// itself so the workers read it straight from the page cache. IsValid() is false if the memory cannot be created or
+// the file is missing, malformed or of another element type. A file is mapped read-only.
+class SharedVector {
+public:
+    explicit SharedVector(std::size_t size);
+    explicit SharedVector(std::span<const double> data);
+    explicit SharedVector(const std::string& VectorFilePath);
+    ~SharedVector();
+    SharedVector(const SharedVector&) = delete;
+    SharedVector& operator=(const SharedVector&) = delete;
+
+    bool IsValid() const { return valid; }
+    std::size_t size() const { return count; }
+    std::span<const double> data() const { return std::span<const double>(values, valid ? count : 0); }
+    // Empty for a file
+    std::span<double> MutableData() { return std::span<double>(writable ? values : nullptr, writable ? count : 0); }
+
+private:
+    friend class ShardedVectorOperations;
+    bool Create(std::size_t size);
+
+    int fd = -1;
+    std::size_t offset = 0;     // bytes from the start of the file to element 0
+    std::size_t count = 0;
+    void* map = nullptr;
+    std::size_t map_size = 0;
+    double* values = nullptr;
+    bool writable = false;
+    bool valid = false;
+};
+
+struct ShardWorkerOptions {
+    int TimeoutMs = 10000;       // a shard not answered within this time counts as a lost worker
+    unsigned int MaxAttempts = 3; // per shard on worker processes (each on a new worker), then it is computed in-process
+};
+
+// Persistent local worker processes, forked once and reused by every sharded call, the multi-process counterpart of
+// ThreadPool. Each worker is connected to the coordinator by a Unix socket pair; a request carries the shard's element
+// range and the file descriptors of the shared input (and output), which the worker maps and keeps mapped while the
+// same vector comes back. A worker that exits, is killed or does not answer within TimeoutMs is killed, reaped and
+// replaced by a new process, and its shard is sent again; if no new process can be forked the slot stays empty and its
+// shards are computed by the coordinator. A worker exits when it reads end of file on its socket, so it outlives the
+// thread that forked it and dies with the coordinator (or once no process holds the coordinator's end any more).
+// Like ThreadPool::ParallelFor, sharded calls on the same workers from several threads run one at a time.
+// Syntax: ShardWorkers workers(4); SharedVector data(values); double s = ShardedVectorOperations(data, workers).ComputeSum();
+class ShardWorkers {
+public:
+    // NumOfWorkers = 0 uses std::thread::hardware_concurrency()
+    explicit ShardWorkers(unsigned int NumOfWorkers = 0, const ShardWorkerOptions& options = {});
+    ~ShardWorkers();
+    ShardWorkers(const ShardWorkers&) = delete;
+    ShardWorkers& operator=(const ShardWorkers&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()); }
+    pid_t WorkerPid(unsigned int i) const { std::lock_guard<std::mutex> lock(dispatch_mtx); return workers[i].pid; }
+    // Workers replaced since construction, and shards the coordinator computed itself after MaxAttempts
+    std::size_t WorkersReplaced() const { std::lock_guard<std::mutex> lock(dispatch_mtx); return replaced; }
+    std::size_t ShardsComputedLocally() const { std::lock_guard<std::mutex> lock(dispatch_mtx); return local; }
+
+private:
+    friend class ShardedVectorOperations;
+    struct Worker {
+        pid_t pid = -1;
+        int socket = -1;
+    };
+    void Spawn(unsigned int i);
+    // Kills and reaps worker i and forks a new one; the slot is left empty (pid and socket -1) if that fails
+    void Replace(unsigned int i);
+    void Stop(Worker& worker);
+
+    ShardWorkerOptions options;
+    mutable std::mutex dispatch_mtx;   // one sharded call at a time: requests and replies share the sockets
+    std::vector<Worker> workers;
+    std::size_t replaced = 0;
+    std::size_t local = 0;
+    std::uint64_t calls = 0;   // numbers the requests of each sharded call, so a late reply to an earlier one is dropped
+};
+
+// Partial results of one shard, computed by a worker (or by the coordinator for a shard given up on)
+struct ShardResult {
+    std::uint64_t call = 0;      // sequence number of the sharded call, echoed from the request
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    double value = 0.0;          // sum or product of the shard
+    double compensation = 0.0;   // of the compensated sum
+    double first = 0.0;          // data[begin] and data[end - 1], the boundaries of the adjacent difference
+    double last = 0.0;
+};
+
+// Methods 61-64 split `source` into one contiguous shard per worker (ChunkBegin), have each worker process compute
+// its shard with the SIMD kernels of the host and combine the partial results in shard order, so the results do not
+// depend on which process computed a shard, nor on a worker being replaced mid-call:
+//   sum (61) and product (63) as methods 15 and 16, the compensated sum (62) merging the Neumaier pairs as method 23,
+//   the adjacent difference (64) computing every shard on its own (diff[begin] = data[begin]) and then correcting
+//   the first difference of every shard but the first from the boundary values, as method 13.
+// An invalid source is processed as an empty vector.
+class ShardedVectorOperations {
+public:
+    ShardedVectorOperations(const SharedVector& source, ShardWorkers& workers) : source(source), workers(workers) {}
+
+    double ComputeSum(bool Time = true) const;
+    double ComputeCompensatedSum(bool Time = true) const;
+    double ComputeProduct(bool Time = true) const;
+    // False (diff unchanged) if diff is read-only, invalid or of another size
+    bool ComputeAdjDiff(SharedVector& diff, bool Time = true) const;
+
+private:
+    std::vector<ShardResult> Run(unsigned int op, SharedVector* out) const;
+
+    const SharedVector& source;
+    ShardWorkers& workers;
+};
+
+#endif
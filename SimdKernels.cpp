@@ -0,0 +1,1172 @@
+#include "SimdKernels.h"
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOROPERATIONS_X86 1
+#endif
+
+namespace
+{
+	// Scalar fallback: four independent accumulators, no intrinsics
+	double SumScalar(const double* data, std::size_t size) {
+		double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			s0 += data[i];
+			s1 += data[i + 1];
+			s2 += data[i + 2];
+			s3 += data[i + 3];
+		}
+		for (; i < size; ++i) {
+			s0 += data[i];
+		}
+		return (s0 + s1) + (s2 + s3);
+	}
+
+	double ProductScalar(const double* data, std::size_t size) {
+		double p0 = 1.0, p1 = 1.0, p2 = 1.0, p3 = 1.0;
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			p0 *= data[i];
+			p1 *= data[i + 1];
+			p2 *= data[i + 2];
+			p3 *= data[i + 3];
+		}
+		for (; i < size; ++i) {
+			p0 *= data[i];
+		}
+		return (p0 * p1) * (p2 * p3);
+	}
+
+	void AdjacentDifferenceScalar(const double* data, std::size_t size, double* out) {
+		for (std::size_t i = 1; i < size; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+	}
+
+	CompensatedSum CompensatedSumScalar(const double* data, std::size_t size) {
+		CompensatedSum a0, a1;
+		std::size_t i = 0;
+		for (; i + 2 <= size; i += 2) {
+			a0.Add(data[i]);
+			a1.Add(data[i + 1]);
+		}
+		if (i < size) {
+			a0.Add(data[i]);
+		}
+		a0.Merge(a1);
+		return a0;
+	}
+
+	// Merges `Lanes` (sum, compensation) lane pairs stored in two arrays with the scalar tail of the data
+	CompensatedSum MergeLanes(const double* sums, const double* compensations, int Lanes, const double* tail, std::size_t TailSize) {
+		CompensatedSum result = CompensatedSumScalar(tail, TailSize);
+		for (int lane = 0; lane < Lanes; ++lane) {
+			result.Merge(CompensatedSum{sums[lane], compensations[lane]});
+		}
+		return result;
+	}
+
+	// Adds the tail to its lanes and combines the 8 lanes in the fixed tree of ordered_sum
+	double OrderedSumCombine(double* lanes, const double* tail, std::size_t TailSize) {
+		for (std::size_t i = 0; i < TailSize; ++i) {
+			lanes[i] += tail[i];
+		}
+		return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+	}
+
+	double OrderedProductCombine(double* lanes, const double* tail, std::size_t TailSize) {
+		for (std::size_t i = 0; i < TailSize; ++i) {
+			lanes[i] *= tail[i];
+		}
+		return ((lanes[0] * lanes[1]) * (lanes[2] * lanes[3])) * ((lanes[4] * lanes[5]) * (lanes[6] * lanes[7]));
+	}
+
+	double OrderedSumScalar(const double* data, std::size_t size) {
+		double lanes[OrderedLanes] = {};
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			for (std::size_t lane = 0; lane < OrderedLanes; ++lane) {
+				lanes[lane] += data[i + lane];
+			}
+		}
+		return OrderedSumCombine(lanes, data + i, size - i);
+	}
+
+	double OrderedProductScalar(const double* data, std::size_t size) {
+		double lanes[OrderedLanes] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			for (std::size_t lane = 0; lane < OrderedLanes; ++lane) {
+				lanes[lane] *= data[i + lane];
+			}
+		}
+		return OrderedProductCombine(lanes, data + i, size - i);
+	}
+
+	// Batches of the scaled product: 8 lanes x 32 elements, so a lane's mantissa product stays below 2^32
+	constexpr int ScaledLanes = 8;
+	constexpr std::size_t ScaledBatch = ScaledLanes * 32;
+	constexpr std::uint64_t SignBit = 0x8000000000000000ull;
+	constexpr std::uint64_t ExponentBits = 0x7ff0000000000000ull;
+	constexpr std::uint64_t MantissaBits = 0x000fffffffffffffull;
+	constexpr std::uint64_t OneBits = 0x3ff0000000000000ull; // exponent field of 1.0
+
+	// Folds one finished batch into `result`: the biased exponent fields of the batch's 32 elements per lane
+	// were summed in `exponents`, the sign bits xor-ed in `signs`. A batch with a special value is redone exactly.
+	void MergeScaledBatch(ScaledProduct& result, const double* mantissas, const std::int64_t* exponents,
+		const std::uint64_t* signs, bool special, const double* batch) {
+		if (special) {
+			for (std::size_t j = 0; j < ScaledBatch; ++j) {
+				result.Multiply(batch[j]);
+			}
+			return;
+		}
+		for (int lane = 0; lane < ScaledLanes; ++lane) {
+			ScaledProduct partial;
+			int e;
+			partial.mantissa = std::frexp(mantissas[lane], &e);
+			partial.exponent = exponents[lane] - 1023 * static_cast<std::int64_t>(ScaledBatch / ScaledLanes) + e;
+			partial.negative = (signs[lane] & SignBit) != 0;
+			result.Merge(partial);
+		}
+	}
+
+	ScaledProduct ScaledProductScalar(const double* data, std::size_t size) {
+		ScaledProduct result;
+		std::size_t i = 0;
+		for (; i + ScaledBatch <= size; i += ScaledBatch) {
+			double mantissas[ScaledLanes] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+			std::int64_t exponents[ScaledLanes] = {};
+			std::uint64_t signs[ScaledLanes] = {};
+			std::uint64_t special = 0;
+			for (std::size_t j = 0; j < ScaledBatch; j += ScaledLanes) {
+				for (int lane = 0; lane < ScaledLanes; ++lane) {
+					std::uint64_t bits;
+					std::memcpy(&bits, data + i + j + lane, sizeof(bits));
+					const std::uint64_t field = bits & ExponentBits;
+					// Exponent field 0 (zero, subnormal) or all ones (inf, NaN) needs the exact path
+					special |= (field == 0) | (field == ExponentBits);
+					signs[lane] ^= bits;
+					exponents[lane] += static_cast<std::int64_t>(field >> 52);
+					bits = (bits & MantissaBits) | OneBits;
+					double m;
+					std::memcpy(&m, &bits, sizeof(m));
+					mantissas[lane] *= m;
+				}
+			}
+			MergeScaledBatch(result, mantissas, exponents, signs, special != 0, data + i);
+		}
+		for (; i < size; ++i) {
+			result.Multiply(data[i]);
+		}
+		return result;
+	}
+
+	// Lane results of a min/max kernel: the best value of each lane and its index (as a double, -1 when
+	// the lane never updated). Picks the smallest (largest) value, the first index on ties, scans the tail,
+	// and falls back to a search when only infinities were seen (they never compare below the +inf start).
+	MinMaxIndex CombineMinMax(const double* mins, const double* MinIndices, const double* maxs, const double* MaxIndices,
+		int Lanes, const double* data, std::size_t size, std::size_t TailStart) {
+		MinMaxIndex result{std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), size, size};
+		for (int lane = 0; lane < Lanes; ++lane) {
+			if (MinIndices[lane] >= 0 && (mins[lane] < result.min || (mins[lane] == result.min && MinIndices[lane] < result.min_index))) {
+				result.min = mins[lane];
+				result.min_index = static_cast<std::size_t>(MinIndices[lane]);
+			}
+			if (MaxIndices[lane] >= 0 && (maxs[lane] > result.max || (maxs[lane] == result.max && MaxIndices[lane] < result.max_index))) {
+				result.max = maxs[lane];
+				result.max_index = static_cast<std::size_t>(MaxIndices[lane]);
+			}
+		}
+		for (std::size_t i = TailStart; i < size; ++i) {
+			if (data[i] < result.min || (data[i] == result.min && i < result.min_index)) {
+				result.min = data[i];
+				result.min_index = i;
+			}
+			if (data[i] > result.max || (data[i] == result.max && i < result.max_index)) {
+				result.max = data[i];
+				result.max_index = i;
+			}
+		}
+		for (std::size_t i = 0; i < size && (result.min_index == size || result.max_index == size); ++i) {
+			if (result.min_index == size && data[i] == result.min) {
+				result.min_index = i;
+			}
+			if (result.max_index == size && data[i] == result.max) {
+				result.max_index = i;
+			}
+		}
+		return result;
+	}
+
+	MinMaxIndex MinMaxScalar(const double* data, std::size_t size) {
+		return CombineMinMax(nullptr, nullptr, nullptr, nullptr, 0, data, size, 0);
+	}
+
+	double SquaredDeviationScalar(const double* data, std::size_t size, double center) {
+		double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			const double d0 = data[i] - center, d1 = data[i + 1] - center, d2 = data[i + 2] - center, d3 = data[i + 3] - center;
+			s0 += d0 * d0;
+			s1 += d1 * d1;
+			s2 += d2 * d2;
+			s3 += d3 * d3;
+		}
+		for (; i < size; ++i) {
+			const double d = data[i] - center;
+			s0 += d * d;
+		}
+		return (s0 + s1) + (s2 + s3);
+	}
+
+	double InclusiveScanScalar(const double* data, std::size_t size, double* out, double carry) {
+		for (std::size_t i = 0; i < size; ++i) {
+			carry += data[i];
+			out[i] = carry;
+		}
+		return carry;
+	}
+
+	void AdjacentDifferenceInPlaceScalar(double* data, std::size_t size, double previous) {
+		for (std::size_t i = size; i-- > 1;) {
+			data[i] -= data[i - 1];
+		}
+		if (size > 0) {
+			data[0] -= previous;
+		}
+	}
+
+	// Elements from 2^960 up (and infinities, NaNs) go straight to the limbs, so the expansions cannot overflow
+	constexpr double ExpansionLimit = 0x1p960;
+
+	// TwoSum: s + e becomes s, and e what s could not hold (exact, with no branch)
+	inline void TwoSumScalar(double& s, double& e) {
+		const double t = s + e;
+		const double b = t - s;
+		e = (s - (t - b)) + (e - b);
+		s = t;
+	}
+
+	// One expansion s0 + s1 + s2, what it cannot hold going to the limbs
+	void SuperaccumulateScalar(const double* data, std::size_t size, Superaccumulator& acc) {
+		double s0 = 0.0, s1 = 0.0, s2 = 0.0;
+		for (std::size_t i = 0; i < size; ++i) {
+			double e = data[i];
+			if (!(std::fabs(e) < ExpansionLimit)) {
+				acc.Add(e);
+				continue;
+			}
+			TwoSumScalar(s0, e);
+			TwoSumScalar(s1, e);
+			TwoSumScalar(s2, e);
+			if (e != 0.0) {
+				acc.Add(e);
+			}
+		}
+		acc.Add(s0);
+		acc.Add(s1);
+		acc.Add(s2);
+	}
+
+	// On data the expansions cannot hold (spread over many binades) nearly every vector flushes, which costs more
+	// than adding the elements to the limbs directly: after a window of 64 vector steps of which more than a
+	// quarter flushed, the next 15 windows go straight to the limbs, then the expansions are tried again
+	struct FlushThrottle {
+		unsigned int steps = 0;
+		unsigned int flushes = 0;
+		unsigned int direct = 0; // windows left to add directly
+
+		void Count(bool flushed) {
+			flushes += flushed;
+			if (++steps == 64) {
+				direct = direct > 0 ? direct - 1 : (flushes > 16 ? 15 : 0);
+				steps = flushes = 0;
+			}
+		}
+	};
+
+	// Adds the `Count` expansion terms stored from the vector lanes, then the scalar tail
+	void FlushExpansions(const double* terms, int Count, const double* tail, std::size_t TailSize, Superaccumulator& acc) {
+		for (int k = 0; k < Count; ++k) {
+			acc.Add(terms[k]);
+		}
+		SuperaccumulateScalar(tail, TailSize, acc);
+	}
+
+#ifdef VECTOROPERATIONS_X86
+	// SSE2: 4 accumulators x 2 lanes
+	double SumSSE2(const double* data, std::size_t size) {
+		__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			a0 = _mm_add_pd(a0, _mm_loadu_pd(data + i));
+			a1 = _mm_add_pd(a1, _mm_loadu_pd(data + i + 2));
+			a2 = _mm_add_pd(a2, _mm_loadu_pd(data + i + 4));
+			a3 = _mm_add_pd(a3, _mm_loadu_pd(data + i + 6));
+		}
+		__m128d a = _mm_add_pd(_mm_add_pd(a0, a1), _mm_add_pd(a2, a3));
+		double lanes[2];
+		_mm_storeu_pd(lanes, a);
+		return lanes[0] + lanes[1] + SumScalar(data + i, size - i);
+	}
+
+	double ProductSSE2(const double* data, std::size_t size) {
+		__m128d a0 = _mm_set1_pd(1.0), a1 = _mm_set1_pd(1.0), a2 = _mm_set1_pd(1.0), a3 = _mm_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			a0 = _mm_mul_pd(a0, _mm_loadu_pd(data + i));
+			a1 = _mm_mul_pd(a1, _mm_loadu_pd(data + i + 2));
+			a2 = _mm_mul_pd(a2, _mm_loadu_pd(data + i + 4));
+			a3 = _mm_mul_pd(a3, _mm_loadu_pd(data + i + 6));
+		}
+		__m128d a = _mm_mul_pd(_mm_mul_pd(a0, a1), _mm_mul_pd(a2, a3));
+		double lanes[2];
+		_mm_storeu_pd(lanes, a);
+		return lanes[0] * lanes[1] * ProductScalar(data + i, size - i);
+	}
+
+	void AdjacentDifferenceSSE2(const double* data, std::size_t size, double* out) {
+		std::size_t i = 1;
+		for (; i + 2 <= size; i += 2) {
+			_mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(data + i), _mm_loadu_pd(data + i - 1)));
+		}
+		for (; i < size; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+	}
+
+	// Same with non-temporal stores from the first vector-aligned element of out on: the output lines are written
+	// straight to memory, without being read first or evicting the input. The fence orders them before later stores.
+	void AdjacentDifferenceStreamSSE2(const double* data, std::size_t size, double* out) {
+		std::size_t i = 1;
+		for (; i < size && reinterpret_cast<std::uintptr_t>(out + i) % 16 != 0; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+		for (; i + 2 <= size; i += 2) {
+			_mm_stream_pd(out + i, _mm_sub_pd(_mm_loadu_pd(data + i), _mm_loadu_pd(data + i - 1)));
+		}
+		for (; i < size; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+		_mm_sfence();
+	}
+
+	// Neumaier step on every lane: t = s + x; c += |s| >= |x| ? (s - t) + x : (x - t) + s; s = t
+	inline void NeumaierSSE2(__m128d& s, __m128d& c, __m128d x) {
+		const __m128d SignMask = _mm_set1_pd(-0.0);
+		__m128d t = _mm_add_pd(s, x);
+		__m128d SLarger = _mm_cmpge_pd(_mm_andnot_pd(SignMask, s), _mm_andnot_pd(SignMask, x));
+		__m128d IfSLarger = _mm_add_pd(_mm_sub_pd(s, t), x);
+		__m128d IfXLarger = _mm_add_pd(_mm_sub_pd(x, t), s);
+		c = _mm_add_pd(c, _mm_or_pd(_mm_and_pd(SLarger, IfSLarger), _mm_andnot_pd(SLarger, IfXLarger)));
+		s = t;
+	}
+
+	// SSE2: 2 (sum, compensation) accumulators x 2 lanes
+	CompensatedSum CompensatedSumSSE2(const double* data, std::size_t size) {
+		__m128d s0 = _mm_setzero_pd(), c0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), c1 = _mm_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			NeumaierSSE2(s0, c0, _mm_loadu_pd(data + i));
+			NeumaierSSE2(s1, c1, _mm_loadu_pd(data + i + 2));
+		}
+		double sums[4], compensations[4];
+		_mm_storeu_pd(sums, s0);
+		_mm_storeu_pd(sums + 2, s1);
+		_mm_storeu_pd(compensations, c0);
+		_mm_storeu_pd(compensations + 2, c1);
+		return MergeLanes(sums, compensations, 4, data + i, size - i);
+	}
+
+	// SSE2: the 8 ordered lanes in 4 registers
+	double OrderedSumSSE2(const double* data, std::size_t size) {
+		__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd();
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			a0 = _mm_add_pd(a0, _mm_loadu_pd(data + i));
+			a1 = _mm_add_pd(a1, _mm_loadu_pd(data + i + 2));
+			a2 = _mm_add_pd(a2, _mm_loadu_pd(data + i + 4));
+			a3 = _mm_add_pd(a3, _mm_loadu_pd(data + i + 6));
+		}
+		double lanes[OrderedLanes];
+		_mm_storeu_pd(lanes, a0);
+		_mm_storeu_pd(lanes + 2, a1);
+		_mm_storeu_pd(lanes + 4, a2);
+		_mm_storeu_pd(lanes + 6, a3);
+		return OrderedSumCombine(lanes, data + i, size - i);
+	}
+
+	double OrderedProductSSE2(const double* data, std::size_t size) {
+		__m128d a0 = _mm_set1_pd(1.0), a1 = _mm_set1_pd(1.0), a2 = _mm_set1_pd(1.0), a3 = _mm_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			a0 = _mm_mul_pd(a0, _mm_loadu_pd(data + i));
+			a1 = _mm_mul_pd(a1, _mm_loadu_pd(data + i + 2));
+			a2 = _mm_mul_pd(a2, _mm_loadu_pd(data + i + 4));
+			a3 = _mm_mul_pd(a3, _mm_loadu_pd(data + i + 6));
+		}
+		double lanes[OrderedLanes];
+		_mm_storeu_pd(lanes, a0);
+		_mm_storeu_pd(lanes + 2, a1);
+		_mm_storeu_pd(lanes + 4, a2);
+		_mm_storeu_pd(lanes + 6, a3);
+		return OrderedProductCombine(lanes, data + i, size - i);
+	}
+
+	// SSE2: running min/max and their indices in 2 lanes, blended with and/andnot/or
+	MinMaxIndex MinMaxSSE2(const double* data, std::size_t size) {
+		__m128d mn = _mm_set1_pd(std::numeric_limits<double>::infinity()), mx = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+		__m128d MinIndex = _mm_set1_pd(-1.0), MaxIndex = _mm_set1_pd(-1.0);
+		__m128d index = _mm_set_pd(1.0, 0.0);
+		const __m128d step = _mm_set1_pd(2.0);
+		std::size_t i = 0;
+		for (; i + 2 <= size; i += 2) {
+			__m128d x = _mm_loadu_pd(data + i);
+			__m128d lt = _mm_cmplt_pd(x, mn), gt = _mm_cmpgt_pd(x, mx);
+			mn = _mm_or_pd(_mm_and_pd(lt, x), _mm_andnot_pd(lt, mn));
+			MinIndex = _mm_or_pd(_mm_and_pd(lt, index), _mm_andnot_pd(lt, MinIndex));
+			mx = _mm_or_pd(_mm_and_pd(gt, x), _mm_andnot_pd(gt, mx));
+			MaxIndex = _mm_or_pd(_mm_and_pd(gt, index), _mm_andnot_pd(gt, MaxIndex));
+			index = _mm_add_pd(index, step);
+		}
+		double mins[2], MinIndices[2], maxs[2], MaxIndices[2];
+		_mm_storeu_pd(mins, mn);
+		_mm_storeu_pd(MinIndices, MinIndex);
+		_mm_storeu_pd(maxs, mx);
+		_mm_storeu_pd(MaxIndices, MaxIndex);
+		return CombineMinMax(mins, MinIndices, maxs, MaxIndices, 2, data, size, i);
+	}
+
+	double SquaredDeviationSSE2(const double* data, std::size_t size, double center) {
+		const __m128d c = _mm_set1_pd(center);
+		__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			__m128d d0 = _mm_sub_pd(_mm_loadu_pd(data + i), c), d1 = _mm_sub_pd(_mm_loadu_pd(data + i + 2), c);
+			a0 = _mm_add_pd(a0, _mm_mul_pd(d0, d0));
+			a1 = _mm_add_pd(a1, _mm_mul_pd(d1, d1));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_add_pd(a0, a1));
+		return lanes[0] + lanes[1] + SquaredDeviationScalar(data + i, size - i, center);
+	}
+
+	// Two vectors per step: each is scanned on its own (shift by one lane and add), the second gets the last lane
+	// of the first, and only then the carry of the previous steps, so the carry chain is one add and one shuffle
+	double InclusiveScanSSE2(const double* data, std::size_t size, double* out, double carry) {
+		const __m128d zero = _mm_setzero_pd();
+		__m128d c = _mm_set1_pd(carry);
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			__m128d x0 = _mm_loadu_pd(data + i), x1 = _mm_loadu_pd(data + i + 2);
+			x0 = _mm_add_pd(x0, _mm_unpacklo_pd(zero, x0));
+			x1 = _mm_add_pd(x1, _mm_unpacklo_pd(zero, x1));
+			x1 = _mm_add_pd(x1, _mm_unpackhi_pd(x0, x0));
+			x0 = _mm_add_pd(x0, c);
+			x1 = _mm_add_pd(x1, c);
+			_mm_storeu_pd(out + i, x0);
+			_mm_storeu_pd(out + i + 2, x1);
+			c = _mm_unpackhi_pd(x1, x1);
+		}
+		return InclusiveScanScalar(data + i, size - i, out + i, _mm_cvtsd_f64(c));
+	}
+
+	// From the end, so every element is read before the one after it overwrites it
+	void AdjacentDifferenceInPlaceSSE2(double* data, std::size_t size, double previous) {
+		std::size_t i = size;
+		for (; i >= 3; i -= 2) {
+			_mm_storeu_pd(data + i - 2, _mm_sub_pd(_mm_loadu_pd(data + i - 2), _mm_loadu_pd(data + i - 3)));
+		}
+		AdjacentDifferenceInPlaceScalar(data, i, previous);
+	}
+
+	// TwoSum on every lane
+	inline void TwoSumSSE2(__m128d& s, __m128d& e) {
+		const __m128d t = _mm_add_pd(s, e);
+		const __m128d b = _mm_sub_pd(t, s);
+		e = _mm_add_pd(_mm_sub_pd(s, _mm_sub_pd(t, b)), _mm_sub_pd(e, b));
+		s = t;
+	}
+
+	// SSE2: 2 expansions x 2 lanes; a pair of vectors holding a large element, an infinity or a NaN goes to the
+	// limbs element by element, and lanes the expansions cannot hold are flushed when they occur (see FlushThrottle)
+	void SuperaccumulateSSE2(const double* data, std::size_t size, Superaccumulator& acc) {
+		const __m128d SignMask = _mm_set1_pd(-0.0), Limit = _mm_set1_pd(ExpansionLimit), Zero = _mm_setzero_pd();
+		__m128d a0 = Zero, a1 = Zero, a2 = Zero, b0 = Zero, b1 = Zero, b2 = Zero;
+		std::size_t i = 0;
+		FlushThrottle throttle;
+		for (; i + 4 <= size; i += 4) {
+			if (throttle.direct > 0) {
+				for (std::size_t k = i; k < i + 4; ++k) {
+					acc.Add(data[k]);
+				}
+				throttle.Count(false);
+				continue;
+			}
+			__m128d x = _mm_loadu_pd(data + i), y = _mm_loadu_pd(data + i + 2);
+			const __m128d InRange = _mm_and_pd(_mm_cmplt_pd(_mm_andnot_pd(SignMask, x), Limit), _mm_cmplt_pd(_mm_andnot_pd(SignMask, y), Limit));
+			if (_mm_movemask_pd(InRange) != 0x3) {
+				for (std::size_t k = i; k < i + 4; ++k) {
+					acc.Add(data[k]);
+				}
+				continue;
+			}
+			TwoSumSSE2(a0, x);
+			TwoSumSSE2(b0, y);
+			TwoSumSSE2(a1, x);
+			TwoSumSSE2(b1, y);
+			TwoSumSSE2(a2, x);
+			TwoSumSSE2(b2, y);
+			const bool flushed = _mm_movemask_pd(_mm_or_pd(_mm_cmpneq_pd(x, Zero), _mm_cmpneq_pd(y, Zero))) != 0;
+			throttle.Count(flushed);
+			if (flushed) {
+				double rest[4];
+				_mm_storeu_pd(rest, x);
+				_mm_storeu_pd(rest + 2, y);
+				FlushExpansions(rest, 4, nullptr, 0, acc);
+			}
+		}
+		double terms[12];
+		_mm_storeu_pd(terms, a0);
+		_mm_storeu_pd(terms + 2, a1);
+		_mm_storeu_pd(terms + 4, a2);
+		_mm_storeu_pd(terms + 6, b0);
+		_mm_storeu_pd(terms + 8, b1);
+		_mm_storeu_pd(terms + 10, b2);
+		FlushExpansions(terms, 12, data + i, size - i, acc);
+	}
+
+	// AVX2: 4 accumulators x 4 lanes
+	__attribute__((target("avx2")))
+	double SumAVX2(const double* data, std::size_t size) {
+		__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			a0 = _mm256_add_pd(a0, _mm256_loadu_pd(data + i));
+			a1 = _mm256_add_pd(a1, _mm256_loadu_pd(data + i + 4));
+			a2 = _mm256_add_pd(a2, _mm256_loadu_pd(data + i + 8));
+			a3 = _mm256_add_pd(a3, _mm256_loadu_pd(data + i + 12));
+		}
+		__m256d a = _mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3));
+		double lanes[4];
+		_mm256_storeu_pd(lanes, a);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + SumScalar(data + i, size - i);
+	}
+
+	__attribute__((target("avx2")))
+	double ProductAVX2(const double* data, std::size_t size) {
+		__m256d a0 = _mm256_set1_pd(1.0), a1 = _mm256_set1_pd(1.0), a2 = _mm256_set1_pd(1.0), a3 = _mm256_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			a0 = _mm256_mul_pd(a0, _mm256_loadu_pd(data + i));
+			a1 = _mm256_mul_pd(a1, _mm256_loadu_pd(data + i + 4));
+			a2 = _mm256_mul_pd(a2, _mm256_loadu_pd(data + i + 8));
+			a3 = _mm256_mul_pd(a3, _mm256_loadu_pd(data + i + 12));
+		}
+		__m256d a = _mm256_mul_pd(_mm256_mul_pd(a0, a1), _mm256_mul_pd(a2, a3));
+		double lanes[4];
+		_mm256_storeu_pd(lanes, a);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return (lanes[0] * lanes[1]) * (lanes[2] * lanes[3]) * ProductScalar(data + i, size - i);
+	}
+
+	__attribute__((target("avx2")))
+	void AdjacentDifferenceAVX2(const double* data, std::size_t size, double* out) {
+		std::size_t i = 1;
+		for (; i + 4 <= size; i += 4) {
+			_mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(data + i), _mm256_loadu_pd(data + i - 1)));
+		}
+		for (; i < size; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+	}
+
+	__attribute__((target("avx2")))
+	void AdjacentDifferenceStreamAVX2(const double* data, std::size_t size, double* out) {
+		std::size_t i = 1;
+		for (; i < size && reinterpret_cast<std::uintptr_t>(out + i) % 32 != 0; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+		for (; i + 4 <= size; i += 4) {
+			_mm256_stream_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(data + i), _mm256_loadu_pd(data + i - 1)));
+		}
+		for (; i < size; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+		_mm_sfence();
+	}
+
+	__attribute__((target("avx2")))
+	inline void NeumaierAVX2(__m256d& s, __m256d& c, __m256d x) {
+		const __m256d SignMask = _mm256_set1_pd(-0.0);
+		__m256d t = _mm256_add_pd(s, x);
+		__m256d SLarger = _mm256_cmp_pd(_mm256_andnot_pd(SignMask, s), _mm256_andnot_pd(SignMask, x), _CMP_GE_OQ);
+		__m256d IfSLarger = _mm256_add_pd(_mm256_sub_pd(s, t), x);
+		__m256d IfXLarger = _mm256_add_pd(_mm256_sub_pd(x, t), s);
+		c = _mm256_add_pd(c, _mm256_blendv_pd(IfXLarger, IfSLarger, SLarger));
+		s = t;
+	}
+
+	// AVX2: 2 (sum, compensation) accumulators x 4 lanes
+	__attribute__((target("avx2")))
+	CompensatedSum CompensatedSumAVX2(const double* data, std::size_t size) {
+		__m256d s0 = _mm256_setzero_pd(), c0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			NeumaierAVX2(s0, c0, _mm256_loadu_pd(data + i));
+			NeumaierAVX2(s1, c1, _mm256_loadu_pd(data + i + 4));
+		}
+		double sums[8], compensations[8];
+		_mm256_storeu_pd(sums, s0);
+		_mm256_storeu_pd(sums + 4, s1);
+		_mm256_storeu_pd(compensations, c0);
+		_mm256_storeu_pd(compensations + 4, c1);
+		_mm256_zeroupper(); // MergeLanes is not VEX-encoded
+		return MergeLanes(sums, compensations, 8, data + i, size - i);
+	}
+
+	// AVX2: the 8 ordered lanes in 2 registers
+	__attribute__((target("avx2")))
+	double OrderedSumAVX2(const double* data, std::size_t size) {
+		__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			a0 = _mm256_add_pd(a0, _mm256_loadu_pd(data + i));
+			a1 = _mm256_add_pd(a1, _mm256_loadu_pd(data + i + 4));
+		}
+		double lanes[OrderedLanes];
+		_mm256_storeu_pd(lanes, a0);
+		_mm256_storeu_pd(lanes + 4, a1);
+		_mm256_zeroupper(); // OrderedSumCombine is not VEX-encoded
+		return OrderedSumCombine(lanes, data + i, size - i);
+	}
+
+	__attribute__((target("avx2")))
+	double OrderedProductAVX2(const double* data, std::size_t size) {
+		__m256d a0 = _mm256_set1_pd(1.0), a1 = _mm256_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			a0 = _mm256_mul_pd(a0, _mm256_loadu_pd(data + i));
+			a1 = _mm256_mul_pd(a1, _mm256_loadu_pd(data + i + 4));
+		}
+		double lanes[OrderedLanes];
+		_mm256_storeu_pd(lanes, a0);
+		_mm256_storeu_pd(lanes + 4, a1);
+		_mm256_zeroupper(); // OrderedProductCombine is not VEX-encoded
+		return OrderedProductCombine(lanes, data + i, size - i);
+	}
+
+	// AVX2: the 8 scaled product lanes in 2 registers, exponents and signs as 64-bit integers
+	__attribute__((target("avx2")))
+	ScaledProduct ScaledProductAVX2(const double* data, std::size_t size) {
+		const __m256i Exponent = _mm256_set1_epi64x(ExponentBits), Mantissa = _mm256_set1_epi64x(MantissaBits);
+		const __m256i One = _mm256_set1_epi64x(OneBits), Zero = _mm256_setzero_si256();
+		ScaledProduct result;
+		std::size_t i = 0;
+		for (; i + ScaledBatch <= size; i += ScaledBatch) {
+			__m256d m0 = _mm256_set1_pd(1.0), m1 = _mm256_set1_pd(1.0);
+			__m256i e0 = Zero, e1 = Zero, s0 = Zero, s1 = Zero, special = Zero;
+			for (std::size_t j = 0; j < ScaledBatch; j += ScaledLanes) {
+				__m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + j));
+				__m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + j + 4));
+				__m256i f0 = _mm256_and_si256(b0, Exponent), f1 = _mm256_and_si256(b1, Exponent);
+				special = _mm256_or_si256(special, _mm256_or_si256(_mm256_cmpeq_epi64(f0, Zero), _mm256_cmpeq_epi64(f0, Exponent)));
+				special = _mm256_or_si256(special, _mm256_or_si256(_mm256_cmpeq_epi64(f1, Zero), _mm256_cmpeq_epi64(f1, Exponent)));
+				s0 = _mm256_xor_si256(s0, b0);
+				s1 = _mm256_xor_si256(s1, b1);
+				e0 = _mm256_add_epi64(e0, _mm256_srli_epi64(f0, 52));
+				e1 = _mm256_add_epi64(e1, _mm256_srli_epi64(f1, 52));
+				m0 = _mm256_mul_pd(m0, _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(b0, Mantissa), One)));
+				m1 = _mm256_mul_pd(m1, _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(b1, Mantissa), One)));
+			}
+			double mantissas[ScaledLanes];
+			std::int64_t exponents[ScaledLanes];
+			std::uint64_t signs[ScaledLanes];
+			_mm256_storeu_pd(mantissas, m0);
+			_mm256_storeu_pd(mantissas + 4, m1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(exponents), e0);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(exponents + 4), e1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(signs), s0);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(signs + 4), s1);
+			const bool redo = !_mm256_testz_si256(special, special);
+			_mm256_zeroupper(); // MergeScaledBatch is not VEX-encoded
+			MergeScaledBatch(result, mantissas, exponents, signs, redo, data + i);
+		}
+		_mm256_zeroupper();
+		for (; i < size; ++i) {
+			result.Multiply(data[i]);
+		}
+		return result;
+	}
+
+	// AVX2: running min/max and their indices in 4 lanes
+	__attribute__((target("avx2")))
+	MinMaxIndex MinMaxAVX2(const double* data, std::size_t size) {
+		__m256d mn = _mm256_set1_pd(std::numeric_limits<double>::infinity()), mx = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+		__m256d MinIndex = _mm256_set1_pd(-1.0), MaxIndex = _mm256_set1_pd(-1.0);
+		__m256d index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+		const __m256d step = _mm256_set1_pd(4.0);
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			__m256d x = _mm256_loadu_pd(data + i);
+			__m256d lt = _mm256_cmp_pd(x, mn, _CMP_LT_OQ), gt = _mm256_cmp_pd(x, mx, _CMP_GT_OQ);
+			mn = _mm256_blendv_pd(mn, x, lt);
+			MinIndex = _mm256_blendv_pd(MinIndex, index, lt);
+			mx = _mm256_blendv_pd(mx, x, gt);
+			MaxIndex = _mm256_blendv_pd(MaxIndex, index, gt);
+			index = _mm256_add_pd(index, step);
+		}
+		double mins[4], MinIndices[4], maxs[4], MaxIndices[4];
+		_mm256_storeu_pd(mins, mn);
+		_mm256_storeu_pd(MinIndices, MinIndex);
+		_mm256_storeu_pd(maxs, mx);
+		_mm256_storeu_pd(MaxIndices, MaxIndex);
+		_mm256_zeroupper(); // CombineMinMax is not VEX-encoded
+		return CombineMinMax(mins, MinIndices, maxs, MaxIndices, 4, data, size, i);
+	}
+
+	__attribute__((target("avx2,fma")))
+	double SquaredDeviationAVX2(const double* data, std::size_t size, double center) {
+		const __m256d c = _mm256_set1_pd(center);
+		__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			__m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(data + i), c), d1 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 4), c);
+			a0 = _mm256_fmadd_pd(d0, d0, a0);
+			a1 = _mm256_fmadd_pd(d1, d1, a1);
+		}
+		double lanes[4];
+		_mm256_storeu_pd(lanes, _mm256_add_pd(a0, a1));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + SquaredDeviationScalar(data + i, size - i, center);
+	}
+
+	__attribute__((target("avx2")))
+	double InclusiveScanAVX2(const double* data, std::size_t size, double* out, double carry) {
+		const __m256d zero = _mm256_setzero_pd();
+		__m256d c = _mm256_set1_pd(carry);
+		std::size_t i = 0;
+		// Same scheme as the SSE2 kernel with 4 lanes
+		for (; i + 8 <= size; i += 8) {
+			__m256d x0 = _mm256_loadu_pd(data + i), x1 = _mm256_loadu_pd(data + i + 4);
+			x0 = _mm256_add_pd(x0, _mm256_blend_pd(_mm256_permute4x64_pd(x0, 0x90), zero, 0x1)); // + (0, x0, x1, x2)
+			x1 = _mm256_add_pd(x1, _mm256_blend_pd(_mm256_permute4x64_pd(x1, 0x90), zero, 0x1));
+			x0 = _mm256_add_pd(x0, _mm256_blend_pd(_mm256_permute4x64_pd(x0, 0x40), zero, 0x3)); // + (0, 0, x0, x0 + x1)
+			x1 = _mm256_add_pd(x1, _mm256_blend_pd(_mm256_permute4x64_pd(x1, 0x40), zero, 0x3));
+			x1 = _mm256_add_pd(x1, _mm256_permute4x64_pd(x0, 0xff));
+			x0 = _mm256_add_pd(x0, c);
+			x1 = _mm256_add_pd(x1, c);
+			_mm256_storeu_pd(out + i, x0);
+			_mm256_storeu_pd(out + i + 4, x1);
+			c = _mm256_permute4x64_pd(x1, 0xff);
+		}
+		const double last = _mm256_cvtsd_f64(c);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return InclusiveScanScalar(data + i, size - i, out + i, last);
+	}
+
+	__attribute__((target("avx2")))
+	void AdjacentDifferenceInPlaceAVX2(double* data, std::size_t size, double previous) {
+		std::size_t i = size;
+		for (; i >= 5; i -= 4) {
+			_mm256_storeu_pd(data + i - 4, _mm256_sub_pd(_mm256_loadu_pd(data + i - 4), _mm256_loadu_pd(data + i - 5)));
+		}
+		_mm256_zeroupper(); // the scalar head below is not VEX-encoded
+		AdjacentDifferenceInPlaceScalar(data, i, previous);
+	}
+
+	// TwoSum on every lane
+	__attribute__((target("avx2")))
+	inline void TwoSumAVX2(__m256d& s, __m256d& e) {
+		const __m256d t = _mm256_add_pd(s, e);
+		const __m256d b = _mm256_sub_pd(t, s);
+		e = _mm256_add_pd(_mm256_sub_pd(s, _mm256_sub_pd(t, b)), _mm256_sub_pd(e, b));
+		s = t;
+	}
+
+	// AVX2: 2 expansions x 4 lanes, as SuperaccumulateSSE2
+	__attribute__((target("avx2")))
+	void SuperaccumulateAVX2(const double* data, std::size_t size, Superaccumulator& acc) {
+		const __m256d SignMask = _mm256_set1_pd(-0.0), Limit = _mm256_set1_pd(ExpansionLimit), Zero = _mm256_setzero_pd();
+		__m256d a0 = Zero, a1 = Zero, a2 = Zero, b0 = Zero, b1 = Zero, b2 = Zero;
+		std::size_t i = 0;
+		FlushThrottle throttle;
+		for (; i + 8 <= size; i += 8) {
+			if (throttle.direct > 0) {
+				for (std::size_t k = i; k < i + 8; ++k) {
+					acc.Add(data[k]);
+				}
+				throttle.Count(false);
+				continue;
+			}
+			__m256d x = _mm256_loadu_pd(data + i), y = _mm256_loadu_pd(data + i + 4);
+			const __m256d InRange = _mm256_and_pd(_mm256_cmp_pd(_mm256_andnot_pd(SignMask, x), Limit, _CMP_LT_OQ),
+				_mm256_cmp_pd(_mm256_andnot_pd(SignMask, y), Limit, _CMP_LT_OQ));
+			if (_mm256_movemask_pd(InRange) != 0xf) {
+				for (std::size_t k = i; k < i + 8; ++k) {
+					acc.Add(data[k]);
+				}
+				continue;
+			}
+			TwoSumAVX2(a0, x);
+			TwoSumAVX2(b0, y);
+			TwoSumAVX2(a1, x);
+			TwoSumAVX2(b1, y);
+			TwoSumAVX2(a2, x);
+			TwoSumAVX2(b2, y);
+			const bool flushed = _mm256_movemask_pd(_mm256_or_pd(_mm256_cmp_pd(x, Zero, _CMP_NEQ_OQ), _mm256_cmp_pd(y, Zero, _CMP_NEQ_OQ))) != 0;
+			throttle.Count(flushed);
+			if (flushed) {
+				double rest[8];
+				_mm256_storeu_pd(rest, x);
+				_mm256_storeu_pd(rest + 4, y);
+				FlushExpansions(rest, 8, nullptr, 0, acc);
+			}
+		}
+		double terms[24];
+		_mm256_storeu_pd(terms, a0);
+		_mm256_storeu_pd(terms + 4, a1);
+		_mm256_storeu_pd(terms + 8, a2);
+		_mm256_storeu_pd(terms + 12, b0);
+		_mm256_storeu_pd(terms + 16, b1);
+		_mm256_storeu_pd(terms + 20, b2);
+		_mm256_zeroupper(); // the scalar code below is not VEX-encoded
+		FlushExpansions(terms, 24, data + i, size - i, acc);
+	}
+
+	// AVX-512: 4 accumulators x 8 lanes
+	__attribute__((target("avx512f")))
+	double SumAVX512(const double* data, std::size_t size) {
+		__m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd(), a2 = _mm512_setzero_pd(), a3 = _mm512_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32) {
+			a0 = _mm512_add_pd(a0, _mm512_loadu_pd(data + i));
+			a1 = _mm512_add_pd(a1, _mm512_loadu_pd(data + i + 8));
+			a2 = _mm512_add_pd(a2, _mm512_loadu_pd(data + i + 16));
+			a3 = _mm512_add_pd(a3, _mm512_loadu_pd(data + i + 24));
+		}
+		__m512d a = _mm512_add_pd(_mm512_add_pd(a0, a1), _mm512_add_pd(a2, a3));
+		double lanes[8];
+		_mm512_storeu_pd(lanes, a);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])) + SumScalar(data + i, size - i);
+	}
+
+	__attribute__((target("avx512f")))
+	double ProductAVX512(const double* data, std::size_t size) {
+		__m512d a0 = _mm512_set1_pd(1.0), a1 = _mm512_set1_pd(1.0), a2 = _mm512_set1_pd(1.0), a3 = _mm512_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32) {
+			a0 = _mm512_mul_pd(a0, _mm512_loadu_pd(data + i));
+			a1 = _mm512_mul_pd(a1, _mm512_loadu_pd(data + i + 8));
+			a2 = _mm512_mul_pd(a2, _mm512_loadu_pd(data + i + 16));
+			a3 = _mm512_mul_pd(a3, _mm512_loadu_pd(data + i + 24));
+		}
+		__m512d a = _mm512_mul_pd(_mm512_mul_pd(a0, a1), _mm512_mul_pd(a2, a3));
+		double lanes[8];
+		_mm512_storeu_pd(lanes, a);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return ((lanes[0] * lanes[1]) * (lanes[2] * lanes[3])) * ((lanes[4] * lanes[5]) * (lanes[6] * lanes[7])) * ProductScalar(data + i, size - i);
+	}
+
+	__attribute__((target("avx512f")))
+	void AdjacentDifferenceAVX512(const double* data, std::size_t size, double* out) {
+		std::size_t i = 1;
+		for (; i + 8 <= size; i += 8) {
+			_mm512_storeu_pd(out + i, _mm512_sub_pd(_mm512_loadu_pd(data + i), _mm512_loadu_pd(data + i - 1)));
+		}
+		for (; i < size; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+	}
+
+	__attribute__((target("avx512f")))
+	void AdjacentDifferenceStreamAVX512(const double* data, std::size_t size, double* out) {
+		std::size_t i = 1;
+		for (; i < size && reinterpret_cast<std::uintptr_t>(out + i) % 64 != 0; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+		for (; i + 8 <= size; i += 8) {
+			_mm512_stream_pd(out + i, _mm512_sub_pd(_mm512_loadu_pd(data + i), _mm512_loadu_pd(data + i - 1)));
+		}
+		for (; i < size; ++i) {
+			out[i] = data[i] - data[i - 1];
+		}
+		_mm_sfence();
+	}
+	__attribute__((target("avx512f")))
+	inline void NeumaierAVX512(__m512d& s, __m512d& c, __m512d x) {
+		__m512d t = _mm512_add_pd(s, x);
+		__mmask8 SLarger = _mm512_cmp_pd_mask(_mm512_abs_pd(s), _mm512_abs_pd(x), _CMP_GE_OQ);
+		__m512d IfSLarger = _mm512_add_pd(_mm512_sub_pd(s, t), x);
+		__m512d IfXLarger = _mm512_add_pd(_mm512_sub_pd(x, t), s);
+		c = _mm512_add_pd(c, _mm512_mask_blend_pd(SLarger, IfXLarger, IfSLarger));
+		s = t;
+	}
+
+	// AVX-512: 2 (sum, compensation) accumulators x 8 lanes
+	__attribute__((target("avx512f")))
+	CompensatedSum CompensatedSumAVX512(const double* data, std::size_t size) {
+		__m512d s0 = _mm512_setzero_pd(), c0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), c1 = _mm512_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			NeumaierAVX512(s0, c0, _mm512_loadu_pd(data + i));
+			NeumaierAVX512(s1, c1, _mm512_loadu_pd(data + i + 8));
+		}
+		double sums[16], compensations[16];
+		_mm512_storeu_pd(sums, s0);
+		_mm512_storeu_pd(sums + 8, s1);
+		_mm512_storeu_pd(compensations, c0);
+		_mm512_storeu_pd(compensations + 8, c1);
+		_mm256_zeroupper(); // MergeLanes is not VEX-encoded
+		return MergeLanes(sums, compensations, 16, data + i, size - i);
+	}
+	// AVX-512: the 8 ordered lanes in 1 register
+	__attribute__((target("avx512f")))
+	double OrderedSumAVX512(const double* data, std::size_t size) {
+		__m512d a = _mm512_setzero_pd();
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			a = _mm512_add_pd(a, _mm512_loadu_pd(data + i));
+		}
+		double lanes[OrderedLanes];
+		_mm512_storeu_pd(lanes, a);
+		_mm256_zeroupper(); // OrderedSumCombine is not VEX-encoded
+		return OrderedSumCombine(lanes, data + i, size - i);
+	}
+
+	__attribute__((target("avx512f")))
+	double OrderedProductAVX512(const double* data, std::size_t size) {
+		__m512d a = _mm512_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + OrderedLanes <= size; i += OrderedLanes) {
+			a = _mm512_mul_pd(a, _mm512_loadu_pd(data + i));
+		}
+		double lanes[OrderedLanes];
+		_mm512_storeu_pd(lanes, a);
+		_mm256_zeroupper(); // OrderedProductCombine is not VEX-encoded
+		return OrderedProductCombine(lanes, data + i, size - i);
+	}
+	// AVX-512: the 8 scaled product lanes in 1 register
+	__attribute__((target("avx512f")))
+	ScaledProduct ScaledProductAVX512(const double* data, std::size_t size) {
+		const __m512i Exponent = _mm512_set1_epi64(ExponentBits), Mantissa = _mm512_set1_epi64(MantissaBits);
+		const __m512i One = _mm512_set1_epi64(OneBits), Zero = _mm512_setzero_si512();
+		ScaledProduct result;
+		std::size_t i = 0;
+		for (; i + ScaledBatch <= size; i += ScaledBatch) {
+			__m512d m = _mm512_set1_pd(1.0);
+			__m512i e = Zero, s = Zero;
+			__mmask8 special = 0;
+			for (std::size_t j = 0; j < ScaledBatch; j += ScaledLanes) {
+				__m512i b = _mm512_loadu_si512(data + i + j);
+				__m512i f = _mm512_and_si512(b, Exponent);
+				special |= _mm512_cmpeq_epi64_mask(f, Zero) | _mm512_cmpeq_epi64_mask(f, Exponent);
+				s = _mm512_xor_si512(s, b);
+				e = _mm512_add_epi64(e, _mm512_maskz_srli_epi64(0xff, f, 52)); // maskz: GCC 12 warns on the unmasked form
+				m = _mm512_mul_pd(m, _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(b, Mantissa), One)));
+			}
+			double mantissas[ScaledLanes];
+			std::int64_t exponents[ScaledLanes];
+			std::uint64_t signs[ScaledLanes];
+			_mm512_storeu_pd(mantissas, m);
+			_mm512_storeu_si512(exponents, e);
+			_mm512_storeu_si512(signs, s);
+			_mm256_zeroupper(); // MergeScaledBatch is not VEX-encoded
+			MergeScaledBatch(result, mantissas, exponents, signs, special != 0, data + i);
+		}
+		_mm256_zeroupper();
+		for (; i < size; ++i) {
+			result.Multiply(data[i]);
+		}
+		return result;
+	}
+	// AVX-512: running min/max and their indices in 8 lanes
+	__attribute__((target("avx512f")))
+	MinMaxIndex MinMaxAVX512(const double* data, std::size_t size) {
+		__m512d mn = _mm512_set1_pd(std::numeric_limits<double>::infinity()), mx = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+		__m512d MinIndex = _mm512_set1_pd(-1.0), MaxIndex = _mm512_set1_pd(-1.0);
+		__m512d index = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+		const __m512d step = _mm512_set1_pd(8.0);
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			__m512d x = _mm512_loadu_pd(data + i);
+			__mmask8 lt = _mm512_cmp_pd_mask(x, mn, _CMP_LT_OQ), gt = _mm512_cmp_pd_mask(x, mx, _CMP_GT_OQ);
+			mn = _mm512_mask_mov_pd(mn, lt, x);
+			MinIndex = _mm512_mask_mov_pd(MinIndex, lt, index);
+			mx = _mm512_mask_mov_pd(mx, gt, x);
+			MaxIndex = _mm512_mask_mov_pd(MaxIndex, gt, index);
+			index = _mm512_add_pd(index, step);
+		}
+		double mins[8], MinIndices[8], maxs[8], MaxIndices[8];
+		_mm512_storeu_pd(mins, mn);
+		_mm512_storeu_pd(MinIndices, MinIndex);
+		_mm512_storeu_pd(maxs, mx);
+		_mm512_storeu_pd(MaxIndices, MaxIndex);
+		_mm256_zeroupper(); // CombineMinMax is not VEX-encoded
+		return CombineMinMax(mins, MinIndices, maxs, MaxIndices, 8, data, size, i);
+	}
+
+	__attribute__((target("avx512f")))
+	double SquaredDeviationAVX512(const double* data, std::size_t size, double center) {
+		const __m512d c = _mm512_set1_pd(center);
+		__m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			__m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(data + i), c), d1 = _mm512_sub_pd(_mm512_loadu_pd(data + i + 8), c);
+			a0 = _mm512_fmadd_pd(d0, d0, a0);
+			a1 = _mm512_fmadd_pd(d1, d1, a1);
+		}
+		double lanes[8];
+		_mm512_storeu_pd(lanes, _mm512_add_pd(a0, a1));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])) + SquaredDeviationScalar(data + i, size - i, center);
+	}
+
+	__attribute__((target("avx512f")))
+	double InclusiveScanAVX512(const double* data, std::size_t size, double* out, double carry) {
+		// Lane k takes lane k - 1, k - 2, k - 4; the masks zero the lanes with nothing to take
+		const __m512i shift1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+		const __m512i shift2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+		const __m512i shift4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+		const __m512i last_lane = _mm512_set1_epi64(7);
+		__m512d c = _mm512_set1_pd(carry);
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			__m512d x0 = _mm512_loadu_pd(data + i), x1 = _mm512_loadu_pd(data + i + 8);
+			x0 = _mm512_add_pd(x0, _mm512_maskz_permutexvar_pd(0xfe, shift1, x0));
+			x1 = _mm512_add_pd(x1, _mm512_maskz_permutexvar_pd(0xfe, shift1, x1));
+			x0 = _mm512_add_pd(x0, _mm512_maskz_permutexvar_pd(0xfc, shift2, x0));
+			x1 = _mm512_add_pd(x1, _mm512_maskz_permutexvar_pd(0xfc, shift2, x1));
+			x0 = _mm512_add_pd(x0, _mm512_maskz_permutexvar_pd(0xf0, shift4, x0));
+			x1 = _mm512_add_pd(x1, _mm512_maskz_permutexvar_pd(0xf0, shift4, x1));
+			x1 = _mm512_add_pd(x1, _mm512_maskz_permutexvar_pd(0xff, last_lane, x0));
+			x0 = _mm512_add_pd(x0, c);
+			x1 = _mm512_add_pd(x1, c);
+			_mm512_storeu_pd(out + i, x0);
+			_mm512_storeu_pd(out + i + 8, x1);
+			c = _mm512_maskz_permutexvar_pd(0xff, last_lane, x1);
+		}
+		const double last = _mm512_cvtsd_f64(c);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return InclusiveScanScalar(data + i, size - i, out + i, last);
+	}
+
+	__attribute__((target("avx512f")))
+	void AdjacentDifferenceInPlaceAVX512(double* data, std::size_t size, double previous) {
+		std::size_t i = size;
+		for (; i >= 9; i -= 8) {
+			_mm512_storeu_pd(data + i - 8, _mm512_sub_pd(_mm512_loadu_pd(data + i - 8), _mm512_loadu_pd(data + i - 9)));
+		}
+		_mm256_zeroupper(); // the scalar head below is not VEX-encoded
+		AdjacentDifferenceInPlaceScalar(data, i, previous);
+	}
+
+	// TwoSum on every lane
+	__attribute__((target("avx512f")))
+	inline void TwoSumAVX512(__m512d& s, __m512d& e) {
+		const __m512d t = _mm512_add_pd(s, e);
+		const __m512d b = _mm512_sub_pd(t, s);
+		e = _mm512_add_pd(_mm512_sub_pd(s, _mm512_sub_pd(t, b)), _mm512_sub_pd(e, b));
+		s = t;
+	}
+
+	// AVX-512: 2 expansions x 8 lanes, as SuperaccumulateSSE2
+	__attribute__((target("avx512f")))
+	void SuperaccumulateAVX512(const double* data, std::size_t size, Superaccumulator& acc) {
+		const __m512d Limit = _mm512_set1_pd(ExpansionLimit), Zero = _mm512_setzero_pd();
+		__m512d a0 = Zero, a1 = Zero, a2 = Zero, b0 = Zero, b1 = Zero, b2 = Zero;
+		std::size_t i = 0;
+		FlushThrottle throttle;
+		for (; i + 16 <= size; i += 16) {
+			if (throttle.direct > 0) {
+				for (std::size_t k = i; k < i + 16; ++k) {
+					acc.Add(data[k]);
+				}
+				throttle.Count(false);
+				continue;
+			}
+			__m512d x = _mm512_loadu_pd(data + i), y = _mm512_loadu_pd(data + i + 8);
+			const __mmask8 InRange = _mm512_cmp_pd_mask(_mm512_abs_pd(x), Limit, _CMP_LT_OQ) & _mm512_cmp_pd_mask(_mm512_abs_pd(y), Limit, _CMP_LT_OQ);
+			if (InRange != 0xff) {
+				for (std::size_t k = i; k < i + 16; ++k) {
+					acc.Add(data[k]);
+				}
+				continue;
+			}
+			TwoSumAVX512(a0, x);
+			TwoSumAVX512(b0, y);
+			TwoSumAVX512(a1, x);
+			TwoSumAVX512(b1, y);
+			TwoSumAVX512(a2, x);
+			TwoSumAVX512(b2, y);
+			const bool flushed = (_mm512_cmp_pd_mask(x, Zero, _CMP_NEQ_OQ) | _mm512_cmp_pd_mask(y, Zero, _CMP_NEQ_OQ)) != 0;
+			throttle.Count(flushed);
+			if (flushed) {
+				double rest[16];
+				_mm512_storeu_pd(rest, x);
+				_mm512_storeu_pd(rest + 8, y);
+				FlushExpansions(rest, 16, nullptr, 0, acc);
+			}
+		}
+		double terms[48];
+		_mm512_storeu_pd(terms, a0);
+		_mm512_storeu_pd(terms + 8, a1);
+		_mm512_storeu_pd(terms + 16, a2);
+		_mm512_storeu_pd(terms + 24, b0);
+		_mm512_storeu_pd(terms + 32, b1);
+		_mm512_storeu_pd(terms + 40, b2);
+		_mm256_zeroupper(); // the scalar code below is not VEX-encoded
+		FlushExpansions(terms, 48, data + i, size - i, acc);
+	}
+#endif
+
+	const SimdKernels Kernels[] = {
+		{SimdLevel::Scalar, "scalar", SumScalar, ProductScalar, AdjacentDifferenceScalar, CompensatedSumScalar, OrderedSumScalar, OrderedProductScalar, ScaledProductScalar, MinMaxScalar, SquaredDeviationScalar, InclusiveScanScalar, AdjacentDifferenceInPlaceScalar, SuperaccumulateScalar, AdjacentDifferenceScalar},
+#ifdef VECTOROPERATIONS_X86
+		{SimdLevel::SSE2, "sse2", SumSSE2, ProductSSE2, AdjacentDifferenceSSE2, CompensatedSumSSE2, OrderedSumSSE2, OrderedProductSSE2, ScaledProductScalar, MinMaxSSE2, SquaredDeviationSSE2, InclusiveScanSSE2, AdjacentDifferenceInPlaceSSE2, SuperaccumulateSSE2, AdjacentDifferenceStreamSSE2},
+		{SimdLevel::AVX2, "avx2", SumAVX2, ProductAVX2, AdjacentDifferenceAVX2, CompensatedSumAVX2, OrderedSumAVX2, OrderedProductAVX2, ScaledProductAVX2, MinMaxAVX2, SquaredDeviationAVX2, InclusiveScanAVX2, AdjacentDifferenceInPlaceAVX2, SuperaccumulateAVX2, AdjacentDifferenceStreamAVX2},
+		{SimdLevel::AVX512, "avx512", SumAVX512, ProductAVX512, AdjacentDifferenceAVX512, CompensatedSumAVX512, OrderedSumAVX512, OrderedProductAVX512, ScaledProductAVX512, MinMaxAVX512, SquaredDeviationAVX512, InclusiveScanAVX512, AdjacentDifferenceInPlaceAVX512, SuperaccumulateAVX512, AdjacentDifferenceStreamAVX512},
+#endif
+	};
+}
+
+SimdLevel DetectSimdLevel() {
+	SimdLevel level = SimdLevel::Scalar;
+#ifdef VECTOROPERATIONS_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) level = SimdLevel::SSE2;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) level = SimdLevel::AVX2;
+	if (__builtin_cpu_supports("avx512f")) level = SimdLevel::AVX512;
+#endif
+	if (const char* cap = std::getenv("VECTOROPERATIONS_SIMD")) {
+		for (const auto& kernels : Kernels) {
+			if (std::strcmp(cap, kernels.name) == 0 && kernels.level < level) {
+				level = kernels.level;
+			}
+		}
+	}
+	return level;
+}
+
+const SimdKernels& GetSimdKernels(SimdLevel level) {
+	const SimdLevel supported = DetectSimdLevel();
+	const SimdKernels* best = &Kernels[0];
+	for (const auto& kernels : Kernels) {
+		if (kernels.level <= level && kernels.level <= supported) {
+			best = &kernels;
+		}
+	}
+	return *best;
+}
+
+const SimdKernels& BestSimdKernels() {
+	static const SimdKernels& best = GetSimdKernels(DetectSimdLevel());
+	return best;
+}
@@ -0,0 +1,90 @@
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <cstddef>
+#include <cmath>
+#include "ScaledProduct.h"
+#include "Superaccumulator.h"
+
+// Hand-vectorized kernels on raw double buffers, one set per instruction set.
+// The reductions keep several independent accumulators so consecutive additions
+// (multiplications) do not wait on each other; they therefore add the elements in a
+// different order than sum1/product1 and can differ from them in the last bits:
+//   |sum - sum1|         <= 2 (n - 1) eps sum(|x_i|)
+//   |product - product1| <= 2 (n - 1) eps |product1|   (to first order, no overflow)
+// with eps = 2^-53. The adjacent difference (in place or not) is exact, so it matches the scalar methods bit for bit.
+
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+// Smallest and largest element with the index of their first occurrence. NaNs are ignored;
+// with no other element (empty or all-NaN data) min = +inf, max = -inf and both indices are the size.
+struct MinMaxIndex {
+    double min;
+    double max;
+    std::size_t min_index;
+    std::size_t max_index;
+};
+
+// Running (sum, compensation) pair of Neumaier's variant of Kahan summation.
+// Unlike Kahan's, it stays exact when an addend is larger than the running sum,
+// and two partial results (lanes, blocks, threads) combine with Merge without losing the compensation.
+// The error of Result() is at most 2 eps |S| + O(n eps^2) sum(|x_i|), independently of the merge order.
+struct CompensatedSum {
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void Add(double x) {
+        double t = sum + x;
+        compensation += std::fabs(sum) >= std::fabs(x) ? (sum - t) + x : (x - t) + sum;
+        sum = t;
+    }
+    void Merge(const CompensatedSum& other) {
+        Add(other.sum);
+        compensation += other.compensation;
+    }
+    double Result() const { return sum + compensation; }
+};
+
+struct SimdKernels {
+    SimdLevel level;
+    const char* name;
+    double (*sum)(const double* data, std::size_t size);
+    double (*product)(const double* data, std::size_t size);
+    // Writes out[i] = data[i] - data[i - 1] for i in [1, size); out[0] is left to the caller
+    void (*adjacent_difference)(const double* data, std::size_t size, double* out);
+    // Neumaier summation with one (sum, compensation) pair per vector lane, merged at the end
+    CompensatedSum (*compensated_sum)(const double* data, std::size_t size);
+    // Sum (product) in a fixed order: element i goes to lane i % 8, lanes combine as
+    // ((l0 + l1) + (l2 + l3)) + ((l4 + l5) + (l6 + l7)). Every level gives the same bits.
+    double (*ordered_sum)(const double* data, std::size_t size);
+    double (*ordered_product)(const double* data, std::size_t size);
+    // Overflow-safe product, see ScaledProductOf in ScaledProduct.h (SSE2 uses the scalar kernel)
+    ScaledProduct (*scaled_product)(const double* data, std::size_t size);
+    MinMaxIndex (*min_max)(const double* data, std::size_t size);
+    // Sum of (data[i] - center)^2, the second pass of a two-pass variance on cache-resident data
+    double (*squared_deviation)(const double* data, std::size_t size, double center);
+    // Writes out[i] = carry + data[0] + ... + data[i] for i in [0, size) and returns the last one (carry if size is 0);
+    // out may be data. The vector levels scan within a vector before adding the carry, so every prefix can differ
+    // from a sequential scan in the last bits, within the bound of sum above.
+    double (*inclusive_scan)(const double* data, std::size_t size, double* out, double carry);
+    // data[i] -= data[i - 1] for i in [1, size), then data[0] -= previous, going from the end down so no copy is needed
+    void (*adjacent_difference_inplace)(double* data, std::size_t size, double previous);
+    // Adds data[0, size) to acc exactly, see SuperaccumulatorOf in Superaccumulator.h
+    void (*superaccumulate)(const double* data, std::size_t size, Superaccumulator& acc);
+    // adjacent_difference with non-temporal stores, for outputs larger than the last-level cache (see OutputBuffers.h);
+    // the scalar level uses plain stores
+    void (*adjacent_difference_stream)(const double* data, std::size_t size, double* out);
+};
+
+// Number of lanes of ordered_sum/ordered_product
+constexpr std::size_t OrderedLanes = 8;
+
+// Best level the CPU (and OS) supports, from CPUID, capped by $VECTOROPERATIONS_SIMD
+// (scalar, sse2, avx2 or avx512) when it is set
+SimdLevel DetectSimdLevel();
+// Kernels of the given level, or of the best supported level below it
+const SimdKernels& GetSimdKernels(SimdLevel level);
+// Kernels of DetectSimdLevel(), detected once per process
+const SimdKernels& BestSimdKernels();
+
+#endif
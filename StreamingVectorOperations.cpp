@@ -0,0 +1,104 @@
+#include "StreamingVectorOperations.h"
+#include "SimdKernels.h"
+#include <unistd.h>
+#include <algorithm>
+
+namespace
+{
+	// Elements per page of float64 data; thread ranges start on page boundaries so no page is shared
+	std::size_t ElementsPerPage() {
+		return static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) / sizeof(double);
+	}
+
+	std::size_t PageChunkBegin(std::size_t i, std::size_t size, std::size_t parts) {
+		const std::size_t granule = ElementsPerPage();
+		return std::min(size, ChunkBegin(i, (size + granule - 1) / granule, parts) * granule);
+	}
+}
+
+StreamingVectorOperations::StreamingVectorOperations(const MappedVectorFile& file, ThreadPool& pool)
+	: VectorOperationsBase(file.data<double>()), file(file), pool(pool) {
+	const std::size_t PhysicalBytes = static_cast<std::size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	ReleaseWindows = vec.size_bytes() > PhysicalBytes / 2;
+}
+
+void StreamingVectorOperations::ForEachWindow(const std::function<void(unsigned int, std::size_t, std::size_t)>& window) const {
+	const unsigned int NumOfThreads = pool.size();
+	const std::size_t WindowSize = std::max<std::size_t>(WindowBytes / sizeof(double), 1);
+	file.AdviseSequential();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = PageChunkBegin(i, vec.size(), NumOfThreads);
+		const std::size_t end = PageChunkBegin(i + 1, vec.size(), NumOfThreads);
+		file.WillNeed(start, std::min(end, start + WindowSize));
+		for (std::size_t begin = start; begin < end; begin += WindowSize) {
+			const std::size_t finish = std::min(end, begin + WindowSize);
+			file.WillNeed(finish, std::min(end, finish + WindowSize));
+			window(i, begin, finish);
+			if (ReleaseWindows) {
+				file.Release(begin, finish);
+			}
+		}
+		});
+}
+
+// Method (35) Streaming summation of a mapped file
+double StreamingVectorOperations::sum(bool Time) const {
+	Timer timeit(Time);
+	std::vector<CacheLinePadded<double>> Partial_Sums(pool.size());
+	const SimdKernels& kernels = BestSimdKernels();
+	ForEachWindow([&](unsigned int i, std::size_t begin, std::size_t end) {
+		Partial_Sums[i].value += kernels.sum(vec.data() + begin, end - begin);
+		});
+	double total_sum = 0.0;
+	for (const auto& partial : Partial_Sums) {
+		total_sum += partial.value;
+	}
+	return total_sum;
+}
+
+// Method (36) Streaming product of a mapped file
+double StreamingVectorOperations::product(bool Time) const {
+	Timer timeit(Time);
+	std::vector<CacheLinePadded<double>> Partial_Products(pool.size());
+	for (auto& partial : Partial_Products) {
+		partial.value = 1.0;
+	}
+	const SimdKernels& kernels = BestSimdKernels();
+	ForEachWindow([&](unsigned int i, std::size_t begin, std::size_t end) {
+		Partial_Products[i].value *= kernels.product(vec.data() + begin, end - begin);
+		});
+	double product = 1.0;
+	for (const auto& partial : Partial_Products) {
+		product *= partial.value;
+	}
+	return product;
+}
+
+// Method (37) Streaming adjacent difference from a mapped file into a mapped output file
+// Thread ranges are whole pages of elements counted from the first element (PageChunkBegin). The output data is
+// aligned to at least a page, so those ranges are page-aligned in the output and no two threads write to (or
+// release) the same output page, whatever the alignment of the input
+bool StreamingVectorOperations::adjacent_difference(const std::string& OutputPath, bool Time) const {
+	Timer timeit(Time);
+	if (!file.IsValid() || file.dtype() != VectorDType::Float64) {
+		return false;
+	}
+	VectorFileOptions options;
+	options.Alignment = std::max<std::size_t>(file.header().alignment, static_cast<std::size_t>(sysconf(_SC_PAGESIZE)));
+	options.ChecksumBlock = file.header().checksum_block;
+	MappedVectorFile output(OutputPath, VectorDType::Float64, vec.size(), options);
+	const std::span<double> diff = output.MutableData<double>();
+	if (!output.IsValid()) {
+		return false;
+	}
+	const SimdKernels& kernels = BestSimdKernels();
+	ForEachWindow([&](unsigned int, std::size_t begin, std::size_t end) {
+		diff[begin] = begin == 0 ? vec[0] : vec[begin] - vec[begin - 1];
+		kernels.adjacent_difference(vec.data() + begin, end - begin, diff.data() + begin);
+		if (ReleaseWindows) {
+			output.Release(begin, end);
+		}
+		});
+	output.UpdateChecksums(pool);
+	return true;
+}
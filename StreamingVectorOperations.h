@@ -0,0 +1,40 @@
+#ifndef STREAMINGVECTOROPERATIONS_H
+#define STREAMINGVECTOROPERATIONS_H
+
+#include "VectorOperations.h"
+#include "VectorFile.h"
+#include <string>
+#include <functional>
+
+// Out-of-core operations on a float64 MappedVectorFile, for files that may not fit in RAM
+// (an invalid file or one of another element type is seen as empty).
+// Every pool thread takes a disjoint, page-aligned range of the file and walks it in windows:
+// it asks for the readahead of the next window (MADV_WILLNEED) while it reduces the current one
+// with the SIMD kernels, and, when the file is larger than half the physical memory, unmaps each
+// window once done (MADV_DONTNEED) so the process does not hold the whole file.
+// The object views the mapping, so the file must outlive it.
+// Syntax: { MappedVectorFile file("data.vec"); double s = StreamingVectorOperations(file).sum(false); }
+class StreamingVectorOperations : public VectorOperationsBase {
+private:
+    const MappedVectorFile& file;
+    ThreadPool& pool;
+    std::size_t WindowBytes = std::size_t(1) << 20;
+    bool ReleaseWindows;
+
+    // Runs window(i, begin, end) on thread i for every window [begin, end) of its range, with the hints described above
+    void ForEachWindow(const std::function<void(unsigned int, std::size_t, std::size_t)>& window) const;
+public:
+    StreamingVectorOperations(const MappedVectorFile& file, ThreadPool& pool = ThreadPool::Global());
+
+    void SetWindowSize(std::size_t bytes) { WindowBytes = std::max<std::size_t>(bytes, 4096); }
+    void SetReleaseWindows(bool release) { ReleaseWindows = release; }
+
+    // Method 35: sum, method 36: product, same results as methods 15 and 16 up to the summation order
+    double sum(bool Time = true) const;
+    double product(bool Time = true) const;
+    // Method 37: writes the adjacent difference (same layout as method 7) straight into a new float64 file at
+    // OutputPath, mapped read-write, with the checksum block size of the input. False if it cannot be created.
+    bool adjacent_difference(const std::string& OutputPath, bool Time = true) const;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "Superaccumulator.h"
+#include "SimdKernels.h"
+#include <cmath>
+#include <cstdint>
+#include <bit>
+#include <limits>
+#include <algorithm>
+
+namespace
+{
+	constexpr unsigned int NormalizeEvery = 1u << 30;
+	constexpr long long DigitMask = 0xffffffffLL;
+}
+
+void Superaccumulator::Add(double x) {
+	const std::uint64_t bits = std::bit_cast<std::uint64_t>(x);
+	int exponent = static_cast<int>((bits >> 52) & 0x7ff);
+	std::uint64_t mantissa = bits & ((std::uint64_t(1) << 52) - 1);
+	if (exponent == 0x7ff) {
+		nan |= mantissa != 0;
+		(bits >> 63 ? minus_infinity : plus_infinity) |= mantissa == 0;
+		return;
+	}
+	// |x| = mantissa * 2^(exponent - 1075), subnormals (and zeros) having exponent 1 without the implicit bit
+	const std::uint64_t normal = exponent != 0;
+	mantissa |= normal << 52;
+	exponent += static_cast<int>(normal ^ 1);
+	const int position = exponent - 1; // bit of the lowest mantissa bit, counted from 2^-1074
+	const int limb = position >> 5;
+	const unsigned __int128 shifted = static_cast<unsigned __int128>(mantissa) << (position & 31);
+	// Negated without a branch (the signs of summed data are rarely predictable): (d ^ -1) + 1 = -d
+	const long long sign = -static_cast<long long>(bits >> 63);
+	limbs[limb] += (static_cast<long long>(shifted & DigitMask) ^ sign) - sign;
+	limbs[limb + 1] += (static_cast<long long>((shifted >> 32) & DigitMask) ^ sign) - sign;
+	limbs[limb + 2] += (static_cast<long long>(shifted >> 64) ^ sign) - sign;
+	if (++pending == NormalizeEvery) {
+		Normalize();
+	}
+}
+
+// Brings every limb but the last into [0, 2^32), the last one keeping the sign of the sum
+void Superaccumulator::Normalize() {
+	for (int i = 0; i + 1 < NumOfLimbs; ++i) {
+		const long long carry = limbs[i] >> 32;
+		limbs[i] &= DigitMask;
+		limbs[i + 1] += carry;
+	}
+	pending = 0;
+}
+
+void Superaccumulator::Merge(const Superaccumulator& other) {
+	Normalize();
+	Superaccumulator normalized = other;
+	normalized.Normalize();
+	for (int i = 0; i < NumOfLimbs; ++i) {
+		limbs[i] += normalized.limbs[i];
+	}
+	Normalize();
+	nan |= other.nan;
+	plus_infinity |= other.plus_infinity;
+	minus_infinity |= other.minus_infinity;
+}
+
+double Superaccumulator::Result() const {
+	if (nan || (plus_infinity && minus_infinity)) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+	if (plus_infinity || minus_infinity) {
+		return plus_infinity ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+	}
+	Superaccumulator magnitude = *this;
+	magnitude.Normalize();
+	const bool negative = magnitude.limbs[NumOfLimbs - 1] < 0;
+	if (negative) {
+		for (long long& limb : magnitude.limbs) {
+			limb = -limb;
+		}
+		magnitude.Normalize();
+	}
+	int top = NumOfLimbs - 1;
+	while (top >= 0 && magnitude.limbs[top] == 0) {
+		--top;
+	}
+	if (top < 0) {
+		return 0.0;
+	}
+	// The 3 highest digits hold at least 65 significant bits, the lower ones only decide ties
+	const int base = std::max(top - 2, 0);
+	unsigned __int128 digits = 0;
+	for (int i = top; i >= base; --i) {
+		digits = (digits << 32) | static_cast<unsigned __int128>(magnitude.limbs[i]);
+	}
+	bool sticky = false;
+	for (int i = 0; i < base; ++i) {
+		sticky |= magnitude.limbs[i] != 0;
+	}
+	const std::uint64_t high = static_cast<std::uint64_t>(digits >> 64);
+	const int length = high != 0 ? 128 - std::countl_zero(high) : 64 - std::countl_zero(static_cast<std::uint64_t>(digits));
+	int shift = 0;
+	std::uint64_t mantissa;
+	if (length > 53) {
+		// Round to nearest even on the 53 leading bits
+		shift = length - 53;
+		mantissa = static_cast<std::uint64_t>(digits >> shift);
+		const unsigned __int128 rest = digits & ((static_cast<unsigned __int128>(1) << shift) - 1);
+		const unsigned __int128 half = static_cast<unsigned __int128>(1) << (shift - 1);
+		if (rest > half || (rest == half && (sticky || (mantissa & 1)))) {
+			++mantissa;
+		}
+	}
+	else {
+		// Only when the sum is below 2^-1021 (base 0), where every digit is representable
+		mantissa = static_cast<std::uint64_t>(digits);
+	}
+	// Exact: mantissa has at most 53 bits (2^53 after rounding up), and below 2^-1022 it is a multiple of 2^-1074
+	const double result = std::ldexp(static_cast<double>(mantissa), 32 * base + shift - 1074);
+	return negative ? -result : result;
+}
+
+Superaccumulator SuperaccumulatorOf(const double* data, std::size_t size) {
+	Superaccumulator acc;
+	BestSimdKernels().superaccumulate(data, size, acc);
+	return acc;
+}
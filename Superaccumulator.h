@@ -0,0 +1,39 @@
+#ifndef SUPERACCUMULATOR_H
+#define SUPERACCUMULATOR_H
+
+#include <cstddef>
+
+// Exact sum of doubles as one long fixed-point number (Neal's superaccumulator, as in ExBLAS): NumOfLimbs signed
+// 64-bit limbs of 32-bit digits, the lowest digit weighing 2^-1074 (the smallest subnormal), so any sum of up to
+// 2^63 finite doubles is held without rounding. A double touches at most 3 limbs; the 32 spare bits of every limb
+// absorb the carries, which are only propagated every 2^30 additions. Result() rounds the exact sum once, to
+// nearest even, so it does not depend on the order of the additions or merges.
+// Infinities and NaNs are tracked as flags and give the IEEE result (NaN for +inf + -inf or a NaN addend).
+struct Superaccumulator {
+    static constexpr int NumOfLimbs = 68;
+
+    long long limbs[NumOfLimbs] = {};
+    unsigned int pending = 0; // additions since the carries were last propagated
+    bool nan = false;
+    bool plus_infinity = false;
+    bool minus_infinity = false;
+
+    // Adds one double (the slow, exact path; SuperaccumulatorOf batches it)
+    void Add(double x);
+    // Adds another partial sum, so per-thread results combine in any order with the same Result()
+    void Merge(const Superaccumulator& other);
+    // The exact sum correctly rounded to a double: +-inf when it does not fit
+    double Result() const;
+
+private:
+    void Normalize();
+};
+
+// Exact sum of data[0, size), on the SIMD kernels of the host (the superaccumulate kernel of SimdKernels.h).
+// Every vector lane keeps the running sum as an expansion of 3 doubles updated with TwoSum, which is exact, so
+// most elements never reach the limbs: only what the 3 terms cannot hold, elements of magnitude 2^960 and
+// more (whose running sums could overflow), infinities, NaNs and the final terms are added to the limbs.
+// On data spread over so many binades that the expansions keep overflowing, stretches of it go to the limbs directly.
+Superaccumulator SuperaccumulatorOf(const double* data, std::size_t size);
+
+#endif
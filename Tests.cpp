@@ -1,11 +1,44 @@
 #include "Tests.h"
 #include "VectorOperations.h"
+#include "AutoVectorOperations.h"
+#include "SimdKernels.h"
+#include "TypedSimdKernels.h"
+#include "StreamingVectorOperations.h"
+#include "IncrementalAggregates.h"
+#include "VectorExpressions.h"
+#include "BatchedVectorOperations.h"
+#include "NumaVector.h"
+#include "AsyncVectorOperations.h"
+#include "RollingAggregates.h"
+#include "BenchmarkHarness.h"
+#include "PerfCounters.h"
+#include "OutputBuffers.h"
+#include "ShardedVectorOperations.h"
+#include "FixedVectorOperations.h"
 #include <cassert>
 #include <cmath>
 #include <vector>
 #include <random>
 #include<iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <cstring>
+#include <stdexcept>
+#include <array>
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <optional>
+#include <coroutine>
+#include <exception>
 
 // Create random real variable vector size N
 std::vector<double> generate_random_vector(std::size_t size,double a=0.0,double b=1.0) {
@@ -95,15 +128,23 @@ void PrintSimpleTimes(const SimpleVectorOperations& operations) {
     std::cout << "Result of the product: " << operations.product1() << "\n";
     std::cout << "(Method 5) The time it takes for the single thread product using (std::accumulate) method:";
     std::cout << "Result of the product: " << operations.product2() << "\n";
+    std::cout << "(Method 18) The time it takes for the single thread summation using SIMD kernels:";
+    std::cout << "Result of the summation:" << operations.sumSimd() << "\n";
+    std::cout << "(Method 19) The time it takes for the single thread product using SIMD kernels:";
+    std::cout << "Result of the product: " << operations.productSimd() << "\n";
+    std::cout << "(Method 26) The time it takes for the single thread overflow-safe product using mantissa/exponent scaling:";
+    std::cout << "Result of the product: " << operations.productScaled().ToDouble() << "\n";
 }
 
-void PrintSimpleTimesAdjDiff(const SimpleVectorOperations& operations, std::vector<double>& diff1, std::vector<double>& diff2, std::unique_ptr<double[]>& diff3) {
+void PrintSimpleTimesAdjDiff(const SimpleVectorOperations& operations, std::vector<double>& diff1, std::vector<double>& diff2, std::unique_ptr<double[]>& diff3, std::vector<double>& diff7) {
     std::cout << "(Method 6) The time it takes for adjacent difference in a vector:";
     operations.adjacent_difference1(diff1,true);
     std::cout << "(Method 7) The time it takes for adjacent difference in a vector using std::adjacent_difference:";
     operations.adjacent_difference2(diff2,true);
     std::cout << "(Method 8) The time it takes for adjacent difference using pointer to an array:";
     operations.adjacent_difference3(diff3,true);
+    std::cout << "(Method 20) The time it takes for adjacent difference using SIMD kernels:";
+    operations.adjacent_differenceSimd(diff7,true);
 }
 
 void PrintThreadedTimes(MultiThreadVectorOperations & MToperations) {
@@ -115,13 +156,25 @@ void PrintThreadedTimes(MultiThreadVectorOperations & MToperations) {
     std::cout << "Result of the summation: " << MToperations.ComputeSumMultiThreadSum3() << "\n";
     std::cout << "(Method 12) The time it takes for the multi thread product using using std::async and std::mutex:";
     std::cout << "Result of the product: " << MToperations.ComputeSumMultiThreadProduct() << "\n";
+    std::cout << "(Method 15) The time it takes for the multi thread summation using the persistent thread pool:";
+    std::cout << "Result of the summation: " << MToperations.ComputeSumThreadPool() << "\n";
+    std::cout << "(Method 16) The time it takes for the multi thread product using the persistent thread pool:";
+    std::cout << "Result of the product: " << MToperations.ComputeProductThreadPool() << "\n";
+    std::cout << "(Method 24) The time it takes for the deterministic multi thread summation:";
+    std::cout << "Result of the summation: " << MToperations.ComputeSumDeterministic() << "\n";
+    std::cout << "(Method 25) The time it takes for the deterministic multi thread product:";
+    std::cout << "Result of the product: " << MToperations.ComputeProductDeterministic() << "\n";
+    std::cout << "(Method 27) The time it takes for the multi thread overflow-safe product using the persistent thread pool:";
+    std::cout << "Result of the product: " << MToperations.ComputeProductScaledThreadPool().ToDouble() << "\n";
 }
 
-void PrintThreadedTimesAdjDiff(MultiThreadVectorOperations& MToperations, std::vector<double>& diff4, std::vector<double>& diff5) {
+void PrintThreadedTimesAdjDiff(MultiThreadVectorOperations& MToperations, std::vector<double>& diff4, std::vector<double>& diff5, std::vector<double>& diff6) {
     std::cout << "(Method 13) The time it takes for the multi thread adjacent difference using std::async:";
     MToperations.ComputeAdjDiffMultiThread1(diff4,true);
     std::cout << "(Method 14) The time it takes for the multi thread adjacent difference using OpenMP:";
     MToperations.ComputeAdjDiffMultiThread2(diff5,true) ;
+    std::cout << "(Method 17) The time it takes for the multi thread adjacent difference using the persistent thread pool:";
+    MToperations.ComputeAdjDiffThreadPool(diff6,true);
 }
 
 
@@ -142,17 +195,21 @@ void ValidationProcedure(TestData& V, double& Sum, double& Product, bool Assert
         assert(close(operations.KahanSummation(false), Sum));
         assert(close(operations.product1(false), Product));
         assert(close(operations.product2(false), Product));
+        assert(close(operations.sumSimd(false), Sum));
+        assert(close(operations.productSimd(false), Product));
+        assert(close(operations.productScaled(false).ToDouble(), Product));
     }
 
     {
-        std::vector<double> diff1, diff2;
+        std::vector<double> diff1, diff2, diff7;
         diff1.reserve(SizeOfTheVector - 1);
         diff2.reserve(SizeOfTheVector);
         std::unique_ptr<double[]> diff3(new double[SizeOfTheVector - 1]);
 
-        PrintSimpleTimesAdjDiff(operations, diff1, diff2, diff3);
+        PrintSimpleTimesAdjDiff(operations, diff1, diff2, diff3, diff7);
 
         if (Assert) {
+            assert(AreVectorsEqual(diff2, diff7));
             diff2.resize(SizeOfTheVector);
             shiftAndPop(diff2);
             assert(AreVectorsEqual(diff1, diff2));
@@ -169,15 +226,22 @@ void ValidationProcedure(TestData& V, double& Sum, double& Product, bool Assert
         assert(close(MToperations.ComputeSumMultiThreadSum2(false), Sum));
         assert(close(MToperations.ComputeSumMultiThreadSum3(false), Sum));
         assert(close(MToperations.ComputeSumMultiThreadProduct(false), Product));
+        assert(close(MToperations.ComputeSumThreadPool(false), Sum));
+        assert(close(MToperations.ComputeProductThreadPool(false), Product));
+        assert(close(MToperations.ComputeSumDeterministic(false), Sum));
+        assert(close(MToperations.ComputeProductDeterministic(false), Product));
+        assert(close(MToperations.ComputeProductScaledThreadPool(false).ToDouble(), Product));
     }
 
-    std::vector<double> diff4(SizeOfTheVector), diff5(SizeOfTheVector);
-    PrintThreadedTimesAdjDiff(MToperations, diff4, diff5);
+    std::vector<double> diff4(SizeOfTheVector), diff5(SizeOfTheVector), diff6(SizeOfTheVector);
+    PrintThreadedTimesAdjDiff(MToperations, diff4, diff5, diff6);
 
     if (Assert) {
         shiftAndPop(diff4);
         shiftAndPop(diff5);
+        shiftAndPop(diff6);
         assert(AreVectorsEqual(diff4, diff5));
+        assert(AreVectorsEqual(diff4, diff6));
         // assert(AreVectorsEqual(diff4, diff2));
     }
 }
@@ -192,12 +256,30 @@ void SumValidation(TestData &V, bool Assert = true) {
     std::cout << "(Method 2) The time it takes for the single thread summation using (std::accumulate) method:";
     std::cout << "Result of the summation:" << std::setprecision(std::numeric_limits<double>::max_digits10) << operations.sum2() << "\n";
     std::cout << "(Method 3) The time it takes for the single thread summation using compensated summation method:";
-    std::cout << "Result of the summation:" << std::setprecision(std::numeric_limits<double>::max_digits10) << operations.KahanSummation() << "\n\n";
+    std::cout << "Result of the summation:" << std::setprecision(std::numeric_limits<double>::max_digits10) << operations.KahanSummation() << "\n";
+    std::cout << "(Method 21) The time it takes for the single thread summation using Neumaier summation on SIMD lanes:";
+    std::cout << "Result of the summation:" << std::setprecision(std::numeric_limits<double>::max_digits10) << operations.NeumaierSummationSimd() << "\n";
+    std::cout << "(Method 22) The time it takes for the single thread summation using blocked pairwise summation:";
+    std::cout << "Result of the summation:" << std::setprecision(std::numeric_limits<double>::max_digits10) << operations.PairwiseSummation() << "\n";
+    MultiThreadVectorOperations MToperations(V.TestVector);
+    std::cout << "(Method 23) The time it takes for the multi thread compensated summation using the persistent thread pool:";
+    std::cout << "Result of the summation:" << std::setprecision(std::numeric_limits<double>::max_digits10) << MToperations.ComputeCompensatedSumThreadPool() << "\n";
+    // Method 56 is the correctly rounded sum: the error of every other method is measured against it
+    const double Exact = operations.ExactSum(false);
+    std::cout << "(Method 56) The time it takes for the single thread exact summation using a superaccumulator:";
+    std::cout << "Result of the summation:" << std::setprecision(std::numeric_limits<double>::max_digits10) << operations.ExactSum() << "\n";
+    std::cout << "Error vs. method 56: method 1 " << operations.sum1(false) - Exact << ", method 2 " << operations.sum2(false) - Exact
+              << ", method 3 " << operations.KahanSummation(false) - Exact << ", method 21 " << operations.NeumaierSummationSimd(false) - Exact
+              << ", method 22 " << operations.PairwiseSummation(false) - Exact << "\n\n";
     if (Assert) {
+        assert(MToperations.ComputeExactSumThreadPool(false) == Exact);
+        assert(close(operations.KahanSummation(false), Exact));
         assert(close(operations.sum1(false), operations.sum2(false)));
         assert(close(operations.sum2(false), operations.KahanSummation(false)));
         assert(close(operations.KahanSummation(false), operations.sum1(false)));
-
+        assert(close(operations.NeumaierSummationSimd(false), operations.KahanSummation(false)));
+        assert(close(operations.PairwiseSummation(false), operations.KahanSummation(false)));
+        assert(close(MToperations.ComputeCompensatedSumThreadPool(false), operations.KahanSummation(false)));
     }
 }
 
@@ -254,4 +336,1679 @@ void test5(){
     TestVectorSize = 10000000;
     V7.TestVector = generate_random_vector(TestVectorSize, -1.0, 1.0);
     SumValidation(V7, true);
-}
\ No newline at end of file
+}
+
+void test6()
+{
+    std::cout << "\n---- View mode ---- Test 6 results: operations on a raw buffer through std::span, no copy ----\n" << std::endl;
+    const double Buffer[] = {-17.3401, 2.01, -3.01, 4.10, -5.07 ,6.70,-7.01};
+    const std::size_t SizeOfTheBuffer = sizeof(Buffer) / sizeof(Buffer[0]);
+    std::vector<double> Copy(Buffer, Buffer + SizeOfTheBuffer);
+
+    SimpleVectorOperations owning(Copy);
+    SimpleVectorOperations view(std::span<const double>(Buffer, SizeOfTheBuffer));
+    assert(!owning.IsView() && view.IsView());
+    assert(view.size() == SizeOfTheBuffer);
+    assert(close(view.sum1(false), owning.sum1(false)));
+    assert(close(view.KahanSummation(false), owning.KahanSummation(false)));
+    assert(close(view.product1(false), owning.product1(false)));
+
+    // A copy of a view still points at the caller's buffer, a copy of an owning object gets its own data
+    SimpleVectorOperations viewCopy(view);
+    assert(viewCopy.IsView());
+    assert(close(viewCopy.sum2(false), owning.sum2(false)));
+    SimpleVectorOperations owningCopy(owning);
+    Copy.assign(SizeOfTheBuffer, 0.0);
+    assert(close(owningCopy.sum2(false), view.sum2(false)));
+
+    MultiThreadVectorOperations MTview(std::span<const double>(Buffer, SizeOfTheBuffer));
+    assert(close(MTview.ComputeSumMultiThreadSum1(false), owning.sum1(false)));
+    assert(close(MTview.ComputeSumMultiThreadProduct(false), owning.product1(false)));
+    std::vector<double> diff1, diff2(SizeOfTheBuffer);
+    view.adjacent_difference1(diff1, false);
+    MTview.ComputeAdjDiffMultiThread1(diff2, false);
+    shiftAndPop(diff2);
+    assert(AreVectorsEqual(diff1, diff2));
+    std::cout << "All view-mode checks passed\n";
+}
+
+void test7()
+{
+    std::cout << "\n---- Thread pool ---- Test 7 results: methods 15-17 on pools of different sizes, pinned and nested ----\n" << std::endl;
+    std::vector<double> V = generate_random_vector(100003, -1.0, 1.0);
+    SimpleVectorOperations operations(V);
+    std::vector<double> Reference;
+    operations.adjacent_difference1(Reference, false);
+
+    for (unsigned int NumOfThreads : {1u, 2u, 3u, 8u, 17u}) {
+        ThreadPool pool(NumOfThreads);
+        ThreadPool pinned(NumOfThreads, {0});
+        for (ThreadPool* p : {&pool, &pinned}) {
+            MultiThreadVectorOperations MToperations(V, *p);
+            for (int repeat = 0; repeat < 20; ++repeat) {
+                assert(close(MToperations.ComputeSumThreadPool(false), operations.sum1(false)));
+                assert(close(MToperations.ComputeProductThreadPool(false), operations.product1(false)));
+            }
+            std::vector<double> diff(V.size());
+            MToperations.ComputeAdjDiffThreadPool(diff, false);
+            shiftAndPop(diff);
+            assert(AreVectorsEqual(diff, Reference));
+        }
+    }
+
+    // More tasks than threads, fewer elements than threads, and a ParallelFor issued from inside a task
+    ThreadPool pool(4);
+    std::vector<int> Counts(1000, 0);
+    pool.ParallelFor(1000, [&](unsigned int i) { Counts[i]++; });
+    for (int c : Counts) {
+        assert(c == 1);
+    }
+    std::vector<double> Tiny = {1.5, -2.0};
+    MultiThreadVectorOperations TinyOperations(Tiny, pool);
+    assert(close(TinyOperations.ComputeSumThreadPool(false), -0.5));
+    std::atomic<int> Nested{0};
+    pool.ParallelFor(4, [&](unsigned int) { pool.ParallelFor(4, [&](unsigned int) { Nested++; }); });
+    assert(Nested == 16);
+
+    // A throwing task: the exception reaches the caller once no task runs any more, and the pool is still usable
+    for (unsigned int thrower : {0u, 3u, 999u}) {
+        std::atomic<int> Started{0};
+        bool caught = false;
+        try {
+            pool.ParallelFor(1000, [&](unsigned int i) {
+                Started++;
+                if (i == thrower) {
+                    throw std::runtime_error("task failed");
+                }
+            });
+        }
+        catch (const std::runtime_error&) {
+            caught = true;
+        }
+        assert(caught && Started >= 1 && Started <= 1000);
+    }
+    std::fill(Counts.begin(), Counts.end(), 0);
+    pool.ParallelFor(1000, [&](unsigned int i) { Counts[i]++; });
+    assert(std::all_of(Counts.begin(), Counts.end(), [](int c) { return c == 1; }));
+    std::cout << "All thread pool checks passed\n";
+}
+
+void test8()
+{
+    std::cout << "\n---- Auto dispatch ---- Test 8 results: size-aware front end and crossover table file ----\n" << std::endl;
+    // Thresholds small enough that both the single thread and the thread pool kernels get picked
+    CrossoverTable table;
+    table.SumThreshold = 1000;
+    table.ProductThreshold = 100;
+    table.AdjDiffThreshold = 500;
+    table.NumOfThreads = 4;
+    ThreadPool pool(4);
+
+    for (std::size_t N : {7, 99, 100, 999, 1000, 5000}) {
+        std::vector<double> V = generate_random_vector(N, 0.5, 1.5);
+        SimpleVectorOperations operations(V);
+        AutoVectorOperations AutoOperations(std::span<const double>(V), table, pool);
+        assert(close(AutoOperations.sum(false), operations.sum1(false)));
+        assert(close(AutoOperations.product(false), operations.product1(false)));
+        std::vector<double> diff, Reference;
+        AutoOperations.adjacent_difference(diff, false);
+        operations.adjacent_difference2(Reference, false);
+        assert(AreVectorsEqual(diff, Reference));
+    }
+
+    // The cache file round-trips, and a malformed file leaves the table unchanged
+    const std::string path = "test8_crossover.txt";
+    assert(table.Save(path));
+    CrossoverTable loaded;
+    assert(loaded.Load(path));
+    assert(loaded.SumThreshold == 1000 && loaded.ProductThreshold == 100 && loaded.AdjDiffThreshold == 500 && loaded.NumOfThreads == 4);
+    { std::ofstream file(path); file << "sum 12\nproduct\n"; }
+    assert(!loaded.Load(path));
+    assert(loaded.SumThreshold == 1000);
+    std::remove(path.c_str());
+
+    // A file calibrated for another thread count is recalibrated and rewritten (on two small sizes, the rewrite is
+    // what is checked here, not the thresholds)
+    { std::ofstream file(path); file << "threads 1000\nsum 1\nproduct 1\nadjacent_difference 1\n"; }
+    ThreadPool small(2);
+    CrossoverTable calibrated = CrossoverTable::LoadOrCalibrate(path, small, {1000, 10000}, 100000);
+    assert(calibrated.NumOfThreads == 2);
+    assert(loaded.Load(path) && loaded.NumOfThreads == 2 && loaded.SumThreshold == calibrated.SumThreshold);
+    std::remove(path.c_str());
+    std::cout << "Calibrated on 2 threads: sum " << calibrated.SumThreshold << ", product " << calibrated.ProductThreshold
+              << ", adjacent difference " << calibrated.AdjDiffThreshold << "\n";
+    std::cout << "All auto dispatch checks passed\n";
+}
+
+void test9()
+{
+    std::cout << "\n---- SIMD kernels ---- Test 9 results: every instruction set the host supports vs. methods 1, 4 and 7 ----\n" << std::endl;
+    const double eps = std::ldexp(1.0, -53);
+    std::vector<SimdLevel> Levels = {SimdLevel::Scalar};
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (GetSimdKernels(level).level == level) {
+            Levels.push_back(level);
+        }
+    }
+
+    // Sizes around every unroll width, so the tails get exercised
+    std::vector<std::size_t> Sizes = {1000003};
+    for (std::size_t N = 0; N <= 70; ++N) {
+        Sizes.push_back(N);
+    }
+    for (std::size_t N : Sizes) {
+        std::vector<double> V = generate_random_vector(N, -1.0, 1.0);
+        std::vector<double> P = generate_random_vector(N, 0.999, 1.001);
+        SimpleVectorOperations operations(V), products(P);
+        const double Sum = operations.sum1(false);
+        const double Product = products.product1(false);
+        double AbsSum = 0.0;
+        for (double x : V) {
+            AbsSum += std::fabs(x);
+        }
+        // Documented tolerance (SimdKernels.h), with a floor of one ulp for N <= 1
+        const double SumTolerance = 2.0 * (N ? N - 1 : 0) * eps * AbsSum + eps * std::fabs(Sum);
+        const double ProductTolerance = (2.0 * (N ? N - 1 : 0) + 1.0) * eps * std::fabs(Product);
+        std::vector<double> Reference;
+        operations.adjacent_difference2(Reference, false);
+
+        for (SimdLevel level : Levels) {
+            const SimdKernels& kernels = GetSimdKernels(level);
+            assert(std::fabs(kernels.sum(V.data(), N) - Sum) <= SumTolerance);
+            assert(std::fabs(kernels.product(P.data(), N) - Product) <= ProductTolerance);
+            std::vector<double> diff(N);
+            if (N) {
+                diff[0] = V[0];
+            }
+            kernels.adjacent_difference(V.data(), N, diff.data());
+            assert(diff == Reference); // exact
+        }
+    }
+    std::cout << "Checked:";
+    for (SimdLevel level : Levels) {
+        std::cout << " " << GetSimdKernels(level).name;
+    }
+    std::cout << " (methods 18-20 use " << BestSimdKernels().name << ")\nAll SIMD checks passed\n";
+}
+
+namespace
+{
+    // Reference sum for the accuracy checks: Neumaier summation in long double
+    long double ReferenceSum(const std::vector<double>& vec) {
+        long double sum = 0.0L, compensation = 0.0L;
+        for (double x : vec) {
+            long double t = sum + x;
+            compensation += std::fabs(sum) >= std::fabs(static_cast<long double>(x)) ? (sum - t) + x : (x - t) + sum;
+            sum = t;
+        }
+        return sum + compensation;
+    }
+}
+
+void test10()
+{
+    std::cout << "\n---- Compensated summation ---- Test 10 results: methods 21-23 on cancelling and random data ----\n" << std::endl;
+    // {1e16, 1, -1e16} repeated: the naive sum and Kahan's lose every 1, Neumaier keeps them
+    std::vector<double> Cancelling;
+    for (int i = 0; i < 1000; ++i) {
+        Cancelling.insert(Cancelling.end(), {1e16, 1.0, -1e16});
+    }
+    SimpleVectorOperations operations(Cancelling);
+    std::cout << "Cancelling data, exact sum 1000: method 1 " << operations.sum1(false) << ", method 3 " << operations.KahanSummation(false)
+              << ", method 21 " << operations.NeumaierSummationSimd(false) << "\n";
+    assert(std::fabs(operations.NeumaierSummationSimd(false) - 1000.0) <= 1e-6);
+    for (unsigned int NumOfThreads : {1u, 3u, 8u}) {
+        ThreadPool pool(NumOfThreads);
+        MultiThreadVectorOperations MToperations(Cancelling, pool);
+        assert(std::fabs(MToperations.ComputeCompensatedSumThreadPool(false) - 1000.0) <= 1e-6);
+    }
+
+    // Random data: methods 21 and 23 within the Neumaier bound (SimdKernels.h), method 22 within the pairwise one
+    const double eps = std::ldexp(1.0, -53);
+    for (std::size_t N : {0, 1, 17, 1000, 1000003}) {
+        std::vector<double> V = generate_random_vector(N, -1.0, 1.0);
+        const double Reference = static_cast<double>(ReferenceSum(V));
+        double AbsSum = 0.0;
+        for (double x : V) {
+            AbsSum += std::fabs(x);
+        }
+        SimpleVectorOperations Voperations(V);
+        const double NeumaierBound = 2.0 * eps * std::fabs(Reference) + N * eps * eps * AbsSum + eps * std::fabs(Reference);
+        const double PairwiseBound = (256 + std::log2(N + 1.0) + 1) * eps * AbsSum;
+        assert(std::fabs(Voperations.NeumaierSummationSimd(false) - Reference) <= NeumaierBound);
+        assert(std::fabs(Voperations.PairwiseSummation(false) - Reference) <= PairwiseBound);
+        ThreadPool pool(5);
+        MultiThreadVectorOperations MToperations(V, pool);
+        assert(std::fabs(MToperations.ComputeCompensatedSumThreadPool(false) - Reference) <= NeumaierBound);
+    }
+    std::cout << "All compensated summation checks passed\n";
+}
+
+void test11()
+{
+    std::cout << "\n---- Deterministic reductions ---- Test 11 results: methods 24 and 25 across pool sizes and SIMD levels ----\n" << std::endl;
+    for (std::size_t N : {0, 1, 7, 8191, 8192, 8193, 1000003}) {
+        std::vector<double> V = generate_random_vector(N, -1.0, 1.0);
+        std::vector<double> P = generate_random_vector(N, 0.9999, 1.0001);
+        ThreadPool single(1);
+        const double Sum = MultiThreadVectorOperations(V, single).ComputeSumDeterministic(false);
+        const double Product = MultiThreadVectorOperations(P, single).ComputeProductDeterministic(false);
+        assert(close(Sum, SimpleVectorOperations(V).sum1(false)));
+        assert(close(Product, SimpleVectorOperations(P).product1(false)));
+
+        // Bit for bit, not within a tolerance
+        for (unsigned int NumOfThreads : {2u, 3u, 7u, 16u, 64u}) {
+            ThreadPool pool(NumOfThreads);
+            for (int repeat = 0; repeat < 5; ++repeat) {
+                assert(MultiThreadVectorOperations(V, pool).ComputeSumDeterministic(false) == Sum);
+                assert(MultiThreadVectorOperations(P, pool).ComputeProductDeterministic(false) == Product);
+            }
+        }
+        // The ordered kernels of every supported instruction set agree bit for bit
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            const SimdKernels& kernels = GetSimdKernels(level);
+            const SimdKernels& best = BestSimdKernels();
+            assert(kernels.ordered_sum(V.data(), N) == best.ordered_sum(V.data(), N));
+            assert(kernels.ordered_product(P.data(), N) == best.ordered_product(P.data(), N));
+        }
+    }
+    std::cout << "All deterministic reduction checks passed\n";
+}
+
+void test12()
+{
+    std::cout << "\n---- Scaled product ---- Test 12 results: methods 26 and 27 beyond the double range, with zeros, signs and subnormals ----\n" << std::endl;
+    // 1,000,003 factors of magnitude up to 1e10: |product| ~ 10^(millions), far beyond 1.8e308
+    std::vector<double> V = generate_random_vector(1000003, 1.0, 1e10);
+    std::size_t Negatives = 0;
+    for (std::size_t i = 0; i < V.size(); i += 3) {
+        V[i] = -V[i];
+        ++Negatives;
+    }
+    V[12346] = 4.9e-320; // subnormal
+    long double LogSum = 0.0L;
+    for (double x : V) {
+        LogSum += std::log(std::fabs(static_cast<long double>(x)));
+    }
+    SimpleVectorOperations operations(V);
+    std::cout << "Method 4: " << operations.product1(false) << ", method 26: log|P| = " << operations.productScaled(false).LogAbs()
+              << " (expected " << static_cast<double>(LogSum) << ")\n";
+    for (const ScaledProduct& P : {operations.productScaled(false), MultiThreadVectorOperations(V, *std::make_unique<ThreadPool>(7)).ComputeProductScaledThreadPool(false)}) {
+        assert(std::fabs(P.LogAbs() - static_cast<double>(LogSum)) <= 1e-9 * std::fabs(static_cast<double>(LogSum)));
+        assert(P.Sign() == (Negatives % 2 ? -1 : 1));
+        assert(std::isinf(P.ToDouble()));
+    }
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        ScaledProduct P = GetSimdKernels(level).scaled_product(V.data(), V.size());
+        assert(std::fabs(P.LogAbs() - static_cast<double>(LogSum)) <= 1e-9 * std::fabs(static_cast<double>(LogSum)));
+        assert(P.Sign() == (Negatives % 2 ? -1 : 1));
+    }
+
+    // Results in range agree with method 4, tiny results underflow only in ToDouble
+    std::vector<double> Small = generate_random_vector(5000, -1.0, 1.0);
+    for (auto& x : Small) {
+        x = std::exp(x); // log|P| is a random walk around 0, so method 4 does not overflow
+    }
+    SimpleVectorOperations small(Small);
+    // Relative check: close() is absolute below a difference of 1, too strict for products around 1e10
+    const double SmallProduct = small.product1(false);
+    assert(std::fabs(small.productScaled(false).ToDouble() - SmallProduct) <= 1e-11 * std::fabs(SmallProduct));
+    std::vector<double> Tiny(1000, 1e-10);
+    ScaledProduct TinyProduct = SimpleVectorOperations(Tiny).productScaled(false);
+    assert(TinyProduct.ToDouble() == 0.0 && close(TinyProduct.LogAbs(), 1000 * std::log(1e-10)));
+
+    // Zeros, infinities and NaNs anywhere (in a full batch or in the tail) give the IEEE result
+    for (std::size_t position : {3, 700, 1999}) {
+        std::vector<double> W = generate_random_vector(2000, -2.0, 2.0);
+        W[position] = 0.0;
+        assert(SimpleVectorOperations(W).productScaled(false).ToDouble() == 0.0);
+        W[position] = std::numeric_limits<double>::infinity();
+        assert(std::isinf(SimpleVectorOperations(W).productScaled(false).ToDouble()));
+        W[0] = 0.0;
+        assert(std::isnan(SimpleVectorOperations(W).productScaled(false).ToDouble()));
+    }
+    std::cout << "All scaled product checks passed\n";
+}
+
+void test13()
+{
+    std::cout << "\n---- Thread counts ---- Test 13 results: methods 9-14 with 1 to 8 spawned threads ----\n" << std::endl;
+    std::vector<double> V = generate_random_vector(10007, 0.9, 1.1);
+    SimpleVectorOperations operations(V);
+    std::vector<double> Reference;
+    operations.adjacent_difference1(Reference, false);
+    for (unsigned int NumOfThreads = 1; NumOfThreads <= 8; ++NumOfThreads) {
+        MultiThreadVectorOperations MToperations(V);
+        MToperations.SetNumOfSpawnedThreads(NumOfThreads);
+        assert(close(MToperations.ComputeSumMultiThreadSum1(false), operations.sum1(false)));
+        assert(close(MToperations.ComputeSumMultiThreadSum2(false), operations.sum1(false)));
+        assert(close(MToperations.ComputeSumMultiThreadSum3(false), operations.sum1(false)));
+        assert(close(MToperations.ComputeSumMultiThreadProduct(false), operations.product1(false)));
+        std::vector<double> diff4(V.size()), diff5(V.size());
+        MToperations.ComputeAdjDiffMultiThread1(diff4, false);
+        MToperations.ComputeAdjDiffMultiThread2(diff5, false);
+        shiftAndPop(diff4);
+        shiftAndPop(diff5);
+        assert(AreVectorsEqual(diff4, Reference));
+        assert(AreVectorsEqual(diff5, Reference));
+    }
+    // The padded slots really are one per cache line pair
+    static_assert(sizeof(CacheLinePadded<double>) == CacheLineSize && alignof(CacheLinePadded<double>) == CacheLineSize);
+    std::vector<CacheLinePadded<double>> Slots(3);
+    assert(reinterpret_cast<std::uintptr_t>(&Slots[1]) - reinterpret_cast<std::uintptr_t>(&Slots[0]) == CacheLineSize);
+    assert(reinterpret_cast<std::uintptr_t>(Slots.data()) % CacheLineSize == 0);
+    std::cout << "All thread count checks passed\n";
+}
+
+void test14()
+{
+    std::cout << "\n---- Fused statistics ---- Test 14 results: methods 28 and 29 vs. separate computations ----\n" << std::endl;
+    for (std::size_t N : {0, 1, 5, 511, 512, 513, 100003}) {
+        std::vector<double> V = generate_random_vector(N, 0.5, 1.5);
+        if (N > 600) {
+            // Repeated extremes in different blocks and chunks: the first occurrence must win
+            V[700] = V[90000] = V[100002] = 0.1;
+            V[650] = V[50000] = 2.0;
+        }
+        SimpleVectorOperations operations(V);
+        long double Mean = 0.0L, M2 = 0.0L;
+        for (double x : V) {
+            Mean += x;
+        }
+        Mean = N ? Mean / N : 0.0L;
+        for (double x : V) {
+            M2 += (x - Mean) * (x - Mean);
+        }
+        const std::size_t MinIndex = N ? std::min_element(V.begin(), V.end()) - V.begin() : SIZE_MAX;
+        const std::size_t MaxIndex = N ? std::max_element(V.begin(), V.end()) - V.begin() : SIZE_MAX;
+
+        std::vector<VectorStatistics> Results = {operations.Statistics(StatAll, false)};
+        for (unsigned int NumOfThreads : {1u, 3u, 8u}) {
+            ThreadPool pool(NumOfThreads);
+            Results.push_back(MultiThreadVectorOperations(V, pool).ComputeStatisticsThreadPool(StatAll, false));
+        }
+        for (const VectorStatistics& S : Results) {
+            assert(S.count == N);
+            assert(close(S.sum, operations.sum1(false)));
+            assert(close(S.compensated_sum.Result(), operations.KahanSummation(false)));
+            assert(close(S.product, operations.product1(false)));
+            assert(close(S.mean, static_cast<double>(Mean)));
+            assert(std::fabs(S.Variance() - static_cast<double>(N ? M2 / N : 0.0L)) <= 1e-12);
+            assert(S.min_max.min_index == MinIndex && S.min_max.max_index == MaxIndex);
+            if (N) {
+                assert(S.min_max.min == V[MinIndex] && S.min_max.max == V[MaxIndex]);
+            }
+        }
+        // Only the requested statistics are computed, and they do not depend on the others
+        VectorStatistics MinMaxOnly = operations.Statistics(StatMinMax, false);
+        assert(MinMaxOnly.min_max.min_index == MinIndex && MinMaxOnly.min_max.max_index == MaxIndex);
+        VectorStatistics VarianceOnly = operations.Statistics(StatVariance, false);
+        assert(close(VarianceOnly.mean, static_cast<double>(Mean)) && close(VarianceOnly.Variance(), Results[0].Variance()));
+    }
+
+    // NaNs are skipped by min/max, infinities are found even when nothing compares below them
+    const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> Special(1500, inf);
+    Special[3] = nan;
+    Special[1000] = -inf;
+    VectorStatistics S = SimpleVectorOperations(Special).Statistics(StatMinMax, false);
+    assert(S.min_max.min == -inf && S.min_max.min_index == 1000 && S.min_max.max == inf && S.min_max.max_index == 0);
+    std::vector<double> AllNaN(10, nan);
+    S = SimpleVectorOperations(AllNaN).Statistics(StatMinMax, false);
+    assert(S.min_max.min_index == SIZE_MAX && S.min_max.max_index == SIZE_MAX);
+    std::cout << "All fused statistics checks passed\n";
+}
+
+void test15()
+{
+    std::cout << "\n---- Prefix sums ---- Test 15 results: methods 30-33 vs. std::partial_sum, method 34 vs. method 7 ----\n" << std::endl;
+    const double eps = std::ldexp(1.0, -53);
+    std::vector<SimdLevel> Levels = {SimdLevel::Scalar};
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (GetSimdKernels(level).level == level) {
+            Levels.push_back(level);
+        }
+    }
+    std::vector<std::size_t> Sizes = {1000, 100003};
+    for (std::size_t N = 0; N <= 20; ++N) {
+        Sizes.push_back(N);
+    }
+    for (std::size_t N : Sizes) {
+        std::vector<double> V = generate_random_vector(N, -1.0, 1.0);
+        // Small integers: every prefix is exact, so all methods must agree bit for bit
+        std::vector<double> Integers(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            Integers[i] = std::floor(V[i] * 1000.0);
+        }
+        const double init = 5.0;
+        std::vector<double> Reference(N), ExactReference(N), AbsPrefix(N);
+        double Running = init, AbsRunning = std::fabs(init);
+        for (std::size_t i = 0; i < N; ++i) {
+            Running += V[i];
+            AbsRunning += std::fabs(V[i]);
+            Reference[i] = Running;
+            AbsPrefix[i] = AbsRunning;
+        }
+        std::partial_sum(Integers.begin(), Integers.end(), ExactReference.begin());
+        // Both the reference and the methods may be off by 2 i eps sum(|x|) at prefix i
+        auto CheckInclusive = [&](const std::vector<double>& out, std::size_t shift) {
+            assert(out.size() == N);
+            for (std::size_t i = shift; i < N; ++i) {
+                assert(std::fabs(out[i] - Reference[i - shift]) <= 4.0 * (i + 2) * eps * AbsPrefix[i - shift]);
+            }
+        };
+
+        for (SimdLevel level : Levels) {
+            const SimdKernels& kernels = GetSimdKernels(level);
+            std::vector<double> out(N);
+            kernels.inclusive_scan(V.data(), N, out.data(), init);
+            CheckInclusive(out, 0);
+            std::vector<double> InPlace = Integers;
+            const double last = kernels.inclusive_scan(InPlace.data(), N, InPlace.data(), 0.0);
+            assert(InPlace == ExactReference && last == (N ? ExactReference.back() : 0.0));
+            // The in-place adjacent difference undoes the scan exactly on integers, and matches method 7 on any data
+            kernels.adjacent_difference_inplace(InPlace.data(), N, 0.0);
+            assert(InPlace == Integers);
+            std::vector<double> Diff = V, Expected;
+            SimpleVectorOperations(V).adjacent_difference2(Expected, false);
+            kernels.adjacent_difference_inplace(Diff.data(), N, 0.0);
+            assert(Diff == Expected);
+        }
+
+        SimpleVectorOperations operations(V);
+        std::vector<double> out;
+        operations.inclusive_scanSimd(out, init, false);
+        CheckInclusive(out, 0);
+        operations.exclusive_scanSimd(out, init, false);
+        CheckInclusive(out, 1);
+        assert(N == 0 || out[0] == init);
+        for (unsigned int NumOfThreads : {1u, 2u, 3u, 8u}) {
+            ThreadPool pool(NumOfThreads);
+            MultiThreadVectorOperations MToperations(V, pool);
+            MToperations.ComputeInclusiveScanThreadPool(out, init, false);
+            CheckInclusive(out, 0);
+            MToperations.ComputeExclusiveScanThreadPool(out, init, false);
+            CheckInclusive(out, 1);
+            assert(N == 0 || out[0] == init);
+            MultiThreadVectorOperations(Integers, pool).ComputeInclusiveScanThreadPool(out, 0.0, false);
+            assert(out == ExactReference);
+
+            // Method 34, with chunk boundaries in every possible place
+            std::vector<double> Data = V, Expected;
+            SimpleVectorOperations(V).adjacent_difference2(Expected, false);
+            AdjDiffInPlace(Data, pool, false);
+            assert(Data == Expected);
+        }
+    }
+    std::cout << "All prefix sum and in-place adjacent difference checks passed\n";
+}
+
+
+void test16()
+{
+    std::cout << "\n---- Element types ---- Test 16 results: float and int64 data, every instruction set and pool size ----\n" << std::endl;
+    std::vector<SimdLevel> Levels = {SimdLevel::Scalar};
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (GetSimdKernels(level).level == level) {
+            Levels.push_back(level);
+        }
+    }
+    std::vector<std::size_t> Sizes = {100003};
+    for (std::size_t N = 0; N <= 70; ++N) {
+        Sizes.push_back(N);
+    }
+
+    // float data: sums and products within the SimdKernels.h bounds of the accumulator's epsilon
+    const double FloatEps = std::ldexp(1.0, -24), DoubleEps = std::ldexp(1.0, -53);
+    for (std::size_t N : Sizes) {
+        std::vector<float> F(N), P(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            F[i] = static_cast<float>(std::sin(1.0 + i) * 100.0);
+            P[i] = static_cast<float>(1.0 + std::cos(1.0 + i) * 1e-3);
+        }
+        long double Sum = 0.0L, AbsSum = 0.0L, Product = 1.0L;
+        for (std::size_t i = 0; i < N; ++i) {
+            Sum += F[i];
+            AbsSum += std::fabs(F[i]);
+            Product *= P[i];
+        }
+        const double n = static_cast<double>(N ? N : 1);
+        auto CheckFloat = [&](double sum, double product, double eps) {
+            assert(std::fabs(sum - static_cast<double>(Sum)) <= 2.0 * n * eps * static_cast<double>(AbsSum));
+            assert(std::fabs(product - static_cast<double>(Product)) <= 2.0 * n * eps * static_cast<double>(Product));
+        };
+        std::vector<float> Reference(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            Reference[i] = i == 0 ? F[0] : F[i] - F[i - 1];
+        }
+        for (SimdLevel level : Levels) {
+            const auto& single = GetTypedSimdKernels<float, float>(level);
+            const auto& mixed = GetTypedSimdKernels<float, double>(level);
+            CheckFloat(single.sum(F.data(), N), single.product(P.data(), N), FloatEps);
+            CheckFloat(mixed.sum(F.data(), N), mixed.product(P.data(), N), DoubleEps);
+            std::vector<float> diff(N);
+            if (N) {
+                diff[0] = F[0];
+            }
+            mixed.adjacent_difference(F.data(), N, diff.data());
+            assert(diff == Reference);
+        }
+        BasicSimpleVectorOperations<float> operations{std::span<const float>(F)}, products(P);
+        BasicSimpleVectorOperations<float, float> SingleOperations(F), SingleProducts{std::span<const float>(P)};
+        CheckFloat(operations.sum1(false), products.product1(false), DoubleEps);
+        CheckFloat(operations.sumSimd(false), products.productSimd(false), DoubleEps);
+        CheckFloat(SingleOperations.sum1(false), SingleProducts.product1(false), FloatEps);
+        CheckFloat(SingleOperations.sumSimd(false), SingleProducts.productSimd(false), FloatEps);
+        std::vector<float> diff;
+        operations.adjacent_difference2(diff, false);
+        assert(diff == Reference);
+        operations.adjacent_differenceSimd(diff, false);
+        assert(diff == Reference);
+        for (unsigned int NumOfThreads : {1u, 3u, 8u}) {
+            ThreadPool pool(NumOfThreads);
+            BasicMultiThreadVectorOperations<float> MToperations(F, pool), MTproducts(P, pool);
+            BasicMultiThreadVectorOperations<float, float> MTsingle(F, pool), MTsingleProducts(P, pool);
+            CheckFloat(MToperations.ComputeSumThreadPool(false), MTproducts.ComputeProductThreadPool(false), DoubleEps);
+            CheckFloat(MTsingle.ComputeSumThreadPool(false), MTsingleProducts.ComputeProductThreadPool(false), FloatEps);
+            MToperations.ComputeAdjDiffThreadPool(diff, false);
+            assert(diff == Reference);
+        }
+    }
+
+    // int64 data: exact sums over the full range, overflow reported only when the total does not fit
+    std::mt19937_64 generator(16);
+    for (std::size_t N : Sizes) {
+        std::vector<std::int64_t> I(N);
+        for (auto& x : I) {
+            x = static_cast<std::int64_t>(generator() >> 1) * (generator() % 2 ? 1 : -1);
+        }
+        __int128 Sum = 0;
+        for (std::int64_t x : I) {
+            Sum += x;
+        }
+        const bool Overflow = Sum > INT64_MAX || Sum < INT64_MIN;
+        // The same values negated, spread over other lanes and chunks: the total is back to 7
+        std::vector<std::int64_t> Balanced = I;
+        for (std::size_t i = N; i-- > 0;) {
+            Balanced.push_back(-I[i]);
+        }
+        Balanced.push_back(7);
+        auto CheckSum = [&](const CheckedInt64& sum, const CheckedInt64& balanced) {
+            assert(sum.Overflow() == Overflow && (Overflow || sum.Value() == static_cast<std::int64_t>(Sum)));
+            assert(!balanced.Overflow() && balanced.Value() == 7);
+        };
+        std::vector<std::int64_t> Reference(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            Reference[i] = i == 0 ? I[0] : Difference(I[i], I[i - 1]);
+        }
+        for (SimdLevel level : Levels) {
+            const auto& kernels = GetTypedSimdKernels<std::int64_t, CheckedInt64>(level);
+            CheckSum(kernels.sum(I.data(), N), kernels.sum(Balanced.data(), Balanced.size()));
+            std::vector<std::int64_t> diff(N);
+            if (N) {
+                diff[0] = I[0];
+            }
+            kernels.adjacent_difference(I.data(), N, diff.data());
+            assert(diff == Reference);
+        }
+        BasicSimpleVectorOperations<std::int64_t> operations(I), balanced(Balanced);
+        CheckSum(operations.sum1(false), balanced.sum1(false));
+        CheckSum(operations.sumSimd(false), balanced.sumSimd(false));
+        for (unsigned int NumOfThreads : {1u, 3u, 8u}) {
+            ThreadPool pool(NumOfThreads);
+            CheckSum(BasicMultiThreadVectorOperations<std::int64_t>(I, pool).ComputeSumThreadPool(false),
+                     BasicMultiThreadVectorOperations<std::int64_t>(Balanced, pool).ComputeSumThreadPool(false));
+            std::vector<std::int64_t> diff;
+            BasicMultiThreadVectorOperations<std::int64_t>(I, pool).ComputeAdjDiffThreadPool(diff, false);
+            assert(diff == Reference);
+        }
+    }
+
+    // int64 products: exact when they fit, overflow otherwise, and a zero factor anywhere gives 0
+    const std::int64_t Big = std::int64_t(1) << 32;
+    std::vector<std::int64_t> Fits = {3, -5, 7, 1, 1, 1, 1, 1, 1, -1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    std::vector<std::int64_t> Overflows = {Big, 1, 1, Big, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    std::vector<std::int64_t> Zero = Overflows;
+    Zero.back() = 0;
+    for (unsigned int NumOfThreads : {1u, 2u, 8u}) {
+        ThreadPool pool(NumOfThreads);
+        CheckedInt64 p = BasicMultiThreadVectorOperations<std::int64_t>(Fits, pool).ComputeProductThreadPool(false);
+        assert(!p.Overflow() && p.Value() == 210);
+        assert(BasicMultiThreadVectorOperations<std::int64_t>(Overflows, pool).ComputeProductThreadPool(false).Overflow());
+        p = BasicMultiThreadVectorOperations<std::int64_t>(Zero, pool).ComputeProductThreadPool(false);
+        assert(!p.Overflow() && p.Value() == 0);
+    }
+    assert(BasicSimpleVectorOperations<std::int64_t>(Overflows).product1(false).Overflow());
+    assert(BasicSimpleVectorOperations<std::int64_t>(Zero).productSimd(false).Value() == 0);
+    std::cout << "All float and int64 checks passed\n";
+}
+
+
+void test17()
+{
+    std::cout << "\n---- Vector files ---- Test 17 results: file format, mapped reader and streaming methods 35-37 ----\n" << std::endl;
+    const std::string path = "test17_input.vec", OutputPath = "test17_output.vec";
+    for (std::size_t N : {0, 1, 511, 512, 513, 100003}) {
+        std::vector<double> V = generate_random_vector(N, 0.999, 1.001);
+        VectorFileOptions options;
+        options.ChecksumBlock = N % 2 ? 1000 : 0;
+        assert(WriteVectorFile<double>(path, V, options));
+        std::vector<double> Read;
+        assert(ReadVectorFile(path, Read) && Read == V);
+
+        MappedVectorFile file(path);
+        assert(file.IsValid() && file.dtype() == VectorDType::Float64 && file.size() == N);
+        assert(file.HasChecksums() == (options.ChecksumBlock > 0) && file.VerifyChecksums());
+        assert(std::equal(V.begin(), V.end(), file.data<double>().begin(), file.data<double>().end()));
+        assert(file.data<float>().empty());
+        assert(reinterpret_cast<std::uintptr_t>(file.data<double>().data()) % 4096 == 0);
+
+        std::vector<double> Expected;
+        SimpleVectorOperations(V).adjacent_difference2(Expected, false);
+        for (unsigned int NumOfThreads : {1u, 3u, 8u}) {
+            ThreadPool pool(NumOfThreads);
+            MultiThreadVectorOperations MToperations(V, pool);
+            for (bool release : {false, true}) {
+                StreamingVectorOperations streaming(file, pool);
+                streaming.SetWindowSize(4096); // many windows per thread
+                streaming.SetReleaseWindows(release);
+                assert(streaming.IsView() && streaming.size() == N);
+                assert(close(streaming.sum(false), MToperations.ComputeSumThreadPool(false)));
+                assert(close(streaming.product(false), MToperations.ComputeProductThreadPool(false)));
+                assert(streaming.adjacent_difference(OutputPath, false));
+                MappedVectorFile output(OutputPath);
+                assert(output.IsValid() && output.size() == N && output.VerifyChecksums());
+                assert(output.HasChecksums() == file.HasChecksums());
+                assert(std::equal(Expected.begin(), Expected.end(), output.data<double>().begin(), output.data<double>().end()));
+            }
+        }
+    }
+
+    // An input aligned to a cache line only still gets a page-aligned output, so the threads never share an output page
+    {
+        std::vector<double> V = generate_random_vector(100003, 0.999, 1.001), Expected;
+        VectorFileOptions options;
+        options.Alignment = 64;
+        assert(WriteVectorFile<double>(path, V, options));
+        MappedVectorFile file(path);
+        assert(file.IsValid() && file.header().alignment == 64);
+        SimpleVectorOperations(V).adjacent_difference2(Expected, false);
+        ThreadPool pool(3);
+        StreamingVectorOperations streaming(file, pool);
+        streaming.SetWindowSize(4096);
+        streaming.SetReleaseWindows(true);
+        assert(streaming.adjacent_difference(OutputPath, false));
+        MappedVectorFile output(OutputPath);
+        assert(output.IsValid() && output.header().alignment % 4096 == 0);
+        assert(reinterpret_cast<std::uintptr_t>(output.data<double>().data()) % 4096 == 0);
+        assert(std::equal(Expected.begin(), Expected.end(), output.data<double>().begin(), output.data<double>().end()));
+    }
+
+    // Other element types round trip, and are empty for the float64-only streaming methods
+    std::vector<float> F = {1.5f, -2.0f, 3.25f};
+    std::vector<std::int64_t> I = {INT64_MAX, -1, 42};
+    std::vector<float> ReadF;
+    std::vector<std::int64_t> ReadI;
+    assert(WriteVectorFile<float>(path, F) && ReadVectorFile(path, ReadF) && ReadF == F && !ReadVectorFile(path, ReadI));
+    {
+        MappedVectorFile file(path);
+        assert(file.dtype() == VectorDType::Float32 && file.data<float>().size() == 3 && file.data<float>()[2] == 3.25f);
+        StreamingVectorOperations streaming(file);
+        assert(streaming.size() == 0 && !streaming.adjacent_difference(OutputPath, false));
+    }
+    assert(WriteVectorFile<std::int64_t>(path, I) && ReadVectorFile(path, ReadI) && ReadI == I);
+
+    // A flipped byte fails the checksums; a truncated file or a wrong magic is rejected
+    std::vector<double> V = generate_random_vector(5000);
+    VectorFileOptions options;
+    options.ChecksumBlock = 256;
+    assert(WriteVectorFile<double>(path, V, options));
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        // Complement the byte so it always changes
+        file.seekg(4096 + 8 * 3000 + 5);
+        const char byte = static_cast<char>(file.get());
+        file.seekp(4096 + 8 * 3000 + 5);
+        file.put(static_cast<char>(~byte));
+    }
+    assert(MappedVectorFile(path).IsValid() && !MappedVectorFile(path).VerifyChecksums());
+    {
+        std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+        VectorFileHeader hdr{};
+        std::memcpy(hdr.magic, "VECOPS\0\1", 8);
+        hdr.dtype = 1;
+        hdr.element_size = 8;
+        hdr.length = 1000;
+        hdr.alignment = 64;
+        hdr.data_offset = 64;
+        truncated.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    }
+    std::vector<double> Read;
+    assert(!MappedVectorFile(path).IsValid() && !ReadVectorFile(path, Read));
+    { std::ofstream garbage(path, std::ios::binary | std::ios::trunc); garbage << std::string(4096, 'x'); }
+    assert(!MappedVectorFile(path).IsValid());
+    assert(!MappedVectorFile("test17_missing.vec").IsValid());
+    std::remove(path.c_str());
+    std::remove(OutputPath.c_str());
+    std::cout << "All vector file checks passed\n";
+}
+
+
+void test18()
+{
+    std::cout << "\n---- Incremental aggregates ---- Test 18 results: updates and range queries vs. recomputing the range ----\n" << std::endl;
+    std::mt19937_64 generator(18);
+    const double eps = std::ldexp(1.0, -53);
+    for (std::size_t N : {0, 1, 63, 64, 65, 1000, 100003}) {
+        std::vector<double> V = generate_random_vector(N, 0.5, 2.0);
+        for (unsigned int NumOfThreads : {1u, 3u}) {
+            ThreadPool pool(NumOfThreads);
+            std::vector<double> Data = V;
+            IncrementalAggregates tree(Data, IncrementalAggregates::AllFlags, pool);
+            auto Check = [&](std::size_t begin, std::size_t end) {
+                const RangeAggregate result = tree.Query(begin, end);
+                long double Sum = 0.0L, AbsSum = 0.0L;
+                MinMaxIndex Expected{std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), SIZE_MAX, SIZE_MAX};
+                for (std::size_t i = begin; i < end; ++i) {
+                    Sum += Data[i];
+                    AbsSum += std::fabs(Data[i]);
+                    if (!std::isnan(Data[i]) && (Expected.min_index == SIZE_MAX || Data[i] < Expected.min)) {
+                        Expected.min = Data[i];
+                        Expected.min_index = i;
+                    }
+                    if (!std::isnan(Data[i]) && (Expected.max_index == SIZE_MAX || Data[i] > Expected.max)) {
+                        Expected.max = Data[i];
+                        Expected.max_index = i;
+                    }
+                }
+                assert(std::fabs(result.sum - static_cast<double>(Sum)) <= 4.0 * (end - begin + 1) * eps * static_cast<double>(AbsSum));
+                const ScaledProduct Product = ScaledProductOf(Data.data() + begin, end - begin);
+                assert(result.product.Sign() == Product.Sign());
+                assert(std::fabs(result.product.LogAbs() - Product.LogAbs()) <= 1e-12 * (1.0 + std::fabs(Product.LogAbs())));
+                assert(result.min_max.min_index == Expected.min_index && result.min_max.max_index == Expected.max_index);
+                assert(Expected.min_index == SIZE_MAX || (result.min_max.min == Expected.min && result.min_max.max == Expected.max));
+            };
+            Check(0, N);
+            assert(close(tree.Sum(), tree.Query(0, N).sum) && tree.MinMax().min_index == tree.Query(0, N).min_max.min_index);
+            for (int step = 0; step < 300 && N > 0; ++step) {
+                // Single updates, runs across block boundaries, repeated extremes and NaNs
+                const std::size_t i = generator() % N;
+                if (step % 10 == 0) {
+                    std::vector<double> Run(std::min<std::size_t>(N - i, 1 + generator() % 200), 0.25 + (generator() % 4));
+                    std::copy(Run.begin(), Run.end(), Data.begin() + i);
+                    tree.Set(i, Run);
+                }
+                else {
+                    const double value = step % 17 == 0 ? std::numeric_limits<double>::quiet_NaN() : 0.5 + (generator() % 1000) * 1.5e-3;
+                    Data[i] = value;
+                    tree.Set(i, value);
+                }
+                std::size_t begin = generator() % (N + 1), end = generator() % (N + 1);
+                if (begin > end) {
+                    std::swap(begin, end);
+                }
+                if (step % 17 != 0) {
+                    Check(begin, end);
+                }
+                else {
+                    // Sums and products see the NaN; only the min/max must still skip it
+                    const MinMaxIndex result = tree.MinMax(begin, end);
+                    for (std::size_t k = begin; k < end; ++k) {
+                        assert(std::isnan(Data[k]) || (Data[k] >= result.min && Data[k] <= result.max));
+                    }
+                    Data[i] = 1.0;
+                    tree.Set(i, 1.0);
+                }
+            }
+            Check(0, N);
+            assert(tree.values() == Data);
+        }
+    }
+    // Only the requested aggregates are kept
+    std::vector<double> V = generate_random_vector(1000);
+    IncrementalAggregates SumOnly(V, StatSum);
+    SumOnly.Set(5, 100.0);
+    assert(SumOnly.MinMax().min_index == SIZE_MAX && SumOnly.Product().ToDouble() == 1.0 && SumOnly.Sum() > 100.0);
+    std::cout << "All incremental aggregate checks passed\n";
+}
+
+namespace
+{
+    // Builders must not keep a view of a temporary vector or array; spans, lvalues and expressions are fine
+    template <typename T>
+    concept DiffBuildable = requires(T&& operand) { Diff(std::forward<T>(operand)); };
+    template <typename A, typename B>
+    concept AddBuildable = requires(A&& a, B&& b) { Add(std::forward<A>(a), std::forward<B>(b)); };
+
+    static_assert(!DiffBuildable<std::vector<double>> && !DiffBuildable<std::array<double, 4>>);
+    static_assert(DiffBuildable<std::vector<double>&> && DiffBuildable<const std::vector<double>&> && DiffBuildable<std::span<const double>>);
+    static_assert(DiffBuildable<ExpressionView> && DiffBuildable<DiffExpression<ExpressionView>>);
+    static_assert(!AddBuildable<std::vector<double>&, std::vector<double>> && AddBuildable<std::vector<double>&, ExpressionView>);
+}
+
+void test19()
+{
+    std::cout << "\n---- Lazy expressions ---- Test 19 results: fused expressions vs. materializing every step ----\n" << std::endl;
+    const double eps = std::ldexp(1.0, -53);
+    for (std::size_t N : {0, 1, 2, 511, 512, 513, 100003}) {
+        std::vector<double> A = generate_random_vector(N, -1.0, 1.0), B = generate_random_vector(N + 3, 0.9, 1.1);
+        // Reference: every step into its own vector
+        std::vector<double> Diffs(N), Squares(N), Mixed(N);
+        std::adjacent_difference(A.begin(), A.end(), Diffs.begin());
+        for (std::size_t i = 0; i < N; ++i) {
+            Squares[i] = Diffs[i] * Diffs[i];
+            Mixed[i] = 2.0 * std::fabs(Diffs[i] + B[i]);
+        }
+        long double SquaresSum = 0.0L;
+        for (double x : Squares) {
+            SquaresSum += x;
+        }
+        for (unsigned int NumOfThreads : {1u, 3u}) {
+            ThreadPool pool(NumOfThreads);
+            for (ExpressionBackend backend : {ExpressionBackend::Scalar, ExpressionBackend::Simd, ExpressionBackend::MultiThread}) {
+                assert(std::fabs(Sum(Square(Diff(A)), backend, pool) - static_cast<double>(SquaresSum)) <= 4.0 * (N + 1) * eps * static_cast<double>(SquaresSum));
+                // Skip(.., 1) drops diff[0] = A[0]
+                const double TrueDiffs = N > 0 ? static_cast<double>(SquaresSum) - A[0] * A[0] : 0.0;
+                assert(std::fabs(Sum(Square(Skip(Diff(A), 1)), backend, pool) - TrueDiffs) <= 4.0 * (N + 1) * eps * static_cast<double>(SquaresSum) + 1e-300);
+                // Add takes the shorter size: B has 3 more elements
+                std::vector<double> Out;
+                Evaluate(2.0 * Abs(Diff(A) + View(B)), Out, backend, pool);
+                assert(Out == Mixed);
+                std::vector<double> Scaled(N);
+                assert(Evaluate(Scale(B, 0.5), std::span<double>(Scaled), backend, pool) == false);
+                assert(Evaluate(Skip(Scale(B, 0.5), 3), std::span<double>(Scaled), backend, pool));
+                for (std::size_t i = 0; i < N; ++i) {
+                    assert(Scaled[i] == 0.5 * B[i + 3]);
+                }
+                // Products of B scaled by 1e10 overflow a double beyond ~30 elements; the scaled product does not
+                const ScaledProduct Expected = ScaledProductOf(B.data(), B.size());
+                const ScaledProduct Scaled10 = ProductScaled(View(B) * 1e10, backend, pool);
+                assert(Scaled10.Sign() == Expected.Sign());
+                assert(std::fabs(Scaled10.LogAbs() - (Expected.LogAbs() + B.size() * std::log(1e10))) <= 1e-9 * (1.0 + std::fabs(Scaled10.LogAbs())));
+                if (N <= 2) {
+                    double Plain = 1.0;
+                    for (double x : B) {
+                        Plain *= 3.0 * x;
+                    }
+                    assert(close(Product(View(B) * 3.0, backend, pool), Plain));
+                }
+            }
+        }
+    }
+    std::cout << "All lazy expression checks passed\n";
+}
+
+
+void test20()
+{
+    std::cout << "\n---- Batched operations ---- Test 20 results: methods 38-40 vs. one SimpleVectorOperations per vector ----\n" << std::endl;
+    std::mt19937_64 generator(20);
+    for (std::size_t count : {0, 1, 7, 5000}) {
+        // Ragged sizes from 0 to 3000, a gap before the first vector and after the last
+        std::vector<std::size_t> offsets{3};
+        for (std::size_t i = 0; i < count; ++i) {
+            offsets.push_back(offsets.back() + (i % 50 == 0 ? 0 : generator() % (i % 7 == 0 ? 3000 : 200)));
+        }
+        std::vector<double> data = generate_random_vector(offsets.back() + 2, 0.99, 1.01);
+        for (unsigned int NumOfThreads : {1u, 3u}) {
+            ThreadPool pool(NumOfThreads);
+            BatchedVectorOperations batch(data, offsets, pool);
+            assert(batch.IsValid() && batch.size() == count);
+            std::vector<double> Sums, Products, Diffs;
+            batch.sums(Sums, false);
+            batch.products(Products, false);
+            batch.adjacent_differences(Diffs, false);
+            assert(Sums.size() == count && Products.size() == count && Diffs.size() == data.size());
+            assert(Diffs[0] == data[0] && Diffs.back() == data.back());
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::span<const double> vector(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+                SimpleVectorOperations operations(vector);
+                assert(Sums[i] == operations.sumSimd(false) && Products[i] == operations.productSimd(false));
+                std::vector<double> diff;
+                operations.adjacent_difference2(diff, false);
+                assert(std::equal(diff.begin(), diff.end(), Diffs.begin() + offsets[i]));
+            }
+        }
+    }
+    // Decreasing offsets or offsets past the data make the batch invalid, and empty
+    std::vector<double> data(10, 1.0), out;
+    for (std::vector<std::size_t> offsets : {std::vector<std::size_t>{0, 5, 4}, std::vector<std::size_t>{0, 11}}) {
+        BatchedVectorOperations batch(data, offsets);
+        batch.sums(out, false);
+        assert(!batch.IsValid() && batch.size() == 0 && out.empty());
+        batch.adjacent_differences(out, false);
+        assert(out.empty());
+    }
+    std::cout << "All batched operation checks passed\n";
+}
+
+
+void test21()
+{
+    std::cout << "\n---- Work stealing ---- Test 21 results: scheduler and methods 41-44 vs. methods 15-17 and 32 ----\n" << std::endl;
+    for (unsigned int NumOfThreads : {1u, 2u, 4u}) {
+        ThreadPool pool(NumOfThreads);
+        // Every chunk runs exactly once, also when one thread stalls on its first chunk and the others steal its deque
+        for (std::size_t NumOfChunks : {0, 1, 3, 1000}) {
+            std::vector<std::atomic<int>> Runs(NumOfChunks);
+            std::atomic<int> NestedCalls{0};
+            pool.ParallelForStealing(NumOfChunks, [&](std::size_t chunk) {
+                if (chunk == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    pool.ParallelForStealing(5, [&](std::size_t) { ++NestedCalls; });
+                }
+                ++Runs[chunk];
+                });
+            assert(std::all_of(Runs.begin(), Runs.end(), [](const std::atomic<int>& runs) { return runs == 1; }));
+            assert(NestedCalls == (NumOfChunks > 0 ? 5 : 0));
+        }
+        for (std::size_t N : {0, 1, 511, 513, 100003, 1000000}) {
+            std::vector<double> V = generate_random_vector(N, 0.999, 1.001);
+            MultiThreadVectorOperations MToperations{std::span<const double>(V), pool};
+            const double Sum = MToperations.ComputeSumWorkStealing(false);
+            assert(close(Sum, MToperations.ComputeSumThreadPool(false), 1e-9 * (N + 1)));
+            assert(Sum == MToperations.ComputeSumWorkStealing(false)); // same bits whatever thread ran each chunk
+            assert(close(MToperations.ComputeProductWorkStealing(false), MToperations.ComputeProductThreadPool(false), 1e-9));
+            std::vector<double> Expected, Out;
+            MToperations.ComputeInclusiveScanThreadPool(Expected, 2.0, false);
+            MToperations.ComputeInclusiveScanWorkStealing(Out, 2.0, false);
+            assert(Out.size() == N);
+            for (std::size_t i = 0; i < N; ++i) {
+                assert(std::fabs(Out[i] - Expected[i]) <= 1e-12 * Expected[i]);
+            }
+            Expected.assign(N, 0.0);
+            MToperations.ComputeAdjDiffThreadPool(Expected, false);
+            MToperations.ComputeAdjDiffWorkStealing(Out, false);
+            assert(Out == Expected);
+        }
+    }
+    std::cout << "All work stealing checks passed\n";
+}
+
+
+void test22()
+{
+    std::cout << "\n---- NUMA placement ---- Test 22 results: NumaVector and methods 45, 46 vs. methods 15, 17 ----\n" << std::endl;
+    const NumaTopology& host = NumaTopology::Host();
+    assert(host.NumOfNodes() >= 1 && host.Cpus().size() == host.NumOfCpus() && host.CurrentNode() < host.NumOfNodes());
+    // A made-up two-node machine whose nodes share the host's CPUs, to cover the split on a single-node host
+    NumaTopology TwoNodes;
+    TwoNodes.NodeCpus = {host.Cpus(), host.Cpus()};
+    TwoNodes.NodeIds = {0, 0};
+    TwoNodes.CpuNode.assign(1024, 1);
+    ThreadPool pool(3, host.Cpus());
+    for (const NumaTopology* topology : {&host, static_cast<const NumaTopology*>(&TwoNodes)}) {
+        for (std::size_t N : {0, 1, 8191, 8193, 600000}) {
+            std::vector<double> V = generate_random_vector(N, 0.5, 1.5);
+            NumaVector copy(std::span<const double>(V), pool, *topology), generated(N, pool, *topology), diff(N, pool, *topology);
+            assert(copy.size() == N && std::equal(V.begin(), V.end(), copy.data()));
+            assert(std::all_of(generated.data(), generated.data() + N, [](double x) { return x == 0.0; }));
+            generated.Generate([&](std::size_t i) { return V[i]; }, pool);
+            assert(std::equal(V.begin(), V.end(), generated.data()));
+            NumaVector direct(N, [&](std::size_t i) { return V[i]; }, pool, *topology);
+            assert(std::equal(V.begin(), V.end(), direct.data()));
+            assert(copy.NodeBegin(0) == 0 && copy.NodeBegin(topology->NumOfNodes()) == N);
+            for (std::size_t node = 0; node < topology->NumOfNodes(); ++node) {
+                assert(copy.NodeBegin(node) <= copy.NodeBegin(node + 1) && copy.NodeBegin(node) % NumaVector::NodeAlignment == 0);
+            }
+            // The parts start on 2 MiB boundaries in memory, not only as offsets
+            assert(N == 0 || reinterpret_cast<std::uintptr_t>(copy.data()) % (NumaVector::NodeAlignment * sizeof(double)) == 0);
+            if (topology == &TwoNodes && N == 600000) {
+                assert(copy.NodeBegin(1) == 262144);
+            }
+            NumaVectorOperations numa(copy, pool);
+            MultiThreadVectorOperations MToperations{std::span<const double>(V), pool};
+            assert(close(numa.sum(false), MToperations.ComputeSumThreadPool(false), 1e-9 * (N + 1)));
+            assert(numa.sum(false) == numa.sum(false));
+            std::vector<double> Expected(N);
+            MToperations.ComputeAdjDiffThreadPool(Expected, false);
+            assert(numa.adjacent_difference(diff, false) && std::equal(Expected.begin(), Expected.end(), diff.data()));
+            NumaVector wrong(N + 1, pool, *topology);
+            assert(!numa.adjacent_difference(wrong, false));
+        }
+    }
+    std::cout << "All NUMA placement checks passed (" << host.NumOfNodes() << " node(s), " << host.NumOfCpus() << " CPU(s))\n";
+}
+
+
+namespace
+{
+    // Minimal coroutine type for test23: starts at once, nothing to return
+    struct DetachedCoroutine {
+        struct promise_type {
+            DetachedCoroutine get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    DetachedCoroutine AwaitSum(AsyncJob<double> job, std::optional<double>& result, std::atomic<bool>& finished) {
+        result = co_await job;
+        finished = true;
+    }
+}
+
+void test23()
+{
+    std::cout << "\n---- Asynchronous operations ---- Test 23 results: methods 47-49, batching, cancellation, coroutines ----\n" << std::endl;
+    ThreadPool pool(3);
+    for (std::size_t N : {0, 1, 513, 1000000}) {
+        std::vector<double> V = generate_random_vector(N, 0.999, 1.001), W = generate_random_vector(N);
+        MultiThreadVectorOperations MToperations{std::span<const double>(V), pool};
+        std::vector<double> Expected(N), Diff1(N), Diff2(N);
+        MToperations.ComputeAdjDiffThreadPool(Expected, false);
+        AsyncVectorOperations async(pool);
+        // Jobs queued together on the same input share one pass; another input gets its own
+        async.Pause();
+        AsyncJob<double> Sum = async.sum(V), Product = async.product(V), Other = async.sum(W);
+        AsyncJob<bool> Written1 = async.adjacent_difference(V, Diff1), Written2 = async.adjacent_difference(V, Diff2);
+        assert(!Sum.Ready() && async.Passes() == 0);
+        async.Resume();
+        assert(Sum.Get() && close(*Sum.Get(), MToperations.ComputeSumWorkStealing(false), 1e-9 * (N + 1)));
+        assert(Product.Get() && close(*Product.Get(), MToperations.ComputeProductWorkStealing(false), 1e-9));
+        assert(Other.Get() && close(*Other.Get(), std::accumulate(W.begin(), W.end(), 0.0), 1e-9 * (N + 1)));
+        assert(*Written1.Get() && *Written2.Get() && Diff1 == Expected && Diff2 == Expected);
+        // Two empty vectors are the same (null) input
+        const std::size_t Passes = V.data() == W.data() ? 1 : 2;
+        assert(async.Passes() == Passes);
+        // A wrong output size fails at once
+        std::vector<double> Short(N + 1);
+        AsyncJob<bool> Wrong = async.adjacent_difference(V, Short);
+        assert(Wrong.Ready() && Wrong.Get() == false);
+        // Jobs cancelled while queued finish without a pass
+        async.Pause();
+        AsyncJob<double> Cancelled = async.sum(V);
+        assert(Cancelled.Cancel());
+        async.Resume();
+        assert(!Cancelled.Get() && !Cancelled.Cancel());
+        std::optional<std::optional<double>> FromCallback;
+        Cancelled.OnComplete([&](std::optional<double> result) { FromCallback = result; });
+        assert(FromCallback && !*FromCallback && async.Passes() == Passes);
+        // Cancelling a running job: either outcome is fine, but it must finish
+        AsyncJob<double> Racing = async.sum(V);
+        Racing.Cancel();
+        Racing.Wait();
+        // Coroutines resume once the job finishes
+        std::optional<double> Awaited;
+        std::atomic<bool> finished{false};
+        AwaitSum(async.sum(V), Awaited, finished);
+        while (!finished) {
+            std::this_thread::yield();
+        }
+        assert(Awaited && close(*Awaited, *Sum.Get(), 1e-9 * (N + 1)));
+        // Destroying the object cancels what is still queued
+        std::optional<AsyncJob<double>> Orphan;
+        {
+            AsyncVectorOperations Dropped(pool);
+            Dropped.Pause();
+            Orphan = Dropped.sum(V);
+        }
+        assert(Orphan->Ready() && !Orphan->Get());
+    }
+    std::cout << "All asynchronous operation checks passed\n";
+}
+
+void test24()
+{
+    std::cout << "\n---- Rolling windows ---- Test 24 results: methods 50-55 and RollingWindow vs. every window recomputed ----\n" << std::endl;
+    const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+    ThreadPool one(1), three(3);
+    std::vector<double> V = generate_random_vector(1000, -2, 2);
+    for (std::size_t i = 0; i < V.size(); i += 37) {
+        V[i] = 0.0;
+    }
+    V[100] = inf;
+    V[101] = -inf;
+    V[300] = nan;
+    V[700] = 1e300;
+    // Equal, close, or both NaN (a window holding a NaN, or infinities of both signs)
+    auto Same = [](double a, double b, double epsilon) {
+        return (std::isnan(a) && std::isnan(b)) || a == b || close(a, b, epsilon);
+    };
+    for (std::size_t Window : {0, 1, 2, 7, 64, 65, 999, 1000, 1001}) {
+        const std::size_t NumOfWindows = Window == 0 || Window > V.size() ? 0 : V.size() - Window + 1;
+        for (ThreadPool* pool : {&one, &three}) {
+            RollingVectorOperations operations(V, *pool);
+            std::vector<double> Sums, Products, Min, Max, SumsMT, ProductsMT, MinMT, MaxMT;
+            operations.RollingSum(Window, Sums, false);
+            operations.RollingProduct(Window, Products, false);
+            operations.RollingMinMax(Window, Min, Max, false);
+            operations.RollingSumThreadPool(Window, SumsMT, false);
+            operations.RollingProductThreadPool(Window, ProductsMT, false);
+            operations.RollingMinMaxThreadPool(Window, MinMT, MaxMT, false);
+            assert(Sums.size() == NumOfWindows && Products.size() == NumOfWindows && Min.size() == NumOfWindows && Max.size() == NumOfWindows);
+            assert(SumsMT.size() == NumOfWindows && ProductsMT.size() == NumOfWindows && MinMT == Min && MaxMT == Max);
+            for (std::size_t j = 0; j < NumOfWindows; ++j) {
+                const auto first = V.begin() + j, last = first + Window;
+                CompensatedSum sum;
+                double product = 1.0, min = inf, max = -inf;
+                for (auto it = first; it != last; ++it) {
+                    sum.Add(*it);
+                    product *= *it;
+                    min = *it < min ? *it : min;
+                    max = *it > max ? *it : max;
+                }
+                assert(Same(Sums[j], sum.Result(), 1e-12 * Window) && Same(SumsMT[j], sum.Result(), 1e-12 * Window));
+                assert(Same(Products[j], product, 1e-9) && Same(ProductsMT[j], product, 1e-9));
+                // A product holding a zero is zero (or NaN with an infinity), whatever came before it
+                if (std::find(first, last, 0.0) != last && std::all_of(first, last, [](double x) { return std::isfinite(x); })) {
+                    assert(Products[j] == 0.0);
+                }
+                assert(Min[j] == min && Max[j] == max);
+            }
+        }
+        // Streaming: after every push the window holds the last Window values
+        if (Window == 0) {
+            continue;
+        }
+        RollingWindow window(Window);
+        std::vector<double> Sums, Products, Min, Max;
+        RollingVectorOperations operations(V);
+        operations.RollingSum(Window, Sums, false);
+        operations.RollingProduct(Window, Products, false);
+        operations.RollingMinMax(Window, Min, Max, false);
+        for (std::size_t i = 0; i < V.size(); ++i) {
+            window.Push(V[i]);
+            assert(window.size() == std::min(i + 1, Window) && window.Full() == (i + 1 >= Window));
+            if (window.Full()) {
+                const std::size_t j = i + 1 - Window;
+                assert(Same(window.Sum(), Sums[j], 1e-12 * Window) && Same(window.Product(), Products[j], 1e-9));
+                assert(window.Min() == Min[j] && window.Max() == Max[j]);
+            }
+        }
+    }
+    // A window of NaNs only has no min or max; a window of the whole vector is its plain sum
+    std::vector<double> NaNs(10, nan), Min, Max, Sums;
+    RollingVectorOperations(NaNs).RollingMinMax(3, Min, Max, false);
+    assert(Min.size() == 8 && Min[0] == inf && Max[0] == -inf);
+    std::vector<double> W = generate_random_vector(100000);
+    RollingVectorOperations(W).RollingSumThreadPool(W.size(), Sums, false);
+    assert(Sums.size() == 1 && close(Sums[0], std::accumulate(W.begin(), W.end(), 0.0), 1e-9 * W.size()));
+    std::cout << "All rolling window checks passed\n";
+}
+
+void test25()
+{
+    std::cout << "\n---- Exact summation ---- Test 25 results: methods 56 and 57 vs. sums known exactly ----\n" << std::endl;
+    const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+    const double Max = std::numeric_limits<double>::max(), Min = std::numeric_limits<double>::min(), TrueMin = std::numeric_limits<double>::denorm_min();
+    const double eps = std::ldexp(1.0, -53);
+    auto Exact = [](const std::vector<double>& V) { return SimpleVectorOperations(V).ExactSum(false); };
+    // Cancellation, ties to even, subnormals, overflow and special values
+    assert(Exact({}) == 0.0);
+    assert(Exact({1e100, 1.0, -1e100}) == 1.0);
+    assert(Exact({1.0, 1e100, 1.0, -1e100, 1e-100}) == 2.0);
+    assert(Exact({1.0, eps}) == 1.0);
+    assert(Exact({1.0, eps, eps * eps}) == 1.0 + 2 * eps);
+    assert(Exact({1.0 + 2 * eps, eps}) == 1.0 + 4 * eps);
+    assert(Exact({-1.0, -eps, -eps * eps}) == -1.0 - 2 * eps);
+    assert(Exact({TrueMin, TrueMin, TrueMin}) == 3 * TrueMin);
+    assert(Exact({Min, -TrueMin}) == Min - TrueMin);
+    assert(Exact({Max, Max}) == inf && Exact({-Max, -Max}) == -inf);
+    assert(Exact({Max, Max, -Max}) == Max);
+    assert(Exact({inf, 1.0}) == inf && std::isnan(Exact({inf, -inf})) && std::isnan(Exact({1.0, nan})));
+    // Sums of k * 2^e, with k < 2^53 and |e| <= 20, are exact in 128-bit integers of 2^-20 units
+    std::mt19937_64 engine(25);
+    std::uniform_int_distribution<long long> Mantissas(-(1LL << 53) + 1, (1LL << 53) - 1);
+    std::uniform_int_distribution<int> Exponents(-20, 20);
+    for (std::size_t N : {1, 15, 16, 17, 100003}) {
+        std::vector<double> V(N);
+        __int128 units = 0;
+        for (double& x : V) {
+            const long long k = Mantissas(engine);
+            const int e = Exponents(engine);
+            x = std::ldexp(static_cast<double>(k), e);
+            units += static_cast<__int128>(k) << (e + 20);
+        }
+        const double Expected = std::ldexp(static_cast<double>(units), -20);
+        SimpleVectorOperations operations(V);
+        assert(operations.ExactSum(false) == Expected);
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            Superaccumulator acc;
+            GetSimdKernels(level).superaccumulate(V.data(), N, acc);
+            assert(acc.Result() == Expected);
+        }
+        for (unsigned int NumOfThreads : {1u, 3u, 8u}) {
+            ThreadPool pool(NumOfThreads);
+            assert(MultiThreadVectorOperations(V, pool).ComputeExactSumThreadPool(false) == Expected);
+        }
+        // Any order and any split, merged in any order
+        std::shuffle(V.begin(), V.end(), engine);
+        assert(Exact(V) == Expected);
+        Superaccumulator left = SuperaccumulatorOf(V.data(), N / 3), right = SuperaccumulatorOf(V.data() + N / 3, N - N / 3);
+        right.Merge(left);
+        assert(right.Result() == Expected);
+        // Large elements, which skip the SIMD expansions, and a NaN anywhere
+        V.insert(V.begin() + N / 2, 1e300);
+        V.insert(V.begin() + N / 4, -1e300);
+        V.push_back(Max);
+        V.insert(V.begin(), -Max);
+        assert(Exact(V) == Expected);
+        V[V.size() / 3] = nan;
+        assert(std::isnan(Exact(V)));
+    }
+    // The other summation methods stay within their error bounds of the exact sum
+    std::vector<double> W = generate_random_vector(1000000, -1.0, 1.0);
+    SimpleVectorOperations operations(W);
+    const double Reference = operations.ExactSum(false);
+    assert(std::fabs(operations.KahanSummation(false) - Reference) <= 2 * eps * std::fabs(Reference) + 1e-20);
+    assert(std::fabs(operations.NeumaierSummationSimd(false) - Reference) <= 2 * eps * std::fabs(Reference) + 1e-20);
+    assert(std::fabs(operations.sum1(false) - Reference) <= 2 * eps * W.size() * std::accumulate(W.begin(), W.end(), 0.0, [](double a, double x) { return a + std::fabs(x); }));
+    std::cout << "All exact summation checks passed\n";
+}
+
+void test26()
+{
+    std::cout << "\n---- Benchmark harness ---- Test 26 results: statistics, stopping rule, CSV baseline and compare mode ----\n" << std::endl;
+    assert(Quantile({}, 0.5) == 0.0);
+    assert(Quantile({3, 1, 2}, 0.5) == 2.0 && Quantile({4, 1, 3, 2}, 0.5) == 2.5);
+    assert(Quantile({1, 2, 3, 4, 5}, 0.0) == 1.0 && Quantile({1, 2, 3, 4, 5}, 1.0) == 5.0 && Quantile({1, 2, 3, 4, 5}, 0.95) == 4.8);
+    assert(RelativeErrorOfMedian({5.0}) == 0.0 && RelativeErrorOfMedian({7, 7, 7, 7}) == 0.0);
+    // Error shrinks with the number of samples and ignores a single outlier
+    std::vector<double> Few = {99, 101, 100, 98, 102}, Many;
+    for (int k = 0; k < 20; ++k) {
+        Many.insert(Many.end(), Few.begin(), Few.end());
+    }
+    assert(RelativeErrorOfMedian(Many) < RelativeErrorOfMedian(Few));
+    Few.push_back(1e9);
+    assert(RelativeErrorOfMedian(Few) < 0.05);
+
+    // A cheap steady case becomes stable; a budget of zero stops after one sample
+    std::vector<double> V = generate_random_vector(4096);
+    volatile double sink = 0.0;
+    BenchmarkCase sum{"sum_simd", V.size(), 1, V.size() * sizeof(double), [&] { sink = SimpleVectorOperations(V).sumSimd(false); }};
+    BenchmarkOptions options;
+    options.RelativePrecision = 0.05;
+    BenchmarkResult r = RunBenchmark(sum, options);
+    assert(r.samples >= options.MinSamples && r.samples <= options.MaxSamples && r.cache == "hot");
+    assert(r.min_ns > 0 && r.min_ns <= r.median_ns && r.median_ns <= r.p95_ns);
+    assert(close(r.gb_per_s, 4096 * 8 / r.median_ns) && close(r.elements_per_ns, 4096 / r.median_ns));
+    options.MaxSeconds = 0.0;
+    options.FlushCache = true;
+    options.FlushBytes = 1 << 20;
+    BenchmarkResult once = RunBenchmark(sum, options);
+    assert(once.samples == 1 && once.cache == "cold" && !once.stable);
+    (void)sink;
+
+    // CSV round trip, then the compare mode
+    const std::string path = "test26_baseline.csv";
+    BenchmarkResult slow = r, noisy = r, missing = r;
+    slow.name = "slow";
+    noisy.name = "noisy";
+    missing.name = "missing";
+    std::vector<BenchmarkResult> baseline = {r, slow, noisy};
+    {
+        std::ofstream file(path);
+        WriteBenchmarkCsv(file, baseline);
+    }
+    std::vector<BenchmarkResult> Read;
+    assert(ReadBenchmarkCsv(path, Read) && Read.size() == 3);
+    for (std::size_t i = 0; i < Read.size(); ++i) {
+        assert(Read[i].Key() == baseline[i].Key() && Read[i].samples == baseline[i].samples && Read[i].stable == baseline[i].stable);
+        assert(close(Read[i].median_ns, baseline[i].median_ns, 1e-6 * baseline[i].median_ns));
+    }
+    {
+        std::ofstream file(path);
+        file << "not,a,benchmark\n";
+    }
+    assert(!ReadBenchmarkCsv(path, Read) && Read.size() == 3);
+    std::remove(path.c_str());
+    std::ostringstream json;
+    WriteBenchmarkJson(json, baseline);
+    assert(json.str().front() == '[' && json.str().find("\"name\": \"slow\"") != std::string::npos);
+
+    slow.median_ns *= 2;
+    noisy.median_ns *= 1.2;
+    noisy.relative_error = 0.2;
+    std::vector<BenchmarkComparison> comparisons = CompareBenchmarks(baseline, {r, slow, noisy, missing}, 0.05);
+    assert(comparisons.size() == 3);
+    assert(!comparisons[0].regression && comparisons[0].ratio == 1.0);
+    assert(comparisons[1].regression && close(comparisons[1].ratio, 2.0));
+    assert(!comparisons[2].regression);
+    std::cout << "All benchmark harness checks passed\n";
+}
+
+void test27()
+{
+    std::cout << "\n---- Performance counters ---- Test 27 results: profile summaries, profiled methods and their thread spans, counter CSV columns ----\n" << std::endl;
+    // Profile summaries on hand-made spans: the caller's own tasks are already in its counters
+    MethodProfile made;
+    made.thread = 1;
+    made.counts = PerfCounts{100, 200, 3, 4, true};
+    made.spans = {{0, 1, 10, 50, PerfCounts{10, 20, 1, 1, true}}, {1, 2, 30, 90, PerfCounts{40, 80, 2, 2, true}}, {2, 3, 20, 70, PerfCounts{50, 100, 3, 3, true}}};
+    assert(made.StartupNs() == 30 && made.SkewNs() == 40);
+    PerfCounts total = made.TotalCounts();
+    assert(total.valid && total.cycles == 190 && total.instructions == 380 && total.llc_misses == 8 && total.branch_misses == 9);
+    assert(close(total.InstructionsPerCycle(), 2.0));
+    made.spans[2].counts.valid = false;
+    assert(!made.TotalCounts().valid);
+    assert(MethodProfile().StartupNs() == 0 && MethodProfile().SkewNs() == 0);
+
+    std::vector<double> V = generate_random_vector(100000);
+    std::vector<double> diff(V.size()), expected_diff(V.size());
+    ThreadPool pool(3);
+    MultiThreadVectorOperations operations(V, pool);
+    operations.SetNumOfSpawnedThreads(2);
+    const bool WasEnabled = Profiler::Enabled();
+    Profiler::Enable(false);
+    const double expected = operations.ComputeSumThreadPool(false);
+    SimpleVectorOperations(V).adjacent_difference2(expected_diff, false);
+    Profiler::TakeRecords();
+
+    // Profiled methods return the same results
+    Profiler::Enable(true);
+    SimpleVectorOperations(V).sumSimd(false);
+    assert(operations.ComputeSumThreadPool(false) == expected);
+    operations.ComputeAdjDiffMultiThread1(diff, false);
+    assert(diff == expected_diff);
+    std::vector<MethodProfile> records = Profiler::TakeRecords();
+    Profiler::Enable(false);
+    SimpleVectorOperations(V).sumSimd(false);
+    assert(Profiler::TakeRecords().empty());
+    Profiler::Enable(WasEnabled);
+#ifdef VECTOROPERATIONS_PERF
+    assert(records.size() == 3);
+    assert(records[0].method == "sumSimd" && records[0].spans.empty());
+    assert(records[1].method == "ComputeSumThreadPool" && records[1].spans.size() == 3);
+    assert(records[2].method == "ComputeAdjDiffMultiThread1" && records[2].spans.size() == 2);
+    for (const MethodProfile& profile : records) {
+        assert(profile.wall_ns > 0 && profile.StartupNs() <= profile.wall_ns && profile.SkewNs() <= profile.wall_ns);
+        std::vector<bool> seen(profile.spans.size(), false);
+        for (const ThreadSpan& span : profile.spans) {
+            assert(span.task < seen.size() && !seen[span.task]);
+            seen[span.task] = true;
+            assert(0 <= span.start_ns && span.start_ns <= span.finish_ns && span.finish_ns <= profile.wall_ns);
+            // Spawned threads never run on the caller; counters are there on every thread or on none
+            assert(profile.method != "ComputeAdjDiffMultiThread1" || span.thread != profile.thread);
+            assert(span.counts.valid == profile.counts.valid);
+        }
+        if (profile.counts.valid) {
+            assert(profile.counts.instructions > 0 && profile.TotalCounts().instructions >= profile.counts.instructions);
+        }
+    }
+    std::cout << "Profiler: " << (records[0].counts.valid ? "hardware counters available\n" : "no hardware counters (perf events not allowed)\n");
+#else
+    assert(records.empty() && !Profiler::Enabled());
+#endif
+
+    // Counter columns of the benchmark CSV, and a CSV from before them still read
+    BenchmarkResult r;
+    r.name = "sum";
+    r.median_ns = 100;
+    r.counts = PerfCounts{1000, 3000, 5, 7, true};
+    r.startup_ns = 11;
+    r.skew_ns = 13;
+    const std::string path = "test27_counters.csv";
+    {
+        std::ofstream file(path);
+        WriteBenchmarkCsv(file, {r});
+    }
+    std::vector<BenchmarkResult> Read;
+    assert(ReadBenchmarkCsv(path, Read) && Read.size() == 1);
+    assert(Read[0].counts.valid && Read[0].counts.cycles == 1000 && Read[0].counts.instructions == 3000);
+    assert(Read[0].counts.llc_misses == 5 && Read[0].counts.branch_misses == 7 && Read[0].startup_ns == 11 && Read[0].skew_ns == 13);
+    {
+        std::ofstream file(path);
+        file << "name,elements,threads,cache,samples,median_ns,p95_ns,min_ns,relative_error,gb_per_s,elements_per_ns,stable\n"
+            << "sum,0,1,hot,1,100,100,100,0,0,0,1\n";
+    }
+    assert(ReadBenchmarkCsv(path, Read) && Read.size() == 1 && !Read[0].counts.valid && Read[0].median_ns == 100);
+    std::remove(path.c_str());
+    std::cout << "All profiler checks passed\n";
+}
+
+void test28()
+{
+    std::cout << "\n---- Output buffers ---- Test 28 results: aligned buffers, arena reuse, streaming kernels and methods 58-60 vs. method 7 ----\n" << std::endl;
+    // Aligned buffers: cache line alignment, huge page alignment from 2 MiB, memory kept when shrinking
+    AlignedBuffer small(3);
+    assert(small.size() == 3 && small.capacity() >= 3 && reinterpret_cast<std::uintptr_t>(small.data()) % AlignedBuffer::Alignment == 0);
+    const double* memory = small.data();
+    small.resize(1);
+    assert(small.size() == 1 && small.data() == memory);
+    AlignedBuffer huge(AlignedBuffer::HugePageBytes / sizeof(double) + 1);
+    assert(huge.HugePages() && !small.HugePages() && reinterpret_cast<std::uintptr_t>(huge.data()) % AlignedBuffer::HugePageBytes == 0);
+    AlignedBuffer moved = std::move(small);
+    assert(moved.data() == memory && small.data() == nullptr && small.size() == 0);
+
+    // Arena: a returned buffer is handed out again, the smallest that fits first, and only growth allocates
+    BufferArena arena;
+    const double* first;
+    {
+        BufferArena::Lease a = arena.Acquire(1000);
+        first = a.data();
+        assert(a.size() == 1000 && arena.IdleBuffers() == 0);
+    }
+    assert(arena.IdleBuffers() == 1 && arena.Allocations() == 1);
+    {
+        BufferArena::Lease a = arena.Acquire(500);
+        BufferArena::Lease b = arena.Acquire(100);
+        assert(a.data() == first && a.size() == 500 && b.data() != first && arena.Allocations() == 2);
+    }
+    {
+        BufferArena::Lease b = arena.Acquire(100);
+        assert(b.data() != first && arena.Allocations() == 2);
+        BufferArena::Lease c = std::move(b);
+        assert(c.size() == 100 && arena.IdleBuffers() == 1);
+    }
+    for (int call = 0; call < 10; ++call) {
+        BufferArena::Lease a = arena.Acquire(1000);
+        assert(a.data() == first);
+    }
+    assert(arena.Allocations() == 2 && arena.IdleBuffers() == 2);
+    { BufferArena::Lease grown = arena.Acquire(5000); }
+    assert(arena.Allocations() == 3);
+    arena.Trim();
+    assert(arena.IdleBuffers() == 0);
+
+    // Streaming kernels give the same bits as the plain ones whatever the output alignment
+    std::vector<double> V = generate_random_vector(200, -1, 1);
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        const SimdKernels& kernels = GetSimdKernels(level);
+        for (std::size_t offset = 0; offset < 8; ++offset) {
+            for (std::size_t size : {0, 1, 2, 7, 8, 9, 31, 64, 193}) {
+                AlignedBuffer plain(size + 8), streamed(size + 8);
+                std::fill(plain.data(), plain.data() + size + 8, -7.0);
+                std::fill(streamed.data(), streamed.data() + size + 8, -7.0);
+                kernels.adjacent_difference(V.data(), size, plain.data() + offset);
+                kernels.adjacent_difference_stream(V.data(), size, streamed.data() + offset);
+                assert(std::memcmp(plain.data(), streamed.data(), (size + 8) * sizeof(double)) == 0);
+            }
+        }
+    }
+
+    // Methods 58-60 match method 7, and refuse a buffer of the wrong size
+    std::vector<double> W = generate_random_vector(100003), expected;
+    SimpleVectorOperations(W).adjacent_difference2(expected, false);
+    AlignedBuffer out(W.size());
+    assert(SimpleVectorOperations(W).adjacent_differenceInto(out.span(), false));
+    assert(std::equal(expected.begin(), expected.end(), out.data()));
+    std::vector<double> unaligned(W.size() + 1);
+    assert(SimpleVectorOperations(W).adjacent_differenceInto(std::span<double>(unaligned).subspan(1), false));
+    assert(std::equal(expected.begin(), expected.end(), unaligned.begin() + 1));
+    assert(!SimpleVectorOperations(W).adjacent_differenceInto(std::span<double>(unaligned), false));
+    assert(SimpleVectorOperations(std::vector<double>()).adjacent_differenceInto(std::span<double>(), false));
+    {
+        BufferArena::Lease diff = SimpleVectorOperations(W).adjacent_differenceArena(arena, false);
+        assert(diff.size() == W.size() && std::equal(expected.begin(), expected.end(), diff.data()));
+    }
+    for (unsigned int threads : {1u, 3u, 8u}) {
+        ThreadPool pool(threads);
+        std::fill(out.data(), out.data() + out.size(), 0.0);
+        assert(MultiThreadVectorOperations(W, pool).ComputeAdjDiffThreadPoolInto(out.span(), false));
+        assert(std::equal(expected.begin(), expected.end(), out.data()));
+        assert(!MultiThreadVectorOperations(W, pool).ComputeAdjDiffThreadPoolInto(std::span<double>(unaligned), false));
+    }
+
+    // Method 6 still appends to what diff holds
+    std::vector<double> appended = {42.0};
+    SimpleVectorOperations(W).adjacent_difference1(appended, false);
+    assert(appended.size() == W.size() && appended[0] == 42.0 && std::equal(expected.begin() + 1, expected.end(), appended.begin() + 1));
+    std::cout << "All output buffer checks passed\n";
+}
+
+void test29()
+{
+    std::cout << "\n---- Sharded operations ---- Test 29 results: methods 61-64 on worker processes vs. methods 7, 15, 16 and 23 ----\n" << std::endl;
+    std::vector<double> V = generate_random_vector(300007, -1, 1);
+    ThreadPool pool(3);
+    MultiThreadVectorOperations threads(V, pool);
+    std::vector<double> expected_diff;
+    SimpleVectorOperations(V).adjacent_difference2(expected_diff, false);
+
+    // Shared vectors: a copy in shared memory, zeros, or a vector file mapped read-only
+    SharedVector data(V), zeros(V.size());
+    assert(data.IsValid() && data.size() == V.size() && std::equal(V.begin(), V.end(), data.data().begin()));
+    assert(zeros.IsValid() && zeros.MutableData().size() == V.size() && zeros.data()[V.size() - 1] == 0.0);
+    const std::string path = "test29_vector.bin";
+    assert(WriteVectorFile<double>(path, V));
+    SharedVector file(path);
+    assert(file.IsValid() && file.size() == V.size() && file.MutableData().empty() && std::equal(V.begin(), V.end(), file.data().begin()));
+    assert(!SharedVector("test29_missing.bin").IsValid());
+
+    // Methods 61-64 give the bits of the thread pool methods with as many threads, from memory or from the file
+    ShardWorkers workers(3, ShardWorkerOptions{500, 2});
+    ShardedVectorOperations sharded(data, workers);
+    assert(sharded.ComputeSum(false) == threads.ComputeSumThreadPool(false));
+    assert(sharded.ComputeCompensatedSum(false) == threads.ComputeCompensatedSumThreadPool(false));
+    assert(sharded.ComputeProduct(false) == threads.ComputeProductThreadPool(false));
+    assert(sharded.ComputeAdjDiff(zeros, false) && std::equal(expected_diff.begin(), expected_diff.end(), zeros.data().begin()));
+    assert(ShardedVectorOperations(file, workers).ComputeSum(false) == threads.ComputeSumThreadPool(false));
+    SharedVector wrong(V.size() - 1);
+    assert(!sharded.ComputeAdjDiff(wrong, false) && !sharded.ComputeAdjDiff(file, false));
+    std::remove(path.c_str());
+
+    // Fewer elements than workers, and none
+    SharedVector pair(std::vector<double>{2.0, 5.0}), empty(std::size_t(0)), pair_diff(2);
+    assert(ShardedVectorOperations(pair, workers).ComputeSum(false) == 7.0 && ShardedVectorOperations(pair, workers).ComputeProduct(false) == 10.0);
+    assert(ShardedVectorOperations(pair, workers).ComputeAdjDiff(pair_diff, false) && pair_diff.data()[0] == 2.0 && pair_diff.data()[1] == 3.0);
+    assert(ShardedVectorOperations(empty, workers).ComputeSum(false) == 0.0 && ShardedVectorOperations(empty, workers).ComputeProduct(false) == 1.0);
+    assert(workers.WorkersReplaced() == 0 && workers.ShardsComputedLocally() == 0);
+
+    // A killed worker and a hung one are replaced, and the results do not change
+    const pid_t killed = workers.WorkerPid(1);
+    kill(killed, SIGKILL);
+    assert(sharded.ComputeSum(false) == threads.ComputeSumThreadPool(false));
+    assert(workers.WorkersReplaced() == 1 && workers.WorkerPid(1) != killed);
+    kill(workers.WorkerPid(2), SIGSTOP);
+    std::fill(zeros.MutableData().begin(), zeros.MutableData().end(), 0.0);
+    assert(sharded.ComputeAdjDiff(zeros, false) && std::equal(expected_diff.begin(), expected_diff.end(), zeros.data().begin()));
+    assert(workers.WorkersReplaced() == 2 && workers.ShardsComputedLocally() == 0);
+    assert(sharded.ComputeCompensatedSum(false) == threads.ComputeCompensatedSumThreadPool(false));
+
+    // Callers sharing the workers from several threads run one at a time, and each gets the replies to its own requests
+    std::vector<double> results(8);
+    std::vector<std::thread> callers;
+    for (std::size_t t = 0; t < results.size(); ++t) {
+        callers.emplace_back([&, t] { results[t] = t % 2 ? sharded.ComputeCompensatedSum(false) : sharded.ComputeSum(false); });
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    for (std::size_t t = 0; t < results.size(); ++t) {
+        assert(results[t] == (t % 2 ? threads.ComputeCompensatedSumThreadPool(false) : threads.ComputeSumThreadPool(false)));
+    }
+    assert(workers.WorkersReplaced() == 2 && workers.ShardsComputedLocally() == 0);
+
+    // Workers forked by a thread that has since exited keep serving, as they only exit at end of file on their socket.
+    // The thread makes a call first, so both workers have started before it exits.
+    ThreadPool two(2);
+    std::optional<ShardWorkers> forked;
+    double forked_sum = 0.0;
+    std::thread([&] { forked.emplace(2); forked_sum = ShardedVectorOperations(data, *forked).ComputeSum(false); }).join();
+    const pid_t survivor = forked->WorkerPid(0);
+    assert(forked_sum == MultiThreadVectorOperations(V, two).ComputeSumThreadPool(false));
+    assert(ShardedVectorOperations(data, *forked).ComputeSum(false) == forked_sum);
+    assert(forked->WorkersReplaced() == 0 && forked->ShardsComputedLocally() == 0 && forked->WorkerPid(0) == survivor);
+
+    // With no attempts left on workers, the coordinator computes every shard itself
+    ShardWorkers none(2, ShardWorkerOptions{500, 0});
+    assert(ShardedVectorOperations(data, none).ComputeSum(false) == MultiThreadVectorOperations(V, two).ComputeSumThreadPool(false));
+    assert(none.ShardsComputedLocally() == 2 && none.WorkersReplaced() == 0);
+    std::cout << "All sharded operation checks passed\n";
+}
+
+namespace
+{
+    // Constant expressions for test30: a Kahan sum that differs from the plain one, and an adjacent difference
+    constexpr std::array<double, 3> KahanCase = {1e16, 1.0, 1.0};
+    constexpr std::array<double, 4> Ramp = {1.0, 3.0, 6.0, 10.0};
+
+    constexpr std::array<double, 4> RampDifference() {
+        std::array<double, 4> diff{};
+        FixedVectorOperations(Ramp).adjacent_difference2(diff, false);
+        return diff;
+    }
+
+    static_assert(FixedVectorOperations(Ramp).sum1(false) == 20.0 && FixedVectorOperations(Ramp).product2(false) == 180.0);
+    static_assert(FixedVectorOperations(KahanCase).sum2(false) == 1e16 && FixedVectorOperations(KahanCase).KahanSummation(false) == 1e16 + 2.0);
+    static_assert(RampDifference() == std::array<double, 4>{1.0, 2.0, 3.0, 4.0});
+    static_assert(FixedVectorOperations(std::array<double, 0>{}).sum1(false) == 0.0 && FixedVectorOperations(std::array<double, 0>{}).product1(false) == 1.0);
+    static_assert(std::is_same_v<decltype(MakeVectorOperations(Ramp)), FixedVectorOperations<4>>);
+    static_assert(std::is_same_v<decltype(MakeVectorOperations(std::span<const double, 4>(Ramp))), FixedVectorOperations<4>>);
+    static_assert(std::is_same_v<decltype(MakeVectorOperations(std::span<const double>(Ramp))), SimpleVectorOperations>);
+    static_assert(std::is_same_v<decltype(MakeVectorOperations(std::array<double, FixedVectorMaxSize + 1>{})), SimpleVectorOperations>);
+
+    // Every fixed-size method against its SimpleVectorOperations counterpart, bit for bit
+    template <std::size_t N>
+    void CheckFixedAgainstSimple(const std::array<double, N>& V) {
+        const FixedVectorOperations<N> fixed = MakeVectorOperations(V);
+        const SimpleVectorOperations simple(std::vector<double>(V.begin(), V.end()));
+        assert(fixed.sum1(false) == simple.sum1(false));
+        assert(fixed.sum2(false) == simple.sum2(false));
+        assert(fixed.KahanSummation(false) == simple.KahanSummation(false));
+        assert(fixed.product1(false) == simple.product1(false));
+        assert(fixed.product2(false) == simple.product2(false));
+        std::array<double, N> diff;
+        std::vector<double> expected;
+        fixed.adjacent_difference2(diff, false);
+        simple.adjacent_difference2(expected, false);
+        assert(std::equal(diff.begin(), diff.end(), expected.begin(), expected.end()));
+    }
+
+    template <std::size_t N>
+    std::array<double, N> RandomArray(double a, double b) {
+        const std::vector<double> V = generate_random_vector(N, a, b);
+        std::array<double, N> values{};
+        std::copy(V.begin(), V.end(), values.begin());
+        return values;
+    }
+}
+
+void test30()
+{
+    std::cout << "\n---- Fixed-size vectors ---- Test 30 results: constexpr unrolled kernels vs. methods 1-5 and 7 ----\n" << std::endl;
+    // The data of tests 1-3
+    CheckFixedAgainstSimple(std::array<double, 7>{-17.3401, 2.01, -3.01, 4.10, -5.07, 6.70, -7.01});
+    CheckFixedAgainstSimple(std::array<double, 20>{91.27, -8.873, -36.07, -17.14, 45.57, 52.20, -98.25, 78.38, -70.11, -79.78, 90.97, -88.55, -23.21, -50.60, 14.80, -67.67, -49.44, 98.45, -76.33, -86.13});
+    CheckFixedAgainstSimple(std::array<double, 20>{1.27, -0.00873, -6.017, -1017.14, 0.59, 12.000105, -0.1225, 781.308, -7.1, -9.3, -0.102, -0.515, -232.201, -510.660, 104.080, -607.657, -41.0404, 8.41, -7.38, -6.15});
+    CheckFixedAgainstSimple(RandomArray<1>(-1.0, 1.0));
+    CheckFixedAgainstSimple(RandomArray<2>(-1.0, 1.0));
+    CheckFixedAgainstSimple(RandomArray<33>(-1e8, 1e8));
+    CheckFixedAgainstSimple(RandomArray<FixedVectorMaxSize>(0.5, 2.0));
+
+    // A fixed-extent span is copied, and a vector still gets SimpleVectorOperations through the same call
+    std::array<double, 7> V = {-17.3401, 2.01, -3.01, 4.10, -5.07, 6.70, -7.01};
+    const auto fixed = MakeVectorOperations(std::span<const double, 7>(V));
+    V.fill(0.0);
+    assert(close(fixed.sum1(false), -19.6201) && close(fixed.product1(false), 102423.30544585084));
+    const std::vector<double> W = {1.0, 3.0, 6.0, 10.0};
+    const SimpleVectorOperations simple = MakeVectorOperations(W);
+    assert(simple.IsView() && simple.sum1(false) == FixedVectorOperations(Ramp).sum1(false));
+    // Temporaries are copied rather than viewed, so nothing dangles once the statement ends
+    const SimpleVectorOperations owning = MakeVectorOperations(std::vector<double>{1.0, 3.0, 6.0, 10.0});
+    std::array<double, FixedVectorMaxSize + 1> Long;
+    Long.fill(0.5);
+    const SimpleVectorOperations copied = MakeVectorOperations(std::array<double, FixedVectorMaxSize + 1>(Long));
+    assert(!owning.IsView() && owning.sum1(false) == 20.0);
+    assert(!copied.IsView() && copied.sum1(false) == 0.5 * Long.size());
+    assert(MakeVectorOperations(Long).IsView());
+
+    std::cout << "(Method 1) The time it takes for the fixed-size summation (N = 7):";
+    std::cout << "Result of the summation:" << fixed.sum1() << "\n";
+    std::cout << "(Method 3) The time it takes for the fixed-size compensated summation (N = 7):";
+    std::cout << "Result of the summation:" << fixed.KahanSummation() << "\n";
+    std::cout << "All fixed-size vector checks passed\n";
+}
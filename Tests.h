@@ -17,4 +17,29 @@ void test2();
 void test3();
 void test4();
 void test5();
+void test6();
+void test7();
+void test8();
+void test9();
+void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
+void test19();
+void test20();
+void test21();
+void test22();
+void test23();
+void test24();
+void test25();
+void test26();
+void test27();
+void test28();
+void test29();
+void test30();
 #endif
@@ -0,0 +1,239 @@
+#include "ThreadPool.h"
+#include "PerfCounters.h"
+#include "SimdKernels.h"
+#include "Timer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+	// Set on the pool's worker threads so that a nested ParallelFor runs inline instead of deadlocking
+	thread_local const ThreadPool* CurrentPool = nullptr;
+}
+
+ThreadPool::ThreadPool(unsigned int NumOfThreads, const std::vector<int>& CpuAffinity)
+	: NumOfThreads(NumOfThreads ? NumOfThreads : std::max(1u, std::thread::hardware_concurrency())) {
+	workers.reserve(this->NumOfThreads - 1);
+	for (unsigned int i = 0; i + 1 < this->NumOfThreads; ++i) {
+		workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+		if (!CpuAffinity.empty()) {
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(CpuAffinity[i % CpuAffinity.size()], &cpus);
+			pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpus), &cpus); // best effort
+		}
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stop = true;
+	}
+	wake_cv.notify_all();
+	for (auto& t : workers) {
+		if (t.joinable()) {
+			t.join();
+		}
+	}
+}
+
+ThreadPool& ThreadPool::Global() {
+	static ThreadPool pool;
+	return pool;
+}
+
+// Takes task indices from the shared counter until the job is exhausted. A task that throws ends the job: its
+// exception is kept for the caller (the first one only) and the tasks not taken yet are skipped.
+void ThreadPool::RunTasks() {
+	for (unsigned int i = next_task.fetch_add(1); i < job_size; i = next_task.fetch_add(1)) {
+		try {
+			(*job)(i);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mtx);
+			if (!job_error) {
+				job_error = std::current_exception();
+			}
+			next_task = job_size;
+		}
+	}
+}
+
+void ThreadPool::WorkerLoop(unsigned int) {
+	CurrentPool = this;
+	unsigned long long seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			wake_cv.wait(lock, [&] { return stop || generation != seen; });
+			if (stop) {
+				return;
+			}
+			seen = generation;
+			if (job == nullptr) {
+				continue; // woke up after the job was already retired
+			}
+			++busy_workers;
+		}
+		RunTasks();
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			--busy_workers;
+		}
+		done_cv.notify_one();
+	}
+}
+
+void ThreadPool::ParallelFor(unsigned int NumOfTasks, const std::function<void(unsigned int)>& task) {
+#ifdef VECTOROPERATIONS_PERF
+	// Inside a profiled method every task is recorded as a span, on the thread that runs it
+	if (ProfileScope* profile = ProfileScope::Current(); profile != nullptr && CurrentPool != this) {
+		RunParallelFor(NumOfTasks, [&](unsigned int i) {
+			auto span = profile->Span(i);
+			task(i);
+		});
+		return;
+	}
+#endif
+	RunParallelFor(NumOfTasks, task);
+}
+
+void ThreadPool::RunParallelFor(unsigned int NumOfTasks, const std::function<void(unsigned int)>& task) {
+	if (NumOfTasks == 0) {
+		return;
+	}
+	if (workers.empty() || NumOfTasks == 1 || CurrentPool == this) {
+		for (unsigned int i = 0; i < NumOfTasks; ++i) {
+			task(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> dispatch(dispatch_mtx);
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		job = &task;
+		job_size = NumOfTasks;
+		next_task = 0;
+		job_error = nullptr;
+		++generation;
+	}
+	wake_cv.notify_all();
+
+	// Retires the job however the caller leaves it: the workers read `job`, and through it `task` on the caller's
+	// stack, so it may only be retired once no worker is inside RunTasks; and CurrentPool is the caller's again.
+	// Once the caller's RunTasks found no task left, every task taken is on a busy worker.
+	struct JobScope {
+		ThreadPool& pool;
+		const ThreadPool* CallerPool;
+		~JobScope() {
+			CurrentPool = CallerPool;
+			std::unique_lock<std::mutex> lock(pool.mtx);
+			pool.next_task = pool.job_size;
+			pool.done_cv.wait(lock, [&] { return pool.busy_workers == 0; });
+			pool.job = nullptr;
+		}
+	};
+
+	// The calling thread works too, then waits for the tasks still running on the workers
+	{
+		JobScope scope{*this, CurrentPool};
+		CurrentPool = this;
+		RunTasks();
+	}
+	if (job_error) {
+		std::rethrow_exception(std::exchange(job_error, nullptr));
+	}
+}
+
+namespace
+{
+	// One thread's deque of chunks. It only ever holds a contiguous run, so it is kept as [begin, end):
+	// the owner pops from begin, thieves split off the back half
+	struct StealDeque {
+		std::mutex mtx;
+		std::size_t begin = 0;
+		std::size_t end = 0;
+	};
+}
+
+void ThreadPool::ParallelForStealing(std::size_t NumOfChunks, const std::function<void(std::size_t)>& task) {
+	if (NumOfChunks == 0) {
+		return;
+	}
+	const unsigned int NumOfDeques = static_cast<unsigned int>(std::min<std::size_t>(NumOfThreads, NumOfChunks));
+	if (NumOfDeques == 1 || CurrentPool == this) {
+		for (std::size_t chunk = 0; chunk < NumOfChunks; ++chunk) {
+			task(chunk);
+		}
+		return;
+	}
+	std::vector<CacheLinePadded<StealDeque>> deques(NumOfDeques);
+	for (unsigned int i = 0; i < NumOfDeques; ++i) {
+		deques[i].value.begin = ChunkBegin(i, NumOfChunks, NumOfDeques);
+		deques[i].value.end = ChunkBegin(i + 1, NumOfChunks, NumOfDeques);
+	}
+	// Task i of ParallelFor drains deque i, then steals until every deque is empty. A task whose
+	// deque was already emptied by thieves (its thread woke up late) just joins the stealing.
+	ParallelFor(NumOfDeques, [&](unsigned int i) {
+		StealDeque& own = deques[i].value;
+		for (;;) {
+			for (;;) {
+				std::size_t chunk;
+				{
+					std::lock_guard<std::mutex> lock(own.mtx);
+					if (own.begin == own.end) {
+						break;
+					}
+					chunk = own.begin++;
+				}
+				task(chunk);
+			}
+			bool stolen = false;
+			for (unsigned int k = 1; k < NumOfDeques && !stolen; ++k) {
+				StealDeque& victim = deques[(i + k) % NumOfDeques].value;
+				std::size_t begin, end;
+				{
+					std::lock_guard<std::mutex> lock(victim.mtx);
+					if (victim.begin == victim.end) {
+						continue;
+					}
+					end = victim.end;
+					victim.end -= (victim.end - victim.begin + 1) / 2;
+					begin = victim.end;
+				}
+				std::lock_guard<std::mutex> lock(own.mtx);
+				own.begin = begin;
+				own.end = end;
+				stolen = true;
+			}
+			if (!stolen) {
+				return;
+			}
+		}
+		});
+}
+
+// Method (34) Multi threaded in-place adjacent difference on the persistent thread pool
+// Like methods 13 and 14, every chunk needs the element just before it, which the previous chunk overwrites:
+// those elements are saved before the threads start instead of being corrected afterwards
+void AdjDiffInPlace(std::span<double> data, ThreadPool& pool, bool Time) {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	const SimdKernels& kernels = BestSimdKernels();
+	std::vector<double> Boundaries(NumOfThreads, 0.0); // data[0] - 0.0 keeps diff[0] = data[0]
+	for (unsigned int i = 1; i < NumOfThreads; ++i) {
+		const std::size_t start = ChunkBegin(i, data.size(), NumOfThreads);
+		if (start > 0) {
+			Boundaries[i] = data[start - 1];
+		}
+	}
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, data.size(), NumOfThreads);
+		kernels.adjacent_difference_inplace(data.data() + start, ChunkBegin(i + 1, data.size(), NumOfThreads) - start, Boundaries[i]);
+		});
+}
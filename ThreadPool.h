@@ -0,0 +1,104 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <span>
+
+// Persistent pool of worker threads, created once and reused by every parallel call,
+// so a call pays a wake-up instead of a thread creation and join per worker.
+// A pool of size N runs N - 1 workers; the thread calling ParallelFor is the N-th.
+// Syntax: { ThreadPool pool(8); pool.ParallelFor(8, [&](unsigned int i) { ... }); }
+class ThreadPool {
+public:
+    // NumOfThreads = 0 uses std::thread::hardware_concurrency().
+    // If CpuAffinity is not empty, worker i is pinned to CPU CpuAffinity[i % CpuAffinity.size()].
+    explicit ThreadPool(unsigned int NumOfThreads = 0, const std::vector<int>& CpuAffinity = {});
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int size() const { return NumOfThreads; }
+
+    // Runs task(i) for every i in [0, NumOfTasks) and returns once all of them finished.
+    // Calls from different threads are serialized; a call made from inside a task runs inline.
+    // If a task throws, the tasks not started yet are skipped and the first exception is rethrown here, once no
+    // thread runs a task of the call any more.
+    void ParallelFor(unsigned int NumOfTasks, const std::function<void(unsigned int)>& task);
+
+    // Runs task(chunk) for every chunk in [0, NumOfChunks) with work stealing. Every thread owns a deque of
+    // chunks, at first a contiguous run of them: it pops chunks from the front, and once its deque is empty
+    // it takes the back half of another thread's deque. A thread slowed down by other load on its core thus
+    // hands its chunks over instead of delaying the whole call. A call made from inside a task runs inline.
+    void ParallelForStealing(std::size_t NumOfChunks, const std::function<void(std::size_t)>& task);
+
+    // Process-wide pool with hardware_concurrency() threads, created on first use
+    static ThreadPool& Global();
+
+private:
+    void RunParallelFor(unsigned int NumOfTasks, const std::function<void(unsigned int)>& task);
+    void WorkerLoop(unsigned int WorkerIndex);
+    void RunTasks();
+
+    unsigned int NumOfThreads;
+    std::vector<std::thread> workers;
+
+    std::mutex dispatch_mtx;           // one ParallelFor at a time
+    std::mutex mtx;                    // guards generation/stop for the condition variables
+    std::condition_variable wake_cv;   // workers wait here for the next job
+    std::condition_variable done_cv;   // the caller waits here for the workers to finish
+    unsigned long long generation = 0;
+    bool stop = false;
+
+    // Current job
+    const std::function<void(unsigned int)>* job = nullptr;
+    unsigned int job_size = 0;
+    std::atomic<unsigned int> next_task{0};
+    unsigned int busy_workers = 0;     // workers still inside the current job, guarded by mtx
+    std::exception_ptr job_error;      // first exception thrown by a task of the current job, guarded by mtx
+};
+
+// Per-worker slot for partial results. Each slot fills its own cache line pair (128 bytes covers
+// the adjacent-line prefetcher as well), so workers writing their slots never share a line.
+constexpr std::size_t CacheLineSize = 128;
+
+template <typename T>
+struct alignas(CacheLineSize) CacheLinePadded {
+    T value{};
+};
+
+// Splits [0, size) into `parts` contiguous chunks, the first size % parts of them one element longer,
+// and returns where chunk i starts (ChunkBegin(parts, ...) == size)
+inline std::size_t ChunkBegin(std::size_t i, std::size_t size, std::size_t parts) {
+    std::size_t step = size / parts, remaining = size % parts;
+    return i * step + (i < remaining ? i : remaining);
+}
+
+// Method 34: adjacent difference of `data` in place on `pool`, same layout as method 17 (data[0] is kept), without a
+// second buffer: one chunk per pool thread (ChunkBegin), each starting from the element before it, saved beforehand
+void AdjDiffInPlace(std::span<double> data, ThreadPool& pool = ThreadPool::Global(), bool Time = true);
+
+// Elements per chunk for ParallelForStealing: about StealChunkBytes of input, so a chunk and its output stay
+// in L2, made smaller (down to MinStealGrain elements) for short vectors so every thread still has about
+// StealChunksPerThread chunks to give away
+constexpr std::size_t StealChunkBytes = 65536;
+constexpr std::size_t MinStealGrain = 512;
+constexpr std::size_t StealChunksPerThread = 8;
+
+inline std::size_t AdaptiveGrain(std::size_t size, std::size_t ElementBytes, unsigned int NumOfThreads) {
+    const std::size_t CacheGrain = std::max<std::size_t>(MinStealGrain, StealChunkBytes / ElementBytes);
+    return std::clamp<std::size_t>(size / (std::size_t(NumOfThreads) * StealChunksPerThread), MinStealGrain, CacheGrain);
+}
+
+// Number of chunks of `grain` elements covering [0, size); chunk c is [c * grain, min(size, (c + 1) * grain))
+inline std::size_t NumOfGrains(std::size_t size, std::size_t grain) {
+    return (size + grain - 1) / grain;
+}
+
+#endif
@@ -39,6 +39,12 @@ public:
 
 	}
 
+	// Time since construction in nanoseconds, without printing; the benchmark harness samples scopes with it
+	long long ElapsedNanoseconds() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - m_StartTimeReference).count();
+	}
+
 
 private:
 	std::chrono::time_point<std::chrono::high_resolution_clock> m_StartTimeReference;
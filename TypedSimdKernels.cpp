@@ -0,0 +1,495 @@
+#include "TypedSimdKernels.h"
+#include <algorithm>
+#include <span>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOROPERATIONS_X86 1
+#endif
+
+namespace
+{
+	// Scalar kernels, shared by every element type: 4 accumulators, like SumScalar/ProductScalar of SimdKernels.cpp
+	template <typename T, typename Acc>
+	Acc SumScalar(const T* data, std::size_t size) {
+		Acc a0 = Acc(0), a1 = Acc(0), a2 = Acc(0), a3 = Acc(0);
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			a0 += Acc(data[i]);
+			a1 += Acc(data[i + 1]);
+			a2 += Acc(data[i + 2]);
+			a3 += Acc(data[i + 3]);
+		}
+		for (; i < size; ++i) {
+			a0 += Acc(data[i]);
+		}
+		a0 += a1;
+		a2 += a3;
+		a0 += a2;
+		return a0;
+	}
+
+	template <typename T, typename Acc>
+	Acc ProductScalar(const T* data, std::size_t size) {
+		Acc p0 = Acc(1), p1 = Acc(1), p2 = Acc(1), p3 = Acc(1);
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			p0 *= Acc(data[i]);
+			p1 *= Acc(data[i + 1]);
+			p2 *= Acc(data[i + 2]);
+			p3 *= Acc(data[i + 3]);
+		}
+		for (; i < size; ++i) {
+			p0 *= Acc(data[i]);
+		}
+		p0 *= p1;
+		p2 *= p3;
+		p0 *= p2;
+		return p0;
+	}
+
+	template <typename T>
+	void AdjacentDifferenceScalar(const T* data, std::size_t size, T* out) {
+		for (std::size_t i = 1; i < size; ++i) {
+			out[i] = Difference(data[i], data[i - 1]);
+		}
+	}
+
+	// Stops multiplying at the first overflow; only a zero further on can still change the result
+	CheckedInt64 ProductInt64(const std::int64_t* data, std::size_t size) {
+		CheckedInt64 product(1);
+		for (std::size_t i = 0; i < size; ++i) {
+			product *= CheckedInt64(data[i]);
+			if (product.Overflow()) {
+				return std::find(data + i + 1, data + size, 0) != data + size ? CheckedInt64(0) : product;
+			}
+		}
+		return product;
+	}
+
+	// Combines the lanes of a vector accumulator pairwise: (l0 + l1) + (l2 + l3) for 4 lanes, and so on
+	template <typename Acc>
+	Acc CombineSum(Acc* lanes, std::size_t Lanes) {
+		for (std::size_t width = Lanes / 2; width > 0; width /= 2) {
+			for (std::size_t k = 0; k < width; ++k) {
+				lanes[k] = lanes[2 * k] + lanes[2 * k + 1];
+			}
+		}
+		return lanes[0];
+	}
+
+	template <typename Acc>
+	Acc CombineProduct(Acc* lanes, std::size_t Lanes) {
+		for (std::size_t width = Lanes / 2; width > 0; width /= 2) {
+			for (std::size_t k = 0; k < width; ++k) {
+				lanes[k] = lanes[2 * k] * lanes[2 * k + 1];
+			}
+		}
+		return lanes[0];
+	}
+
+	// Exact value of an int64 lane whose wrapped sum is `sum` after `carry` net overflows upwards
+	CheckedInt64 CarriedLane(std::int64_t sum, std::int64_t carry) {
+		CheckedInt64 lane(sum);
+		lane.value += static_cast<__int128>(carry) * (static_cast<__int128>(1) << 64);
+		return lane;
+	}
+
+#ifdef VECTOROPERATIONS_X86
+	// SSE2: 4 accumulators x 4 float lanes
+	float SumFloatSSE2(const float* data, std::size_t size) {
+		__m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps(), a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			a0 = _mm_add_ps(a0, _mm_loadu_ps(data + i));
+			a1 = _mm_add_ps(a1, _mm_loadu_ps(data + i + 4));
+			a2 = _mm_add_ps(a2, _mm_loadu_ps(data + i + 8));
+			a3 = _mm_add_ps(a3, _mm_loadu_ps(data + i + 12));
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3)));
+		return CombineSum(lanes, 4) + SumScalar<float, float>(data + i, size - i);
+	}
+
+	float ProductFloatSSE2(const float* data, std::size_t size) {
+		__m128 a0 = _mm_set1_ps(1.0f), a1 = _mm_set1_ps(1.0f), a2 = _mm_set1_ps(1.0f), a3 = _mm_set1_ps(1.0f);
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			a0 = _mm_mul_ps(a0, _mm_loadu_ps(data + i));
+			a1 = _mm_mul_ps(a1, _mm_loadu_ps(data + i + 4));
+			a2 = _mm_mul_ps(a2, _mm_loadu_ps(data + i + 8));
+			a3 = _mm_mul_ps(a3, _mm_loadu_ps(data + i + 12));
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, _mm_mul_ps(_mm_mul_ps(a0, a1), _mm_mul_ps(a2, a3)));
+		return CombineProduct(lanes, 4) * ProductScalar<float, float>(data + i, size - i);
+	}
+
+	void AdjacentDifferenceFloatSSE2(const float* data, std::size_t size, float* out) {
+		std::size_t i = 1;
+		for (; i + 4 <= size; i += 4) {
+			_mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(data + i - 1)));
+		}
+		AdjacentDifferenceScalar(data + i - 1, size - i + 1, out + i - 1);
+	}
+
+	// 4 floats converted to 2 x 2 doubles per load, 4 double accumulators
+	double SumFloatDoubleSSE2(const float* data, std::size_t size) {
+		__m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			__m128 x0 = _mm_loadu_ps(data + i), x1 = _mm_loadu_ps(data + i + 4);
+			a0 = _mm_add_pd(a0, _mm_cvtps_pd(x0));
+			a1 = _mm_add_pd(a1, _mm_cvtps_pd(_mm_movehl_ps(x0, x0)));
+			a2 = _mm_add_pd(a2, _mm_cvtps_pd(x1));
+			a3 = _mm_add_pd(a3, _mm_cvtps_pd(_mm_movehl_ps(x1, x1)));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_add_pd(_mm_add_pd(a0, a1), _mm_add_pd(a2, a3)));
+		return CombineSum(lanes, 2) + SumScalar<float, double>(data + i, size - i);
+	}
+
+	double ProductFloatDoubleSSE2(const float* data, std::size_t size) {
+		__m128d a0 = _mm_set1_pd(1.0), a1 = _mm_set1_pd(1.0), a2 = _mm_set1_pd(1.0), a3 = _mm_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			__m128 x0 = _mm_loadu_ps(data + i), x1 = _mm_loadu_ps(data + i + 4);
+			a0 = _mm_mul_pd(a0, _mm_cvtps_pd(x0));
+			a1 = _mm_mul_pd(a1, _mm_cvtps_pd(_mm_movehl_ps(x0, x0)));
+			a2 = _mm_mul_pd(a2, _mm_cvtps_pd(x1));
+			a3 = _mm_mul_pd(a3, _mm_cvtps_pd(_mm_movehl_ps(x1, x1)));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_mul_pd(_mm_mul_pd(a0, a1), _mm_mul_pd(a2, a3)));
+		return CombineProduct(lanes, 2) * ProductScalar<float, double>(data + i, size - i);
+	}
+
+	// Wrapping int64 add that counts the overflows of every lane in `carry` (+1 upwards, -1 downwards):
+	// a lane overflowed if x and the old sum have the same sign and the new sum has the other one
+	inline void AddCarrySSE2(__m128i& s, __m128i& carry, __m128i x) {
+		const __m128i r = _mm_add_epi64(s, x);
+		const __m128i overflowed = _mm_srli_epi64(_mm_and_si128(_mm_xor_si128(s, r), _mm_xor_si128(x, r)), 63);
+		const __m128i negative = _mm_srli_epi64(r, 63); // an upward overflow wraps to a negative sum
+		carry = _mm_add_epi64(carry, _mm_and_si128(overflowed, negative));
+		carry = _mm_sub_epi64(carry, _mm_andnot_si128(negative, overflowed));
+		s = r;
+	}
+
+	CheckedInt64 SumInt64SSE2(const std::int64_t* data, std::size_t size) {
+		__m128i s0 = _mm_setzero_si128(), s1 = _mm_setzero_si128(), c0 = _mm_setzero_si128(), c1 = _mm_setzero_si128();
+		std::size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			AddCarrySSE2(s0, c0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+			AddCarrySSE2(s1, c1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2)));
+		}
+		std::int64_t sums[4], carries[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(sums), s0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(sums + 2), s1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(carries), c0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(carries + 2), c1);
+		CheckedInt64 total = SumScalar<std::int64_t, CheckedInt64>(data + i, size - i);
+		for (int k = 0; k < 4; ++k) {
+			total += CarriedLane(sums[k], carries[k]);
+		}
+		return total;
+	}
+
+	void AdjacentDifferenceInt64SSE2(const std::int64_t* data, std::size_t size, std::int64_t* out) {
+		std::size_t i = 1;
+		for (; i + 2 <= size; i += 2) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i - 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi64(x, previous));
+		}
+		AdjacentDifferenceScalar(data + i - 1, size - i + 1, out + i - 1);
+	}
+
+	// AVX2: 4 accumulators x 8 float lanes
+	__attribute__((target("avx2")))
+	float SumFloatAVX2(const float* data, std::size_t size) {
+		__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32) {
+			a0 = _mm256_add_ps(a0, _mm256_loadu_ps(data + i));
+			a1 = _mm256_add_ps(a1, _mm256_loadu_ps(data + i + 8));
+			a2 = _mm256_add_ps(a2, _mm256_loadu_ps(data + i + 16));
+			a3 = _mm256_add_ps(a3, _mm256_loadu_ps(data + i + 24));
+		}
+		float lanes[8];
+		_mm256_storeu_ps(lanes, _mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineSum(lanes, 8) + SumScalar<float, float>(data + i, size - i);
+	}
+
+	__attribute__((target("avx2")))
+	float ProductFloatAVX2(const float* data, std::size_t size) {
+		__m256 a0 = _mm256_set1_ps(1.0f), a1 = _mm256_set1_ps(1.0f), a2 = _mm256_set1_ps(1.0f), a3 = _mm256_set1_ps(1.0f);
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32) {
+			a0 = _mm256_mul_ps(a0, _mm256_loadu_ps(data + i));
+			a1 = _mm256_mul_ps(a1, _mm256_loadu_ps(data + i + 8));
+			a2 = _mm256_mul_ps(a2, _mm256_loadu_ps(data + i + 16));
+			a3 = _mm256_mul_ps(a3, _mm256_loadu_ps(data + i + 24));
+		}
+		float lanes[8];
+		_mm256_storeu_ps(lanes, _mm256_mul_ps(_mm256_mul_ps(a0, a1), _mm256_mul_ps(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineProduct(lanes, 8) * ProductScalar<float, float>(data + i, size - i);
+	}
+
+	__attribute__((target("avx2")))
+	void AdjacentDifferenceFloatAVX2(const float* data, std::size_t size, float* out) {
+		std::size_t i = 1;
+		for (; i + 8 <= size; i += 8) {
+			_mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_loadu_ps(data + i), _mm256_loadu_ps(data + i - 1)));
+		}
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		AdjacentDifferenceScalar(data + i - 1, size - i + 1, out + i - 1);
+	}
+
+	__attribute__((target("avx2")))
+	double SumFloatDoubleAVX2(const float* data, std::size_t size) {
+		__m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			a0 = _mm256_add_pd(a0, _mm256_cvtps_pd(_mm_loadu_ps(data + i)));
+			a1 = _mm256_add_pd(a1, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 4)));
+			a2 = _mm256_add_pd(a2, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 8)));
+			a3 = _mm256_add_pd(a3, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 12)));
+		}
+		double lanes[4];
+		_mm256_storeu_pd(lanes, _mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineSum(lanes, 4) + SumScalar<float, double>(data + i, size - i);
+	}
+
+	__attribute__((target("avx2")))
+	double ProductFloatDoubleAVX2(const float* data, std::size_t size) {
+		__m256d a0 = _mm256_set1_pd(1.0), a1 = _mm256_set1_pd(1.0), a2 = _mm256_set1_pd(1.0), a3 = _mm256_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			a0 = _mm256_mul_pd(a0, _mm256_cvtps_pd(_mm_loadu_ps(data + i)));
+			a1 = _mm256_mul_pd(a1, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 4)));
+			a2 = _mm256_mul_pd(a2, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 8)));
+			a3 = _mm256_mul_pd(a3, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 12)));
+		}
+		double lanes[4];
+		_mm256_storeu_pd(lanes, _mm256_mul_pd(_mm256_mul_pd(a0, a1), _mm256_mul_pd(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineProduct(lanes, 4) * ProductScalar<float, double>(data + i, size - i);
+	}
+
+	__attribute__((target("avx2")))
+	inline void AddCarryAVX2(__m256i& s, __m256i& carry, __m256i x) {
+		const __m256i r = _mm256_add_epi64(s, x);
+		const __m256i overflowed = _mm256_srli_epi64(_mm256_and_si256(_mm256_xor_si256(s, r), _mm256_xor_si256(x, r)), 63);
+		const __m256i negative = _mm256_srli_epi64(r, 63);
+		carry = _mm256_add_epi64(carry, _mm256_and_si256(overflowed, negative));
+		carry = _mm256_sub_epi64(carry, _mm256_andnot_si256(negative, overflowed));
+		s = r;
+	}
+
+	__attribute__((target("avx2")))
+	CheckedInt64 SumInt64AVX2(const std::int64_t* data, std::size_t size) {
+		__m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256(), c0 = _mm256_setzero_si256(), c1 = _mm256_setzero_si256();
+		std::size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			AddCarryAVX2(s0, c0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+			AddCarryAVX2(s1, c1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 4)));
+		}
+		std::int64_t sums[8], carries[8];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), s0);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + 4), s1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(carries), c0);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(carries + 4), c1);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		CheckedInt64 total = SumScalar<std::int64_t, CheckedInt64>(data + i, size - i);
+		for (int k = 0; k < 8; ++k) {
+			total += CarriedLane(sums[k], carries[k]);
+		}
+		return total;
+	}
+
+	__attribute__((target("avx2")))
+	void AdjacentDifferenceInt64AVX2(const std::int64_t* data, std::size_t size, std::int64_t* out) {
+		std::size_t i = 1;
+		for (; i + 4 <= size; i += 4) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			const __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i - 1));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi64(x, previous));
+		}
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		AdjacentDifferenceScalar(data + i - 1, size - i + 1, out + i - 1);
+	}
+
+	// AVX-512: 4 accumulators x 16 float lanes. The maskz forms (mask = all lanes) of the conversions and shifts
+	// avoid the false -Wmaybe-uninitialized that GCC 12 reports for the unmasked intrinsics
+	__attribute__((target("avx512f")))
+	float SumFloatAVX512(const float* data, std::size_t size) {
+		__m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps(), a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+		std::size_t i = 0;
+		for (; i + 64 <= size; i += 64) {
+			a0 = _mm512_add_ps(a0, _mm512_loadu_ps(data + i));
+			a1 = _mm512_add_ps(a1, _mm512_loadu_ps(data + i + 16));
+			a2 = _mm512_add_ps(a2, _mm512_loadu_ps(data + i + 32));
+			a3 = _mm512_add_ps(a3, _mm512_loadu_ps(data + i + 48));
+		}
+		float lanes[16];
+		_mm512_storeu_ps(lanes, _mm512_add_ps(_mm512_add_ps(a0, a1), _mm512_add_ps(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineSum(lanes, 16) + SumScalar<float, float>(data + i, size - i);
+	}
+
+	__attribute__((target("avx512f")))
+	float ProductFloatAVX512(const float* data, std::size_t size) {
+		__m512 a0 = _mm512_set1_ps(1.0f), a1 = _mm512_set1_ps(1.0f), a2 = _mm512_set1_ps(1.0f), a3 = _mm512_set1_ps(1.0f);
+		std::size_t i = 0;
+		for (; i + 64 <= size; i += 64) {
+			a0 = _mm512_mul_ps(a0, _mm512_loadu_ps(data + i));
+			a1 = _mm512_mul_ps(a1, _mm512_loadu_ps(data + i + 16));
+			a2 = _mm512_mul_ps(a2, _mm512_loadu_ps(data + i + 32));
+			a3 = _mm512_mul_ps(a3, _mm512_loadu_ps(data + i + 48));
+		}
+		float lanes[16];
+		_mm512_storeu_ps(lanes, _mm512_mul_ps(_mm512_mul_ps(a0, a1), _mm512_mul_ps(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineProduct(lanes, 16) * ProductScalar<float, float>(data + i, size - i);
+	}
+
+	__attribute__((target("avx512f")))
+	void AdjacentDifferenceFloatAVX512(const float* data, std::size_t size, float* out) {
+		std::size_t i = 1;
+		for (; i + 16 <= size; i += 16) {
+			_mm512_storeu_ps(out + i, _mm512_sub_ps(_mm512_loadu_ps(data + i), _mm512_loadu_ps(data + i - 1)));
+		}
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		AdjacentDifferenceScalar(data + i - 1, size - i + 1, out + i - 1);
+	}
+
+	__attribute__((target("avx512f")))
+	double SumFloatDoubleAVX512(const float* data, std::size_t size) {
+		__m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd(), a2 = _mm512_setzero_pd(), a3 = _mm512_setzero_pd();
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32) {
+			a0 = _mm512_add_pd(a0, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i)));
+			a1 = _mm512_add_pd(a1, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i + 8)));
+			a2 = _mm512_add_pd(a2, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i + 16)));
+			a3 = _mm512_add_pd(a3, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i + 24)));
+		}
+		double lanes[8];
+		_mm512_storeu_pd(lanes, _mm512_add_pd(_mm512_add_pd(a0, a1), _mm512_add_pd(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineSum(lanes, 8) + SumScalar<float, double>(data + i, size - i);
+	}
+
+	__attribute__((target("avx512f")))
+	double ProductFloatDoubleAVX512(const float* data, std::size_t size) {
+		__m512d a0 = _mm512_set1_pd(1.0), a1 = _mm512_set1_pd(1.0), a2 = _mm512_set1_pd(1.0), a3 = _mm512_set1_pd(1.0);
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32) {
+			a0 = _mm512_mul_pd(a0, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i)));
+			a1 = _mm512_mul_pd(a1, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i + 8)));
+			a2 = _mm512_mul_pd(a2, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i + 16)));
+			a3 = _mm512_mul_pd(a3, _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(data + i + 24)));
+		}
+		double lanes[8];
+		_mm512_storeu_pd(lanes, _mm512_mul_pd(_mm512_mul_pd(a0, a1), _mm512_mul_pd(a2, a3)));
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		return CombineProduct(lanes, 8) * ProductScalar<float, double>(data + i, size - i);
+	}
+
+	__attribute__((target("avx512f")))
+	inline void AddCarryAVX512(__m512i& s, __m512i& carry, __m512i x) {
+		const __m512i r = _mm512_add_epi64(s, x);
+		const __m512i overflowed = _mm512_maskz_srli_epi64(0xff, _mm512_and_si512(_mm512_xor_si512(s, r), _mm512_xor_si512(x, r)), 63);
+		const __m512i negative = _mm512_maskz_srli_epi64(0xff, r, 63);
+		carry = _mm512_add_epi64(carry, _mm512_and_si512(overflowed, negative));
+		carry = _mm512_sub_epi64(carry, _mm512_maskz_andnot_epi64(0xff, negative, overflowed));
+		s = r;
+	}
+
+	__attribute__((target("avx512f")))
+	CheckedInt64 SumInt64AVX512(const std::int64_t* data, std::size_t size) {
+		__m512i s0 = _mm512_setzero_si512(), s1 = _mm512_setzero_si512(), c0 = _mm512_setzero_si512(), c1 = _mm512_setzero_si512();
+		std::size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			AddCarryAVX512(s0, c0, _mm512_loadu_si512(data + i));
+			AddCarryAVX512(s1, c1, _mm512_loadu_si512(data + i + 8));
+		}
+		std::int64_t sums[16], carries[16];
+		_mm512_storeu_si512(sums, s0);
+		_mm512_storeu_si512(sums + 8, s1);
+		_mm512_storeu_si512(carries, c0);
+		_mm512_storeu_si512(carries + 8, c1);
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		CheckedInt64 total = SumScalar<std::int64_t, CheckedInt64>(data + i, size - i);
+		for (int k = 0; k < 16; ++k) {
+			total += CarriedLane(sums[k], carries[k]);
+		}
+		return total;
+	}
+
+	__attribute__((target("avx512f")))
+	void AdjacentDifferenceInt64AVX512(const std::int64_t* data, std::size_t size, std::int64_t* out) {
+		std::size_t i = 1;
+		for (; i + 8 <= size; i += 8) {
+			_mm512_storeu_si512(out + i, _mm512_sub_epi64(_mm512_loadu_si512(data + i), _mm512_loadu_si512(data + i - 1)));
+		}
+		_mm256_zeroupper(); // the scalar tail below is not VEX-encoded
+		AdjacentDifferenceScalar(data + i - 1, size - i + 1, out + i - 1);
+	}
+#endif
+
+	// One table per (element, accumulator) pair, picked by the types of the two null pointers
+	std::span<const TypedSimdKernels<float, float>> KernelTable(const float*, const float*) {
+		static const TypedSimdKernels<float, float> kernels[] = {
+			{SimdLevel::Scalar, "scalar", SumScalar<float, float>, ProductScalar<float, float>, AdjacentDifferenceScalar<float>},
+#ifdef VECTOROPERATIONS_X86
+			{SimdLevel::SSE2, "sse2", SumFloatSSE2, ProductFloatSSE2, AdjacentDifferenceFloatSSE2},
+			{SimdLevel::AVX2, "avx2", SumFloatAVX2, ProductFloatAVX2, AdjacentDifferenceFloatAVX2},
+			{SimdLevel::AVX512, "avx512", SumFloatAVX512, ProductFloatAVX512, AdjacentDifferenceFloatAVX512},
+#endif
+		};
+		return kernels;
+	}
+
+	std::span<const TypedSimdKernels<float, double>> KernelTable(const float*, const double*) {
+		static const TypedSimdKernels<float, double> kernels[] = {
+			{SimdLevel::Scalar, "scalar", SumScalar<float, double>, ProductScalar<float, double>, AdjacentDifferenceScalar<float>},
+#ifdef VECTOROPERATIONS_X86
+			{SimdLevel::SSE2, "sse2", SumFloatDoubleSSE2, ProductFloatDoubleSSE2, AdjacentDifferenceFloatSSE2},
+			{SimdLevel::AVX2, "avx2", SumFloatDoubleAVX2, ProductFloatDoubleAVX2, AdjacentDifferenceFloatAVX2},
+			{SimdLevel::AVX512, "avx512", SumFloatDoubleAVX512, ProductFloatDoubleAVX512, AdjacentDifferenceFloatAVX512},
+#endif
+		};
+		return kernels;
+	}
+
+	std::span<const TypedSimdKernels<std::int64_t, CheckedInt64>> KernelTable(const std::int64_t*, const CheckedInt64*) {
+		static const TypedSimdKernels<std::int64_t, CheckedInt64> kernels[] = {
+			{SimdLevel::Scalar, "scalar", SumScalar<std::int64_t, CheckedInt64>, ProductInt64, AdjacentDifferenceScalar<std::int64_t>},
+#ifdef VECTOROPERATIONS_X86
+			{SimdLevel::SSE2, "sse2", SumInt64SSE2, ProductInt64, AdjacentDifferenceInt64SSE2},
+			{SimdLevel::AVX2, "avx2", SumInt64AVX2, ProductInt64, AdjacentDifferenceInt64AVX2},
+			{SimdLevel::AVX512, "avx512", SumInt64AVX512, ProductInt64, AdjacentDifferenceInt64AVX512},
+#endif
+		};
+		return kernels;
+	}
+}
+
+template <typename T, typename Acc>
+const TypedSimdKernels<T, Acc>& GetTypedSimdKernels(SimdLevel level) {
+	const SimdLevel supported = DetectSimdLevel();
+	const auto kernels = KernelTable(static_cast<const T*>(nullptr), static_cast<const Acc*>(nullptr));
+	const TypedSimdKernels<T, Acc>* best = &kernels[0];
+	for (const auto& candidate : kernels) {
+		if (candidate.level <= level && candidate.level <= supported) {
+			best = &candidate;
+		}
+	}
+	return *best;
+}
+
+template const TypedSimdKernels<float, float>& GetTypedSimdKernels<float, float>(SimdLevel level);
+template const TypedSimdKernels<float, double>& GetTypedSimdKernels<float, double>(SimdLevel level);
+template const TypedSimdKernels<std::int64_t, CheckedInt64>& GetTypedSimdKernels<std::int64_t, CheckedInt64>(SimdLevel level);
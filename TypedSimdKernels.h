@@ -0,0 +1,46 @@
+#ifndef TYPEDSIMDKERNELS_H
+#define TYPEDSIMDKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SimdKernels.h"
+#include "CheckedInt64.h"
+
+// SIMD kernels for element types other than double, one set per instruction set like SimdKernels:
+//   <float, float>          float lanes (twice as many per register as double), float accumulators
+//   <float, double>         float loads converted to double lanes: half the bandwidth of double data,
+//                           the accuracy of double accumulation (same bounds as SimdKernels.h)
+//   <int64_t, CheckedInt64> exact sums (lane overflows are counted as carries), checked products (scalar on
+//                           every level: there is no 64-bit vector multiply below AVX-512DQ)
+// The int64 adjacent difference wraps modulo 2^64 instead of overflowing.
+template <typename T, typename Acc>
+struct TypedSimdKernels {
+    SimdLevel level;
+    const char* name;
+    Acc (*sum)(const T* data, std::size_t size);
+    Acc (*product)(const T* data, std::size_t size);
+    // Writes out[i] = data[i] - data[i - 1] for i in [1, size); out[0] is left to the caller
+    void (*adjacent_difference)(const T* data, std::size_t size, T* out);
+};
+
+// data[i] - data[i - 1] for the adjacent differences: modulo 2^64 for int64, so it never overflows
+inline float Difference(float a, float b) { return a - b; }
+inline std::int64_t Difference(std::int64_t a, std::int64_t b) {
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) - static_cast<std::uint64_t>(b));
+}
+
+// Kernels of the given level, or of the best supported level below it (see DetectSimdLevel)
+template <typename T, typename Acc>
+const TypedSimdKernels<T, Acc>& GetTypedSimdKernels(SimdLevel level);
+// Kernels of DetectSimdLevel(), detected once per process
+template <typename T, typename Acc>
+const TypedSimdKernels<T, Acc>& BestTypedSimdKernels() {
+    static const TypedSimdKernels<T, Acc>& best = GetTypedSimdKernels<T, Acc>(DetectSimdLevel());
+    return best;
+}
+
+extern template const TypedSimdKernels<float, float>& GetTypedSimdKernels<float, float>(SimdLevel level);
+extern template const TypedSimdKernels<float, double>& GetTypedSimdKernels<float, double>(SimdLevel level);
+extern template const TypedSimdKernels<std::int64_t, CheckedInt64>& GetTypedSimdKernels<std::int64_t, CheckedInt64>(SimdLevel level);
+
+#endif
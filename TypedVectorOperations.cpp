@@ -0,0 +1,125 @@
+#include "VectorOperations.h"
+#include "TypedSimdKernels.h"
+#include <numeric>
+
+// Methods of the float and int64 classes, same numbers as their double versions in VectorOperations.cpp.
+// Sums and products accumulate in Acc; adjacent differences stay in the element type.
+
+// Method (1) Simple summation
+template <typename T, typename Acc>
+Acc BasicSimpleVectorOperations<T, Acc>::sum1(bool Time) const {
+	Timer timeit(Time);
+	Acc sum = Acc(0);
+	for (const auto& val : this->vec)
+		sum += Acc(val);
+	return sum;
+}
+
+// Method (4) Simple product
+template <typename T, typename Acc>
+Acc BasicSimpleVectorOperations<T, Acc>::product1(bool Time) const {
+	Timer timeit(Time);
+	Acc prod = Acc(1);
+	for (const auto& val : this->vec) {
+		prod *= Acc(val);
+	}
+	return prod;
+}
+
+// Method (7) std::adjacent difference (modulo 2^64 for int64)
+template <typename T, typename Acc>
+void BasicSimpleVectorOperations<T, Acc>::adjacent_difference2(std::vector<T>& diff, bool Time) const {
+	Timer timeit(Time);
+	diff.resize(this->vec.size());
+	std::adjacent_difference(this->vec.begin(), this->vec.end(), diff.begin(), [](T current, T previous) { return Difference(current, previous); });
+}
+
+// Method (18) SIMD summation
+template <typename T, typename Acc>
+Acc BasicSimpleVectorOperations<T, Acc>::sumSimd(bool Time) const {
+	Timer timeit(Time);
+	return BestTypedSimdKernels<T, Acc>().sum(this->vec.data(), this->vec.size());
+}
+
+// Method (19) SIMD product
+template <typename T, typename Acc>
+Acc BasicSimpleVectorOperations<T, Acc>::productSimd(bool Time) const {
+	Timer timeit(Time);
+	return BestTypedSimdKernels<T, Acc>().product(this->vec.data(), this->vec.size());
+}
+
+// Method (20) SIMD adjacent difference, same layout as method 7 (diff[0] = vec[0])
+template <typename T, typename Acc>
+void BasicSimpleVectorOperations<T, Acc>::adjacent_differenceSimd(std::vector<T>& diff, bool Time) const {
+	Timer timeit(Time);
+	diff.resize(this->vec.size());
+	if (this->vec.empty()) {
+		return;
+	}
+	diff[0] = this->vec[0];
+	BestTypedSimdKernels<T, Acc>().adjacent_difference(this->vec.data(), this->vec.size(), diff.data());
+}
+
+// Method (15) Multi threaded summation on the persistent thread pool
+template <typename T, typename Acc>
+Acc BasicMultiThreadVectorOperations<T, Acc>::ComputeSumThreadPool(bool Time) const {
+	Timer timeit(Time);
+	const std::span<const T> vec = this->vec;
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<Acc>> Partial_Sums(NumOfThreads);
+	const TypedSimdKernels<T, Acc>& kernels = BestTypedSimdKernels<T, Acc>();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		Partial_Sums[i].value = kernels.sum(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start);
+		});
+	Acc total_sum = Acc(0);
+	for (const auto& partial : Partial_Sums) {
+		total_sum += partial.value;
+	}
+	return total_sum;
+}
+
+// Method (16) Multi threaded product on the persistent thread pool
+template <typename T, typename Acc>
+Acc BasicMultiThreadVectorOperations<T, Acc>::ComputeProductThreadPool(bool Time) const {
+	Timer timeit(Time);
+	const std::span<const T> vec = this->vec;
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<Acc>> Partial_Products(NumOfThreads);
+	const TypedSimdKernels<T, Acc>& kernels = BestTypedSimdKernels<T, Acc>();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		Partial_Products[i].value = kernels.product(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start);
+		});
+	Acc product = Acc(1);
+	for (const auto& partial : Partial_Products) {
+		product *= partial.value;
+	}
+	return product;
+}
+
+// Method (17) Multi threaded adjacent difference on the persistent thread pool
+template <typename T, typename Acc>
+void BasicMultiThreadVectorOperations<T, Acc>::ComputeAdjDiffThreadPool(std::vector<T>& diff, bool Time) const {
+	Timer timeit(Time);
+	const std::span<const T> vec = this->vec;
+	const unsigned int NumOfThreads = pool.size();
+	const TypedSimdKernels<T, Acc>& kernels = BestTypedSimdKernels<T, Acc>();
+	diff.resize(vec.size());
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		const std::size_t end = ChunkBegin(i + 1, vec.size(), NumOfThreads);
+		if (start == end) {
+			return;
+		}
+		diff[start] = start == 0 ? vec[0] : Difference(vec[start], vec[start - 1]);
+		kernels.adjacent_difference(vec.data() + start, end - start, diff.data() + start);
+		});
+}
+
+template class BasicSimpleVectorOperations<float, float>;
+template class BasicSimpleVectorOperations<float, double>;
+template class BasicSimpleVectorOperations<std::int64_t, CheckedInt64>;
+template class BasicMultiThreadVectorOperations<float, float>;
+template class BasicMultiThreadVectorOperations<float, double>;
+template class BasicMultiThreadVectorOperations<std::int64_t, CheckedInt64>;
@@ -0,0 +1,314 @@
+#ifndef VECTOREXPRESSIONS_H
+#define VECTOREXPRESSIONS_H
+
+#include "SimdKernels.h"
+#include "ScaledProduct.h"
+#include "ThreadPool.h"
+#include <span>
+#include <vector>
+#include <cmath>
+#include <concepts>
+#include <algorithm>
+#include <type_traits>
+#include <ranges>
+#include <array>
+
+// Lazy element-wise expressions over vector views. Building an expression only stores the views and the
+// constants; nothing is computed (and nothing is allocated) until a reduction (Sum, Product, ProductScaled)
+// or Evaluate consumes it, and then every node runs in the same loop, so a chain such as the sum of squared
+// adjacent differences reads the data from memory once.
+// Syntax: double s = Sum(Square(Diff(data)), ExpressionBackend::Simd);
+//         Evaluate(2.0 * Abs(View(a) + View(b)), out);
+// Expressions hold views: the vectors they are built on must outlive them. The output of Evaluate must
+// not overlap the inputs (an element of Diff reads the previous input element).
+
+// Base of every expression node, to tell them apart from other types in the operators below.
+// A node gives e[i] for any i, and a branch-free At(i) for i >= Lead(), the number of leading elements that
+// need a special case (1 for Diff); the block loops use At() so the compiler can vectorize them.
+struct ExpressionNode {};
+
+template <typename E>
+concept VectorExpression = std::derived_from<E, ExpressionNode> && requires(const E & e, std::size_t i) {
+    { e[i] } -> std::convertible_to<double>;
+    { e.At(i) } -> std::convertible_to<double>;
+    { e.size() } -> std::convertible_to<std::size_t>;
+    { e.Lead() } -> std::convertible_to<std::size_t>;
+};
+
+// Leaf: a view of existing data
+struct ExpressionView : ExpressionNode {
+    std::span<const double> view;
+
+    double operator[](std::size_t i) const { return view[i]; }
+    double At(std::size_t i) const { return view[i]; }
+    std::size_t size() const { return view.size(); }
+    std::size_t Lead() const { return 0; }
+    const double* data() const { return view.data(); }
+};
+
+// Same layout as std::adjacent_difference (method 7): element 0 is e[0], element i is e[i] - e[i - 1]
+template <VectorExpression E>
+struct DiffExpression : ExpressionNode {
+    E e;
+
+    double operator[](std::size_t i) const { return i == 0 ? e[0] : e[i] - e[i - 1]; }
+    double At(std::size_t i) const { return e.At(i) - e.At(i - 1); }
+    std::size_t size() const { return e.size(); }
+    std::size_t Lead() const { return e.Lead() + 1; }
+};
+
+template <VectorExpression E>
+struct ScaleExpression : ExpressionNode {
+    E e;
+    double factor;
+
+    double operator[](std::size_t i) const { return e[i] * factor; }
+    double At(std::size_t i) const { return e.At(i) * factor; }
+    std::size_t size() const { return e.size(); }
+    std::size_t Lead() const { return e.Lead(); }
+};
+
+// Element-wise sum; its size is the smaller of the two sizes
+template <VectorExpression A, VectorExpression B>
+struct AddExpression : ExpressionNode {
+    A a;
+    B b;
+
+    double operator[](std::size_t i) const { return a[i] + b[i]; }
+    double At(std::size_t i) const { return a.At(i) + b.At(i); }
+    std::size_t size() const { return std::min<std::size_t>(a.size(), b.size()); }
+    std::size_t Lead() const { return std::max<std::size_t>(a.Lead(), b.Lead()); }
+};
+
+template <VectorExpression E>
+struct AbsExpression : ExpressionNode {
+    E e;
+
+    double operator[](std::size_t i) const { return std::fabs(e[i]); }
+    double At(std::size_t i) const { return std::fabs(e.At(i)); }
+    std::size_t size() const { return e.size(); }
+    std::size_t Lead() const { return e.Lead(); }
+};
+
+template <VectorExpression E>
+struct SquareExpression : ExpressionNode {
+    E e;
+
+    double operator[](std::size_t i) const { const double x = e[i]; return x * x; }
+    double At(std::size_t i) const { const double x = e.At(i); return x * x; }
+    std::size_t size() const { return e.size(); }
+    std::size_t Lead() const { return e.Lead(); }
+};
+
+// Drops the first `count` elements, e.g. Skip(Diff(v), 1) holds only the true differences
+template <VectorExpression E>
+struct SkipExpression : ExpressionNode {
+    E e;
+    std::size_t count;
+
+    double operator[](std::size_t i) const { return e[i + count]; }
+    double At(std::size_t i) const { return e.At(i + count); }
+    std::size_t size() const { return e.size() > count ? e.size() - count : 0; }
+    std::size_t Lead() const { return e.Lead() > count ? e.Lead() - count : 0; }
+};
+
+// Operands are expressions, or data that converts to std::span<const double> (std::vector, std::array, spans)
+template <typename T>
+concept ExpressionOperand = VectorExpression<std::remove_cvref_t<T>> || std::convertible_to<const T&, std::span<const double>>;
+
+// Builders hold expressions by value and data by view: data passed as a temporary must itself be a view (a span),
+// a temporary vector or array would be destroyed before the expression is evaluated
+template <typename T>
+concept BorrowableOperand = ExpressionOperand<std::remove_cvref_t<T>> &&
+    (VectorExpression<std::remove_cvref_t<T>> || std::is_lvalue_reference_v<T> || std::ranges::borrowed_range<std::remove_cvref_t<T>>);
+
+inline ExpressionView View(std::span<const double> data) { return ExpressionView{ {}, data }; }
+ExpressionView View(std::vector<double>&& data) = delete;
+template <std::size_t N>
+ExpressionView View(std::array<double, N>&& data) = delete;
+
+template <ExpressionOperand T>
+auto AsExpression(const T& operand) {
+    if constexpr (VectorExpression<T>) {
+        return operand;
+    }
+    else {
+        return View(std::span<const double>(operand));
+    }
+}
+
+template <BorrowableOperand T>
+auto Diff(T&& operand) { return DiffExpression<decltype(AsExpression(operand))>{ {}, AsExpression(operand) }; }
+template <BorrowableOperand T>
+auto Scale(T&& operand, double factor) { return ScaleExpression<decltype(AsExpression(operand))>{ {}, AsExpression(operand), factor }; }
+template <BorrowableOperand A, BorrowableOperand B>
+auto Add(A&& a, B&& b) {
+    return AddExpression<decltype(AsExpression(a)), decltype(AsExpression(b))>{ {}, AsExpression(a), AsExpression(b) };
+}
+template <BorrowableOperand T>
+auto Abs(T&& operand) { return AbsExpression<decltype(AsExpression(operand))>{ {}, AsExpression(operand) }; }
+template <BorrowableOperand T>
+auto Square(T&& operand) { return SquareExpression<decltype(AsExpression(operand))>{ {}, AsExpression(operand) }; }
+template <BorrowableOperand T>
+auto Skip(T&& operand, std::size_t count) { return SkipExpression<decltype(AsExpression(operand))>{ {}, AsExpression(operand), count }; }
+
+// Operators, for expressions only (View() the data first): a + b, k * e, e * k
+template <VectorExpression A, VectorExpression B>
+auto operator+(const A& a, const B& b) { return Add(a, b); }
+template <VectorExpression E>
+auto operator*(double factor, const E& e) { return Scale(e, factor); }
+template <VectorExpression E>
+auto operator*(const E& e, double factor) { return Scale(e, factor); }
+
+// Where a reduction or Evaluate runs:
+//   Scalar      one thread, one element at a time in index order (like methods 1 and 4)
+//   Simd        one thread; the expression is computed into an L1-sized block on the stack and the block is
+//               reduced by the SIMD kernels of the host (SimdKernels.h); a plain view is reduced in place
+//   MultiThread the index range is split over a ThreadPool (ChunkBegin) and each thread runs the Simd path
+enum class ExpressionBackend { Scalar, Simd, MultiThread };
+
+namespace ExpressionDetail {
+    // 4 KiB of doubles: the block and the input lines it was computed from stay in L1
+    constexpr std::size_t BlockSize = 512;
+
+    // Calls reduce(block, n) on consecutive blocks holding expr[begin, end)
+    template <VectorExpression E, typename Reduce>
+    void ForEachBlock(const E& expr, std::size_t begin, std::size_t end, Reduce&& reduce) {
+        if constexpr (std::is_same_v<E, ExpressionView>) {
+            if (begin < end) {
+                reduce(expr.data() + begin, end - begin);
+            }
+        }
+        else {
+            alignas(64) double block[BlockSize];
+            const std::size_t lead = expr.Lead();
+            for (std::size_t i = begin; i < end; i += BlockSize) {
+                const std::size_t n = std::min(BlockSize, end - i);
+                std::size_t k = 0;
+                for (; k < n && i + k < lead; ++k) {
+                    block[k] = expr[i + k];
+                }
+                for (; k < n; ++k) {
+                    block[k] = expr.At(i + k);
+                }
+                reduce(static_cast<const double*>(block), n);
+            }
+        }
+    }
+
+    // Runs partial(begin, end) -> R on the backend's ranges and folds the results in index order with merge
+    template <typename R, VectorExpression E, typename Partial, typename Merge>
+    R Reduce(const E& expr, R init, ExpressionBackend backend, ThreadPool& pool, Partial&& partial, Merge&& merge) {
+        const std::size_t size = expr.size();
+        if (backend != ExpressionBackend::MultiThread || pool.size() <= 1) {
+            merge(init, partial(std::size_t(0), size));
+            return init;
+        }
+        const unsigned int NumOfThreads = pool.size();
+        std::vector<CacheLinePadded<R>> Partials(NumOfThreads);
+        pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+            Partials[i].value = partial(ChunkBegin(i, size, NumOfThreads), ChunkBegin(i + 1, size, NumOfThreads));
+            });
+        for (const CacheLinePadded<R>& p : Partials) {
+            merge(init, p.value);
+        }
+        return init;
+    }
+}
+
+template <VectorExpression E>
+double Sum(const E& expr, ExpressionBackend backend = ExpressionBackend::Simd, ThreadPool& pool = ThreadPool::Global()) {
+    if (backend == ExpressionBackend::Scalar) {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < expr.size(); ++i) {
+            sum += expr[i];
+        }
+        return sum;
+    }
+    const SimdKernels& kernels = BestSimdKernels();
+    return ExpressionDetail::Reduce<double>(expr, 0.0, backend, pool,
+        [&](std::size_t begin, std::size_t end) {
+            double sum = 0.0;
+            ExpressionDetail::ForEachBlock(expr, begin, end, [&](const double* block, std::size_t n) { sum += kernels.sum(block, n); });
+            return sum;
+        },
+        [](double& total, double part) { total += part; });
+}
+
+// Plain product, no overflow protection (like methods 4 and 19)
+template <VectorExpression E>
+double Product(const E& expr, ExpressionBackend backend = ExpressionBackend::Simd, ThreadPool& pool = ThreadPool::Global()) {
+    if (backend == ExpressionBackend::Scalar) {
+        double product = 1.0;
+        for (std::size_t i = 0; i < expr.size(); ++i) {
+            product *= expr[i];
+        }
+        return product;
+    }
+    const SimdKernels& kernels = BestSimdKernels();
+    return ExpressionDetail::Reduce<double>(expr, 1.0, backend, pool,
+        [&](std::size_t begin, std::size_t end) {
+            double product = 1.0;
+            ExpressionDetail::ForEachBlock(expr, begin, end, [&](const double* block, std::size_t n) { product *= kernels.product(block, n); });
+            return product;
+        },
+        [](double& total, double part) { total *= part; });
+}
+
+// Overflow-safe product (like method 26)
+template <VectorExpression E>
+ScaledProduct ProductScaled(const E& expr, ExpressionBackend backend = ExpressionBackend::Simd, ThreadPool& pool = ThreadPool::Global()) {
+    if (backend == ExpressionBackend::Scalar) {
+        ScaledProduct product;
+        for (std::size_t i = 0; i < expr.size(); ++i) {
+            product.Multiply(expr[i]);
+        }
+        return product;
+    }
+    const SimdKernels& kernels = BestSimdKernels();
+    return ExpressionDetail::Reduce<ScaledProduct>(expr, ScaledProduct(), backend, pool,
+        [&](std::size_t begin, std::size_t end) {
+            ScaledProduct product;
+            ExpressionDetail::ForEachBlock(expr, begin, end, [&](const double* block, std::size_t n) { product.Merge(kernels.scaled_product(block, n)); });
+            return product;
+        },
+        [](ScaledProduct& total, const ScaledProduct& part) { total.Merge(part); });
+}
+
+// Writes the expression into out, which must have expr.size() elements (returns false otherwise).
+// Scalar and Simd run the same fused loop, which the compiler vectorizes; MultiThread splits it over the pool.
+template <VectorExpression E>
+bool Evaluate(const E& expr, std::span<double> out, ExpressionBackend backend = ExpressionBackend::Simd, ThreadPool& pool = ThreadPool::Global()) {
+    const std::size_t size = expr.size();
+    if (out.size() != size) {
+        return false;
+    }
+    const std::size_t lead = expr.Lead();
+    auto Write = [&](std::size_t begin, std::size_t end) {
+        std::size_t i = begin;
+        for (; i < end && i < lead; ++i) {
+            out[i] = expr[i];
+        }
+        for (; i < end; ++i) {
+            out[i] = expr.At(i);
+        }
+    };
+    if (backend != ExpressionBackend::MultiThread || pool.size() <= 1) {
+        Write(0, size);
+        return true;
+    }
+    const unsigned int NumOfThreads = pool.size();
+    pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+        Write(ChunkBegin(i, size, NumOfThreads), ChunkBegin(i + 1, size, NumOfThreads));
+        });
+    return true;
+}
+
+// Resizes out to expr.size() first, like the adjacent difference methods do
+template <VectorExpression E>
+void Evaluate(const E& expr, std::vector<double>& out, ExpressionBackend backend = ExpressionBackend::Simd, ThreadPool& pool = ThreadPool::Global()) {
+    out.resize(expr.size());
+    Evaluate(expr, std::span<double>(out), backend, pool);
+}
+
+#endif
@@ -0,0 +1,259 @@
+#include "VectorFile.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+	const char Magic[8] = {'V', 'E', 'C', 'O', 'P', 'S', '\0', '\1'};
+
+	std::size_t ElementSize(VectorDType dtype) {
+		return dtype == VectorDType::Float32 ? 4 : 8;
+	}
+
+	std::size_t RoundUp(std::size_t value, std::size_t multiple) {
+		return (value + multiple - 1) / multiple * multiple;
+	}
+
+	std::size_t NumOfBlocks(const VectorFileHeader& hdr) {
+		return hdr.checksum_block ? (hdr.length + hdr.checksum_block - 1) / hdr.checksum_block : 0;
+	}
+
+	VectorFileHeader MakeHeader(VectorDType dtype, std::size_t length, const VectorFileOptions& options) {
+		VectorFileHeader hdr{};
+		std::memcpy(hdr.magic, Magic, sizeof(Magic));
+		hdr.dtype = static_cast<std::uint32_t>(dtype);
+		hdr.element_size = static_cast<std::uint32_t>(ElementSize(dtype));
+		hdr.length = length;
+		hdr.alignment = std::max<std::size_t>(options.Alignment, 1);
+		hdr.data_offset = RoundUp(sizeof(VectorFileHeader), hdr.alignment);
+		hdr.checksum_block = options.ChecksumBlock;
+		hdr.checksum_offset = options.ChecksumBlock ? RoundUp(hdr.data_offset + length * hdr.element_size, 8) : 0;
+		return hdr;
+	}
+
+	std::size_t FileSize(const VectorFileHeader& hdr) {
+		return hdr.checksum_block ? hdr.checksum_offset + 8 * NumOfBlocks(hdr) : hdr.data_offset + hdr.length * hdr.element_size;
+	}
+
+	// Checks a header read from a file of `size` bytes; every offset is checked against the size before use
+	bool IsValidHeader(const VectorFileHeader& hdr, std::size_t size) {
+		if (size < sizeof(VectorFileHeader) || std::memcmp(hdr.magic, Magic, sizeof(Magic)) != 0) {
+			return false;
+		}
+		if (hdr.dtype < 1 || hdr.dtype > 3 || hdr.element_size != ElementSize(static_cast<VectorDType>(hdr.dtype))) {
+			return false;
+		}
+		if (hdr.alignment == 0 || hdr.data_offset < sizeof(VectorFileHeader) || hdr.data_offset % hdr.alignment != 0 || hdr.data_offset > size) {
+			return false;
+		}
+		if (hdr.length > (size - hdr.data_offset) / hdr.element_size) {
+			return false;
+		}
+		if (hdr.checksum_block == 0) {
+			return true;
+		}
+		const std::size_t DataEnd = hdr.data_offset + hdr.length * hdr.element_size;
+		return hdr.checksum_offset >= DataEnd && hdr.checksum_offset <= size && NumOfBlocks(hdr) <= (size - hdr.checksum_offset) / 8;
+	}
+
+	std::size_t PageSize() {
+		static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		return size;
+	}
+}
+
+std::uint64_t VectorFileChecksum(const void* data, std::size_t bytes) {
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	std::uint64_t hash = 14695981039346656037ull;
+	std::size_t i = 0;
+	for (; i + 8 <= bytes; i += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, p + i, 8);
+		hash = (hash ^ word) * 1099511628211ull;
+	}
+	for (; i < bytes; ++i) {
+		hash = (hash ^ p[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+template <typename T>
+bool WriteVectorFile(const std::string& path, std::span<const T> data, const VectorFileOptions& options) {
+	const VectorFileHeader hdr = MakeHeader(VectorDTypeOf<T>(), data.size(), options);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	const std::vector<char> padding(std::max<std::size_t>(hdr.data_offset, 8), 0);
+	file.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+	file.write(padding.data(), hdr.data_offset - sizeof(hdr));
+	file.write(reinterpret_cast<const char*>(data.data()), data.size_bytes());
+	if (hdr.checksum_block) {
+		const std::size_t DataEnd = hdr.data_offset + data.size_bytes();
+		file.write(padding.data(), hdr.checksum_offset - DataEnd);
+		for (std::size_t start = 0; start < data.size(); start += hdr.checksum_block) {
+			const std::size_t count = std::min<std::size_t>(hdr.checksum_block, data.size() - start);
+			const std::uint64_t checksum = VectorFileChecksum(data.data() + start, count * sizeof(T));
+			file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+		}
+	}
+	return static_cast<bool>(file);
+}
+
+template <typename T>
+bool ReadVectorFile(const std::string& path, std::vector<T>& data) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	const std::size_t size = static_cast<std::size_t>(file.tellg());
+	VectorFileHeader hdr{};
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)) || !IsValidHeader(hdr, size) || hdr.dtype != static_cast<std::uint32_t>(VectorDTypeOf<T>())) {
+		return false;
+	}
+	data.resize(hdr.length);
+	file.seekg(hdr.data_offset);
+	return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), hdr.length * sizeof(T)));
+}
+
+template bool WriteVectorFile<double>(const std::string&, std::span<const double>, const VectorFileOptions&);
+template bool WriteVectorFile<float>(const std::string&, std::span<const float>, const VectorFileOptions&);
+template bool WriteVectorFile<std::int64_t>(const std::string&, std::span<const std::int64_t>, const VectorFileOptions&);
+template bool ReadVectorFile<double>(const std::string&, std::vector<double>&);
+template bool ReadVectorFile<float>(const std::string&, std::vector<float>&);
+template bool ReadVectorFile<std::int64_t>(const std::string&, std::vector<std::int64_t>&);
+
+MappedVectorFile::MappedVectorFile(const std::string& path) {
+	fd = open(path.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(VectorFileHeader)) {
+		return;
+	}
+	map_size = static_cast<std::size_t>(st.st_size);
+	map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		map = nullptr;
+		return;
+	}
+	std::memcpy(&hdr, map, sizeof(hdr));
+	valid = IsValidHeader(hdr, map_size);
+}
+
+MappedVectorFile::MappedVectorFile(const std::string& path, VectorDType dtype, std::size_t length, const VectorFileOptions& options)
+	: writable(true), hdr(MakeHeader(dtype, length, options)) {
+	map_size = FileSize(hdr);
+	fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || ftruncate(fd, static_cast<off_t>(map_size)) != 0) {
+		return;
+	}
+	map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		map = nullptr;
+		return;
+	}
+	std::memcpy(map, &hdr, sizeof(hdr));
+	valid = true;
+}
+
+MappedVectorFile::~MappedVectorFile() {
+	if (map) {
+		munmap(map, map_size);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+template <typename T>
+std::span<const T> MappedVectorFile::data() const {
+	if (!valid || dtype() != VectorDTypeOf<T>()) {
+		return {};
+	}
+	return std::span<const T>(reinterpret_cast<const T*>(Bytes() + hdr.data_offset), hdr.length);
+}
+
+template <typename T>
+std::span<T> MappedVectorFile::MutableData() {
+	if (!writable || !valid || dtype() != VectorDTypeOf<T>()) {
+		return {};
+	}
+	return std::span<T>(reinterpret_cast<T*>(static_cast<unsigned char*>(map) + hdr.data_offset), hdr.length);
+}
+
+template std::span<const double> MappedVectorFile::data<double>() const;
+template std::span<const float> MappedVectorFile::data<float>() const;
+template std::span<const std::int64_t> MappedVectorFile::data<std::int64_t>() const;
+template std::span<double> MappedVectorFile::MutableData<double>();
+template std::span<float> MappedVectorFile::MutableData<float>();
+template std::span<std::int64_t> MappedVectorFile::MutableData<std::int64_t>();
+
+bool MappedVectorFile::VerifyChecksums(ThreadPool& pool) const {
+	if (!HasChecksums()) {
+		return valid;
+	}
+	const std::size_t blocks = NumOfBlocks(hdr);
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<bool>> Mismatch(NumOfThreads);
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		for (std::size_t block = ChunkBegin(i, blocks, NumOfThreads); block < ChunkBegin(i + 1, blocks, NumOfThreads); ++block) {
+			const std::size_t start = block * hdr.checksum_block;
+			const std::size_t count = std::min<std::size_t>(hdr.checksum_block, hdr.length - start);
+			std::uint64_t stored;
+			std::memcpy(&stored, Bytes() + hdr.checksum_offset + 8 * block, 8);
+			if (VectorFileChecksum(Bytes() + hdr.data_offset + start * hdr.element_size, count * hdr.element_size) != stored) {
+				Mismatch[i].value = true;
+				return;
+			}
+		}
+		});
+	return std::none_of(Mismatch.begin(), Mismatch.end(), [](const CacheLinePadded<bool>& slot) { return slot.value; });
+}
+
+void MappedVectorFile::UpdateChecksums(ThreadPool& pool) {
+	if (!writable || !HasChecksums()) {
+		return;
+	}
+	unsigned char* bytes = static_cast<unsigned char*>(map);
+	const std::size_t blocks = NumOfBlocks(hdr);
+	const unsigned int NumOfThreads = pool.size();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		for (std::size_t block = ChunkBegin(i, blocks, NumOfThreads); block < ChunkBegin(i + 1, blocks, NumOfThreads); ++block) {
+			const std::size_t start = block * hdr.checksum_block;
+			const std::size_t count = std::min<std::size_t>(hdr.checksum_block, hdr.length - start);
+			const std::uint64_t checksum = VectorFileChecksum(bytes + hdr.data_offset + start * hdr.element_size, count * hdr.element_size);
+			std::memcpy(bytes + hdr.checksum_offset + 8 * block, &checksum, 8);
+		}
+		});
+}
+
+void MappedVectorFile::Advise(std::size_t begin, std::size_t end, int advice) const {
+	if (!valid || begin >= end) {
+		return;
+	}
+	// Whole pages only: rounding the start down and the end up covers the partial pages at both ends
+	const std::size_t first = (hdr.data_offset + begin * hdr.element_size) / PageSize() * PageSize();
+	const std::size_t last = std::min(map_size, RoundUp(hdr.data_offset + end * hdr.element_size, PageSize()));
+	madvise(static_cast<unsigned char*>(map) + first, last - first, advice);
+}
+
+void MappedVectorFile::AdviseSequential() const {
+	Advise(0, hdr.length, MADV_SEQUENTIAL);
+}
+
+void MappedVectorFile::WillNeed(std::size_t begin, std::size_t end) const {
+	Advise(begin, end, MADV_WILLNEED);
+}
+
+void MappedVectorFile::Release(std::size_t begin, std::size_t end) const {
+	Advise(begin, end, MADV_DONTNEED);
+}
+
+bool MappedVectorFile::Sync() const {
+	return writable && valid && msync(map, map_size, MS_SYNC) == 0;
+}
@@ -0,0 +1,103 @@
+#ifndef VECTORFILE_H
+#define VECTORFILE_H
+
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+
+// Binary vector file, in the byte order of the host (little-endian on x86):
+//   [0, 64)                                   VectorFileHeader
+//   [data_offset, data_offset + length * element_size)     the elements; data_offset is a multiple of alignment
+//   [checksum_offset, checksum_offset + 8 * NumOfBlocks)   optional: one checksum per checksum_block elements
+// A checksum is the 64-bit FNV-1a hash of the block taken as 8-byte words (the last block may be shorter).
+enum class VectorDType : std::uint32_t { Float64 = 1, Float32 = 2, Int64 = 3 };
+
+struct VectorFileHeader {
+    char magic[8];                  // "VECOPS\0" followed by the format version, 1
+    std::uint32_t dtype;            // VectorDType
+    std::uint32_t element_size;     // bytes per element
+    std::uint64_t length;           // number of elements
+    std::uint64_t alignment;        // of data_offset, in bytes
+    std::uint64_t data_offset;
+    std::uint64_t checksum_block;   // elements per checksum, 0 = no checksums
+    std::uint64_t checksum_offset;  // 0 if there are no checksums
+    std::uint64_t reserved;
+};
+static_assert(sizeof(VectorFileHeader) == 64, "the header is 64 bytes on disk");
+
+template <typename T> constexpr VectorDType VectorDTypeOf();
+template <> constexpr VectorDType VectorDTypeOf<double>() { return VectorDType::Float64; }
+template <> constexpr VectorDType VectorDTypeOf<float>() { return VectorDType::Float32; }
+template <> constexpr VectorDType VectorDTypeOf<std::int64_t>() { return VectorDType::Int64; }
+
+struct VectorFileOptions {
+    std::size_t Alignment = 4096;   // a page, so the mapped data starts on a page boundary
+    std::size_t ChecksumBlock = 0;  // elements per checksum, 0 = no checksums
+};
+
+// Writes data to `path` in the format above; false if the file cannot be written
+template <typename T>
+bool WriteVectorFile(const std::string& path, std::span<const T> data, const VectorFileOptions& options = {});
+// Reads a whole file of element type T into `data` (the read-into-memory alternative to MappedVectorFile);
+// false if it is missing, malformed or of another element type
+template <typename T>
+bool ReadVectorFile(const std::string& path, std::vector<T>& data);
+
+// A vector file mapped into memory. The data is paged in from the file on first access and never copied,
+// so the file can be larger than RAM; the kernel drops clean pages again under memory pressure.
+class MappedVectorFile {
+public:
+    // Maps an existing file read-only. IsValid() is false if it is missing, truncated or not in this format.
+    explicit MappedVectorFile(const std::string& path);
+    // Creates (or replaces) `path` with `length` zero elements of `dtype`, mapped read-write
+    MappedVectorFile(const std::string& path, VectorDType dtype, std::size_t length, const VectorFileOptions& options = {});
+    ~MappedVectorFile();
+    MappedVectorFile(const MappedVectorFile&) = delete;
+    MappedVectorFile& operator=(const MappedVectorFile&) = delete;
+
+    bool IsValid() const { return valid; }
+    const VectorFileHeader& header() const { return hdr; }
+    VectorDType dtype() const { return static_cast<VectorDType>(hdr.dtype); }
+    std::size_t size() const { return hdr.length; }
+
+    // The elements, or an empty span if the file is invalid or holds another element type
+    template <typename T>
+    std::span<const T> data() const;
+    // Same for a file created read-write; empty for a read-only one
+    template <typename T>
+    std::span<T> MutableData();
+
+    bool HasChecksums() const { return valid && hdr.checksum_block > 0; }
+    // Recomputes the checksum of every block on the pool; false if one differs (true without checksums)
+    bool VerifyChecksums(ThreadPool& pool = ThreadPool::Global()) const;
+    // Stores the checksums of the current data, for a file created read-write with ChecksumBlock > 0
+    void UpdateChecksums(ThreadPool& pool = ThreadPool::Global());
+
+    // madvise hints on the pages holding elements [begin, end): sequential access over the whole file,
+    // WillNeed starts the readahead of a range, Release unmaps a processed range (the data stays in the file
+    // and the page cache, so it is read again on the next access)
+    void AdviseSequential() const;
+    void WillNeed(std::size_t begin, std::size_t end) const;
+    void Release(std::size_t begin, std::size_t end) const;
+    // Writes the modified pages of a read-write file to disk and waits for it
+    bool Sync() const;
+
+private:
+    void Advise(std::size_t begin, std::size_t end, int advice) const;
+    const unsigned char* Bytes() const { return static_cast<const unsigned char*>(map); }
+
+    int fd = -1;
+    void* map = nullptr;
+    std::size_t map_size = 0;
+    bool writable = false;
+    bool valid = false;
+    VectorFileHeader hdr{};
+};
+
+// 64-bit FNV-1a over 8-byte words (then the remaining bytes), the block checksum of the format
+std::uint64_t VectorFileChecksum(const void* data, std::size_t bytes);
+
+#endif
@@ -1,14 +1,18 @@
 #include "VectorOperations.h"
+#include "SimdKernels.h"
+#include "PerfCounters.h"
 #include <numeric>
 #include <functional>
 #include <thread>
 #include <future>
 #include <mutex>
 #include <omp.h>
+#include <algorithm>
 
 // Method (1) Simple summation
 double SimpleVectorOperations::sum1(bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	double sum = 0;
 	for (const auto& val : vec)
 		sum += val;
@@ -17,6 +21,7 @@ double SimpleVectorOperations::sum1(bool Time) const {
 // Method (2) std::acumulate summation
 double SimpleVectorOperations::sum2(bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	double sum = 0;
 	sum = std::accumulate(vec.begin(), vec.end(), 0.0);
 	return sum;
@@ -24,6 +29,7 @@ double SimpleVectorOperations::sum2(bool Time) const {
 // Method (3) compensated summation
 double SimpleVectorOperations::KahanSummation(bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	double sum = 0.0;
 	double c = 0.0; // A running compensation for lost low-order bits.
 	for (const auto& num : vec) {
@@ -38,6 +44,7 @@ double SimpleVectorOperations::KahanSummation(bool Time) const {
 // Method (4) Simple product
 double SimpleVectorOperations::product1(bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	double prod = 1.0;
 	for (const auto& val : vec) {
 		prod *= val;
@@ -47,6 +54,7 @@ double SimpleVectorOperations::product1(bool Time) const {
 // Method (5) std::acumulate product
 double SimpleVectorOperations::product2(bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	double prod = 0.0;
 	prod = std::accumulate(vec.begin(), vec.end(), 1.0, std::multiplies<double>());
 	return prod;
@@ -54,6 +62,8 @@ double SimpleVectorOperations::product2(bool Time) const {
 // Method (6) Simple adjacent difference 
 void SimpleVectorOperations::adjacent_difference1(std::vector<double>& diff, bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	diff.reserve(diff.size() + (vec.empty() ? 0 : vec.size() - 1));
 	for (std::size_t i = 1; i < vec.size(); ++i) {
 		diff.push_back(vec[i] - vec[i - 1]);
 	}
@@ -61,20 +71,138 @@ void SimpleVectorOperations::adjacent_difference1(std::vector<double>& diff, boo
 // Method (7) std::adjacent difference 
 void SimpleVectorOperations::adjacent_difference2(std::vector<double>& diff, bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	diff.resize(vec.size());
 	std::adjacent_difference(vec.begin(), vec.end(), diff.begin());
 }
 // Method (8) Simple adjacent difference using array 
 void SimpleVectorOperations::adjacent_difference3(std::unique_ptr<double[]>& diff, bool Time) const {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	for (std::size_t i = 1; i < vec.size(); ++i) {
 		diff[i - 1] = vec[i] - vec[i - 1];
 	}
 }
+// Method (18) SIMD summation, several independent vector accumulators
+double SimpleVectorOperations::sumSimd(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return BestSimdKernels().sum(vec.data(), vec.size());
+}
+// Method (19) SIMD product, several independent vector accumulators
+double SimpleVectorOperations::productSimd(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return BestSimdKernels().product(vec.data(), vec.size());
+}
+// Method (20) SIMD adjacent difference, same layout as method 7 (diff[0] = vec[0])
+void SimpleVectorOperations::adjacent_differenceSimd(std::vector<double>& diff, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	diff.resize(vec.size());
+	if (vec.empty()) {
+		return;
+	}
+	diff[0] = vec[0];
+	BestSimdKernels().adjacent_difference(vec.data(), vec.size(), diff.data());
+}
+// Method (21) Neumaier compensated summation, one (sum, compensation) pair per SIMD lane
+double SimpleVectorOperations::NeumaierSummationSimd(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return BestSimdKernels().compensated_sum(vec.data(), vec.size()).Result();
+}
+
+// Helper function used for method (22): halves the range down to blocks the SIMD kernel sums directly
+namespace
+{
+	constexpr std::size_t PairwiseBlock = 256;
+
+	double PairwiseSum(const double* data, std::size_t size, const SimdKernels& kernels) {
+		if (size <= PairwiseBlock) {
+			return kernels.sum(data, size);
+		}
+		// Split on a block boundary so that every leaf but the last one is a full block
+		const std::size_t half = (size / PairwiseBlock + 1) / 2 * PairwiseBlock;
+		return PairwiseSum(data, half, kernels) + PairwiseSum(data + half, size - half, kernels);
+	}
+}
+
+// Method (22) Blocked pairwise summation
+double SimpleVectorOperations::PairwiseSummation(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return PairwiseSum(vec.data(), vec.size(), BestSimdKernels());
+}
+
+// Method (56) Exact summation, correctly rounded
+double SimpleVectorOperations::ExactSum(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return SuperaccumulatorOf(vec.data(), vec.size()).Result();
+}
+
+// Method (26) Overflow-safe product with mantissa/exponent scaling
+ScaledProduct SimpleVectorOperations::productScaled(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return ScaledProductOf(vec.data(), vec.size());
+}
+
+// Method (28) Fused statistics (sum, compensated sum, product, min/max, mean, variance) in one pass
+VectorStatistics SimpleVectorOperations::Statistics(unsigned int flags, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return ComputeStatistics(vec.data(), vec.size(), flags);
+}
+
+// Method (30) SIMD inclusive prefix sum
+void SimpleVectorOperations::inclusive_scanSimd(std::vector<double>& out, double init, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	out.resize(vec.size());
+	BestSimdKernels().inclusive_scan(vec.data(), vec.size(), out.data(), init);
+}
+// Method (31) SIMD exclusive prefix sum: out[0] = init, then the inclusive scan of vec[0, size - 1) shifted by one
+void SimpleVectorOperations::exclusive_scanSimd(std::vector<double>& out, double init, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	out.resize(vec.size());
+	if (vec.empty()) {
+		return;
+	}
+	out[0] = init;
+	BestSimdKernels().inclusive_scan(vec.data(), vec.size() - 1, out.data() + 1, init);
+}
+// Method (58) SIMD adjacent difference into caller memory, non-temporal stores beyond the last-level cache
+bool SimpleVectorOperations::adjacent_differenceInto(std::span<double> diff, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	if (diff.size() != vec.size()) {
+		return false;
+	}
+	if (vec.empty()) {
+		return true;
+	}
+	diff[0] = vec[0];
+	const SimdKernels& kernels = BestSimdKernels();
+	(UseNonTemporalStores(vec.size()) ? kernels.adjacent_difference_stream : kernels.adjacent_difference)(vec.data(), vec.size(), diff.data());
+	return true;
+}
+// Method (59) Method 58 into a buffer recycled by the arena
+BufferArena::Lease SimpleVectorOperations::adjacent_differenceArena(BufferArena& arena, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	BufferArena::Lease diff = arena.Acquire(vec.size());
+	adjacent_differenceInto(diff.span(), false);
+	return diff;
+}
+
 // Method (9) Multi threaded summation using lambda function
 double MultiThreadVectorOperations::ComputeSumMultiThreadSum1(bool Time) {
 	Timer timeit(Time);
-	size_t NumOfThreads = std::thread::hardware_concurrency();
+	ProfileScope profile(__func__);
+	size_t NumOfThreads = NumOfSpawnedThreads;
 	std::vector<std::thread> threads;
 	std::vector<double> Partial_Sums(NumOfThreads);
 	auto begin = vec.begin();
@@ -86,6 +214,7 @@ double MultiThreadVectorOperations::ComputeSumMultiThreadSum1(bool Time) {
 		auto thread_begin = begin + i * step;
 		auto thread_end = i == NumOfThreads - 1 ? vec.end() : (begin + (i + 1) * step);
 		threads.push_back(std::thread([&, thread_begin, thread_end, i]() {
+			auto span = profile.Span(i);
 			double sum = std::accumulate(thread_begin, thread_end, 0.0);
 			Partial_Sums[i] = sum;
 			}));
@@ -102,11 +231,11 @@ double MultiThreadVectorOperations::ComputeSumMultiThreadSum1(bool Time) {
 
 // Functor used for method (10)
 struct SumHelper {
-	std::vector<double>::const_iterator begin;
-	std::vector<double>::const_iterator end;
+	std::span<const double>::iterator begin;
+	std::span<const double>::iterator end;
 	double& result;
 
-	SumHelper(std::vector<double>::const_iterator begin, std::vector<double>::const_iterator end, double& result)
+	SumHelper(std::span<const double>::iterator begin, std::span<const double>::iterator end, double& result)
 		: begin(begin), end(end), result(result) {}
 	void operator()() {
 		result = std::accumulate(begin, end, 0.0);
@@ -116,7 +245,8 @@ struct SumHelper {
 // Method (10) Multi threaded summation using Functor
 double MultiThreadVectorOperations::ComputeSumMultiThreadSum2(bool Time) {
 	Timer timeit(Time);
-	unsigned int NumOfThreads = std::thread::hardware_concurrency();
+	ProfileScope profile(__func__);
+	unsigned int NumOfThreads = NumOfSpawnedThreads;
 	std::vector<std::thread> threads(NumOfThreads);
 	std::vector<double> results(NumOfThreads);
 	std::vector<std::unique_ptr<SumHelper>> helpers;
@@ -128,7 +258,10 @@ double MultiThreadVectorOperations::ComputeSumMultiThreadSum2(bool Time) {
 		auto thread_begin = begin + i * step;
 		auto thread_end = i == NumOfThreads - 1 ? vec.end() : (begin + (i + 1) * step);
 		helpers.push_back(std::make_unique<SumHelper>(thread_begin, thread_end, results[i]));
-		threads[i] = std::thread(std::ref(*helpers[i]));
+		threads[i] = std::thread([&profile, &helper = *helpers[i], i] {
+			auto span = profile.Span(i);
+			helper();
+			});
 	}
 
 	for (auto& t : threads) {
@@ -152,7 +285,8 @@ void MultiThreadVectorOperations::CalculatePartialSum(unsigned int start, unsign
 double MultiThreadVectorOperations::ComputeSumMultiThreadSum3(bool Time) {
 	sum = 0.0;
 	Timer timeit(Time);
-	unsigned int NumOfThreads = std::thread::hardware_concurrency();
+	ProfileScope profile(__func__);
+	unsigned int NumOfThreads = NumOfSpawnedThreads;
 	std::vector<std::future<void>> futures(NumOfThreads);
 	auto begin = vec.begin();
 	const auto step = vec.size() / NumOfThreads;
@@ -160,7 +294,10 @@ double MultiThreadVectorOperations::ComputeSumMultiThreadSum3(bool Time) {
 	for (unsigned int i = 0; i < NumOfThreads; i++) {
 		unsigned int start = i * (vec.size() / NumOfThreads);
 		unsigned int end = (i + 1) == NumOfThreads ? vec.size() : (i + 1) * (vec.size() / NumOfThreads);
-		futures[i] = std::async(std::launch::async, &MultiThreadVectorOperations::CalculatePartialSum, this, start, end);
+		futures[i] = std::async(std::launch::async, [this, &profile, start, end, i] {
+			auto span = profile.Span(i);
+			CalculatePartialSum(start, end);
+			});
 	}
 
 	for (auto& fut : futures) {
@@ -173,17 +310,19 @@ double MultiThreadVectorOperations::ComputeSumMultiThreadSum3(bool Time) {
 // Method (12) to compute the product of values in a vector using multithreading
 double MultiThreadVectorOperations::ComputeSumMultiThreadProduct(bool Time) {
 	Timer timeit(Time);
+	ProfileScope profile(__func__);
 	std::mutex mtx;
 	double product = 1.0;
 
 	// Get number of supported threads
-	unsigned int num_threads = std::thread::hardware_concurrency();
+	unsigned int num_threads = NumOfSpawnedThreads;
 
 	// Vector of futures
 	std::vector<std::future<void>> futures(num_threads);
 
 	for (unsigned int i = 0; i < num_threads; ++i) {
-		futures[i] = std::async(std::launch::async, [&](unsigned int start, unsigned int end) {
+		futures[i] = std::async(std::launch::async, [&, i](unsigned int start, unsigned int end) {
+			auto span = profile.Span(i);
 			double partial_product = std::accumulate(vec.begin() + start, vec.begin() + end, 1.0, std::multiplies<double>());
 			std::lock_guard<std::mutex> lock(mtx);
 			product *= partial_product;
@@ -200,7 +339,8 @@ double MultiThreadVectorOperations::ComputeSumMultiThreadProduct(bool Time) {
 // Method (13) to compute the difference between adjacent values in a vector using async
 void MultiThreadVectorOperations::ComputeAdjDiffMultiThread1(std::vector<double>& diff, bool Time) const {
 	Timer timeit(Time);
-	unsigned int NumOfThreads = std::thread::hardware_concurrency();
+	ProfileScope profile(__func__);
+	unsigned int NumOfThreads = NumOfSpawnedThreads;
 	std::vector<std::future<void>> futures(NumOfThreads);
 	size_t vec_size = vec.size();
 	size_t step = vec_size / NumOfThreads;
@@ -211,7 +351,8 @@ void MultiThreadVectorOperations::ComputeAdjDiffMultiThread1(std::vector<double>
 	for (unsigned int i = 0; i < NumOfThreads; ++i) {
 		start = end;
 		end = start + step + (i < remaining ? 1 : 0); // Distribute remaining elements among the first few threads
-		futures[i] = std::async(std::launch::async, [&diff, this, start, end, i] {
+		futures[i] = std::async(std::launch::async, [&diff, &profile, this, start, end, i] {
+			auto span = profile.Span(i);
 			std::adjacent_difference(this->vec.begin() + start, this->vec.begin() + end, diff.begin() + start);
 			});
 	}
@@ -234,12 +375,14 @@ void MultiThreadVectorOperations::ComputeAdjDiffMultiThread1(std::vector<double>
 // Method (14) to compute the difference between adjacent values in a vector using async
 void MultiThreadVectorOperations::ComputeAdjDiffMultiThread2(std::vector<double>& diff, bool Time) const {
 	Timer timeit(Time);
-	unsigned int NumOfThreads = omp_get_max_threads();
+	ProfileScope profile(__func__);
+	unsigned int NumOfThreads = NumOfSpawnedThreads;
 	unsigned int step = vec.size() / NumOfThreads;
 
 	// Step 1: Compute adjacent differences in parallel, ignoring boundaries between subsets
-#pragma omp parallel for
+#pragma omp parallel for num_threads(NumOfThreads)
 	for (unsigned int i = 0; i < NumOfThreads; ++i) {
+		auto span = profile.Span(i);
 		auto thread_begin = vec.begin() + i * step;
 		auto thread_end = (i + 1 == NumOfThreads) ? vec.end() : vec.begin() + (i + 1) * step;
 		std::adjacent_difference(thread_begin, thread_end, diff.begin() + i * step);
@@ -250,3 +393,334 @@ void MultiThreadVectorOperations::ComputeAdjDiffMultiThread2(std::vector<double>
 		diff[i * step] = vec[i * step] - vec[i * step - 1];
 	}
 }
+
+// Method (15) Multi threaded summation on the persistent thread pool
+double MultiThreadVectorOperations::ComputeSumThreadPool(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<double>> Partial_Sums(NumOfThreads);
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		Partial_Sums[i].value = kernels.sum(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start);
+		});
+	double total_sum = 0.0;
+	for (const auto& partial : Partial_Sums) {
+		total_sum += partial.value;
+	}
+	return total_sum;
+}
+
+// Method (16) Multi threaded product on the persistent thread pool
+double MultiThreadVectorOperations::ComputeProductThreadPool(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<double>> Partial_Products(NumOfThreads);
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		Partial_Products[i].value = kernels.product(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start);
+		});
+	double product = 1.0;
+	for (const auto& partial : Partial_Products) {
+		product *= partial.value;
+	}
+	return product;
+}
+
+// Method (17) Multi threaded adjacent difference on the persistent thread pool
+// Same output layout as methods 13 and 14: diff[0] = vec[0], diff[i] = vec[i] - vec[i - 1]
+void MultiThreadVectorOperations::ComputeAdjDiffThreadPool(std::vector<double>& diff, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		const std::size_t end = ChunkBegin(i + 1, vec.size(), NumOfThreads);
+		if (start == end) {
+			return;
+		}
+		// Each chunk computes its own boundary element, so no correction pass is needed
+		diff[start] = start == 0 ? vec[0] : vec[start] - vec[start - 1];
+		kernels.adjacent_difference(vec.data() + start, end - start, diff.data() + start);
+		});
+}
+
+// Method (23) Multi threaded compensated summation on the persistent thread pool
+// Each thread returns its (sum, compensation) pair, and the pairs are merged without dropping the compensations
+double MultiThreadVectorOperations::ComputeCompensatedSumThreadPool(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<CompensatedSum>> Partial_Sums(NumOfThreads);
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		Partial_Sums[i].value = kernels.compensated_sum(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start);
+		});
+	CompensatedSum total;
+	for (const auto& partial : Partial_Sums) {
+		total.Merge(partial.value);
+	}
+	return total.Result();
+}
+
+// Method (57) Multi threaded exact summation on the persistent thread pool
+// Each thread fills its own superaccumulator; merging them is exact, so the result is the same for any pool size
+double MultiThreadVectorOperations::ComputeExactSumThreadPool(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<Superaccumulator>> Partial_Sums(NumOfThreads);
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		kernels.superaccumulate(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start, Partial_Sums[i].value);
+		});
+	Superaccumulator total;
+	for (const auto& partial : Partial_Sums) {
+		total.Merge(partial.value);
+	}
+	return total.Result();
+}
+
+// Helpers used for methods (24) and (25)
+namespace
+{
+	// Fixed block size: the reduction order depends on it, never on the number of threads
+	constexpr std::size_t DeterministicBlock = 8192;
+
+	// Pairwise tree over values[begin, end), split where only the count decides
+	template <typename Op>
+	double TreeReduce(const std::vector<double>& values, std::size_t begin, std::size_t end, Op op) {
+		if (end - begin == 1) {
+			return values[begin];
+		}
+		const std::size_t middle = begin + (end - begin + 1) / 2;
+		return op(TreeReduce(values, begin, middle, op), TreeReduce(values, middle, end, op));
+	}
+
+	// Reduces every block with `kernel` on the pool (any thread may take any block), then the block results with `op`
+	template <typename Op>
+	double DeterministicReduce(std::span<const double> vec, ThreadPool& pool, double (*kernel)(const double*, std::size_t), double identity, Op op) {
+		const std::size_t NumOfBlocks = (vec.size() + DeterministicBlock - 1) / DeterministicBlock;
+		if (NumOfBlocks == 0) {
+			return identity;
+		}
+		std::vector<double> Block_Results(NumOfBlocks);
+		const unsigned int NumOfTasks = static_cast<unsigned int>(std::min<std::size_t>(pool.size(), NumOfBlocks));
+		pool.ParallelFor(NumOfTasks, [&](unsigned int i) {
+			for (std::size_t block = ChunkBegin(i, NumOfBlocks, NumOfTasks); block < ChunkBegin(i + 1, NumOfBlocks, NumOfTasks); ++block) {
+				const std::size_t start = block * DeterministicBlock;
+				Block_Results[block] = kernel(vec.data() + start, std::min(DeterministicBlock, vec.size() - start));
+			}
+			});
+		return TreeReduce(Block_Results, 0, NumOfBlocks, op);
+	}
+}
+
+// Method (24) Deterministic multi threaded summation, bit-identical for any thread count
+double MultiThreadVectorOperations::ComputeSumDeterministic(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return DeterministicReduce(vec, pool, BestSimdKernels().ordered_sum, 0.0, std::plus<double>());
+}
+
+// Method (25) Deterministic multi threaded product, bit-identical for any thread count
+double MultiThreadVectorOperations::ComputeProductDeterministic(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	return DeterministicReduce(vec, pool, BestSimdKernels().ordered_product, 1.0, std::multiplies<double>());
+}
+
+// Method (27) Multi threaded overflow-safe product on the persistent thread pool
+// Every thread writes its own partial ScaledProduct; they are merged once all threads are done, no mutex needed
+ScaledProduct MultiThreadVectorOperations::ComputeProductScaledThreadPool(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<ScaledProduct>> Partial_Products(NumOfThreads);
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		Partial_Products[i].value = ScaledProductOf(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start);
+		});
+	ScaledProduct product;
+	for (const auto& partial : Partial_Products) {
+		product.Merge(partial.value);
+	}
+	return product;
+}
+
+// Method (29) Multi threaded fused statistics on the persistent thread pool
+// Each thread computes the statistics of its chunk; the chunks are merged in order, so ties in min/max keep the first index
+VectorStatistics MultiThreadVectorOperations::ComputeStatisticsThreadPool(unsigned int flags, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const unsigned int NumOfThreads = pool.size();
+	std::vector<CacheLinePadded<VectorStatistics>> Partial_Statistics(NumOfThreads);
+	pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+		Partial_Statistics[i].value = ComputeStatistics(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start, flags, start);
+		});
+	VectorStatistics statistics = ComputeStatistics(nullptr, 0, flags);
+	for (const auto& partial : Partial_Statistics) {
+		statistics.Merge(partial.value);
+	}
+	return statistics;
+}
+
+// Helper used for methods (32) and (33)
+namespace
+{
+	void ScanThreadPool(std::span<const double> vec, double* out, double init, bool Exclusive, ThreadPool& pool) {
+		const unsigned int NumOfThreads = pool.size();
+		const SimdKernels& kernels = BestSimdKernels();
+		// Pass 1: sum of every chunk but the last one, whose sum no other chunk needs
+		std::vector<CacheLinePadded<double>> Offsets(NumOfThreads);
+		pool.ParallelFor(NumOfThreads - 1, [&](unsigned int i) {
+			const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+			Offsets[i].value = kernels.sum(vec.data() + start, ChunkBegin(i + 1, vec.size(), NumOfThreads) - start);
+			});
+		// Exclusive scan of the chunk sums: chunk i starts from init plus the sums of the chunks before it
+		double offset = init;
+		for (auto& partial : Offsets) {
+			const double chunk_sum = partial.value;
+			partial.value = offset;
+			offset += chunk_sum;
+		}
+		// Pass 2: every chunk scans its own elements from its offset; the chunks write disjoint ranges of out
+		pool.ParallelFor(NumOfThreads, [&](unsigned int i) {
+			const std::size_t start = ChunkBegin(i, vec.size(), NumOfThreads);
+			const std::size_t end = ChunkBegin(i + 1, vec.size(), NumOfThreads);
+			if (start == end) {
+				return;
+			}
+			if (Exclusive) {
+				out[start] = Offsets[i].value;
+				kernels.inclusive_scan(vec.data() + start, end - start - 1, out + start + 1, Offsets[i].value);
+			}
+			else {
+				kernels.inclusive_scan(vec.data() + start, end - start, out + start, Offsets[i].value);
+			}
+			});
+	}
+}
+
+// Method (32) Multi threaded inclusive prefix sum on the persistent thread pool
+void MultiThreadVectorOperations::ComputeInclusiveScanThreadPool(std::vector<double>& out, double init, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	out.resize(vec.size());
+	ScanThreadPool(vec, out.data(), init, false, pool);
+}
+
+// Method (33) Multi threaded exclusive prefix sum on the persistent thread pool
+void MultiThreadVectorOperations::ComputeExclusiveScanThreadPool(std::vector<double>& out, double init, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	out.resize(vec.size());
+	ScanThreadPool(vec, out.data(), init, true, pool);
+}
+
+// Method (41) Multi threaded summation on the work-stealing scheduler
+double MultiThreadVectorOperations::ComputeSumWorkStealing(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const std::size_t grain = AdaptiveGrain(vec.size(), sizeof(double), pool.size());
+	std::vector<double> Partial_Sums(NumOfGrains(vec.size(), grain));
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelForStealing(Partial_Sums.size(), [&](std::size_t chunk) {
+		const std::size_t start = chunk * grain;
+		Partial_Sums[chunk] = kernels.sum(vec.data() + start, std::min(vec.size(), start + grain) - start);
+		});
+	return std::accumulate(Partial_Sums.begin(), Partial_Sums.end(), 0.0);
+}
+
+// Method (42) Multi threaded product on the work-stealing scheduler
+double MultiThreadVectorOperations::ComputeProductWorkStealing(bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	const std::size_t grain = AdaptiveGrain(vec.size(), sizeof(double), pool.size());
+	std::vector<double> Partial_Products(NumOfGrains(vec.size(), grain));
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelForStealing(Partial_Products.size(), [&](std::size_t chunk) {
+		const std::size_t start = chunk * grain;
+		Partial_Products[chunk] = kernels.product(vec.data() + start, std::min(vec.size(), start + grain) - start);
+		});
+	return std::accumulate(Partial_Products.begin(), Partial_Products.end(), 1.0, std::multiplies<double>());
+}
+
+// Method (43) Multi threaded inclusive prefix sum on the work-stealing scheduler
+// The two passes of method 32, over cache-sized chunks: chunk sums (but the last), their exclusive scan, then every
+// chunk from its offset
+void MultiThreadVectorOperations::ComputeInclusiveScanWorkStealing(std::vector<double>& out, double init, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	out.resize(vec.size());
+	const SimdKernels& kernels = BestSimdKernels();
+	if (pool.size() == 1) {
+		// Nobody to steal: one pass, like method 32 on a single thread
+		kernels.inclusive_scan(vec.data(), vec.size(), out.data(), init);
+		return;
+	}
+	const std::size_t grain = AdaptiveGrain(vec.size(), sizeof(double), pool.size());
+	std::vector<double> Offsets(NumOfGrains(vec.size(), grain));
+	pool.ParallelForStealing(Offsets.size() - (Offsets.empty() ? 0 : 1), [&](std::size_t chunk) {
+		const std::size_t start = chunk * grain;
+		Offsets[chunk] = kernels.sum(vec.data() + start, std::min(vec.size(), start + grain) - start);
+		});
+	double offset = init;
+	for (double& partial : Offsets) {
+		const double chunk_sum = partial;
+		partial = offset;
+		offset += chunk_sum;
+	}
+	pool.ParallelForStealing(Offsets.size(), [&](std::size_t chunk) {
+		const std::size_t start = chunk * grain;
+		kernels.inclusive_scan(vec.data() + start, std::min(vec.size(), start + grain) - start, out.data() + start, Offsets[chunk]);
+		});
+}
+
+// Method (44) Multi threaded adjacent difference on the work-stealing scheduler
+void MultiThreadVectorOperations::ComputeAdjDiffWorkStealing(std::vector<double>& diff, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	diff.resize(vec.size());
+	const std::size_t grain = AdaptiveGrain(vec.size(), sizeof(double), pool.size());
+	const SimdKernels& kernels = BestSimdKernels();
+	pool.ParallelForStealing(NumOfGrains(vec.size(), grain), [&](std::size_t chunk) {
+		const std::size_t start = chunk * grain;
+		diff[start] = start == 0 ? vec[0] : vec[start] - vec[start - 1];
+		kernels.adjacent_difference(vec.data() + start, std::min(vec.size(), start + grain) - start, diff.data() + start);
+		});
+}
+
+// Method (60) Multi threaded adjacent difference into caller memory, non-temporal stores beyond the last-level cache
+bool MultiThreadVectorOperations::ComputeAdjDiffThreadPoolInto(std::span<double> diff, bool Time) const {
+	Timer timeit(Time);
+	ProfileScope profile(__func__);
+	if (diff.size() != vec.size()) {
+		return false;
+	}
+	const SimdKernels& kernels = BestSimdKernels();
+	// The task captures one reference, so std::function stores it inline instead of allocating
+	const struct {
+		std::span<const double> vec;
+		double* diff;
+		void (*adjacent_difference)(const double*, std::size_t, double*);
+		unsigned int NumOfThreads;
+	} job{vec, diff.data(), UseNonTemporalStores(vec.size()) ? kernels.adjacent_difference_stream : kernels.adjacent_difference, pool.size()};
+	pool.ParallelFor(job.NumOfThreads, [&job](unsigned int i) {
+		const std::size_t start = ChunkBegin(i, job.vec.size(), job.NumOfThreads);
+		const std::size_t end = ChunkBegin(i + 1, job.vec.size(), job.NumOfThreads);
+		if (start == end) {
+			return;
+		}
+		job.diff[start] = start == 0 ? job.vec[0] : job.vec[start] - job.vec[start - 1];
+		job.adjacent_difference(job.vec.data() + start, end - start, job.diff + start);
+		});
+	return true;
+}
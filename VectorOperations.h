@@ -2,19 +2,93 @@
 #define VECTOROPERATIONS_H
 
 #include "Timer.h"
+#include "ThreadPool.h"
+#include "ScaledProduct.h"
+#include "VectorStatistics.h"
+#include "CheckedInt64.h"
+#include "OutputBuffers.h"
 #include <vector>
+#include <span>
 #include <atomic>
+#include <algorithm>
+#include <cstdint>
 
-class VectorOperationsBase {
+// All operations read the data through the span `vec`.
+// Constructing from a std::vector copies it into `storage` (owning mode), so the
+// object stays valid after the caller's vector goes away.
+// Constructing from a std::span (view mode) copies nothing: the operations run
+// directly on caller-owned memory (a vector, a raw buffer, an mmapped region...).
+// In view mode the caller must keep that memory alive and unmodified for as long
+// as the object is used; the object never frees or writes to it.
+template <typename T>
+class BasicVectorOperationsBase {
 protected:
-    const std::vector<double> vec;
+    const std::vector<T> storage; // empty in view mode
+    const std::span<const T> vec;
+    const bool owning;
 public:
-    VectorOperationsBase(const std::vector<double>& vec) : vec(vec) {}
+    BasicVectorOperationsBase(const std::vector<T>& vec) : storage(vec), vec(storage), owning(true) {}
+    BasicVectorOperationsBase(std::span<const T> view) : vec(view), owning(false) {}
+    // A copy of an owning object owns its own copy; a copy of a view is another view of the same memory
+    BasicVectorOperationsBase(const BasicVectorOperationsBase& other)
+        : storage(other.storage), vec(other.owning ? std::span<const T>(storage) : other.vec), owning(other.owning) {}
+
+    bool IsView() const { return !owning; }
+    std::size_t size() const { return vec.size(); }
+};
+
+using VectorOperationsBase = BasicVectorOperationsBase<double>;
+
+// Accumulator used when none is given: double for float data (float storage, double accumulation),
+// the overflow-checked CheckedInt64 for int64 data
+template <typename T> struct DefaultAccumulator { using type = T; };
+template <> struct DefaultAccumulator<float> { using type = double; };
+template <> struct DefaultAccumulator<std::int64_t> { using type = CheckedInt64; };
+
+// Element types other than double: <float, float>, <float, double> and <std::int64_t, CheckedInt64>
+// (the pairs TypedSimdKernels.h has kernels for). They run directly on the float or int64 data, without a
+// conversion to double, and offer the methods below under the same numbers as the double classes.
+// The double classes, SimpleVectorOperations and MultiThreadVectorOperations, are the <double, double>
+// specializations further down, with every method.
+// Syntax: double s = BasicSimpleVectorOperations<float>(std::span<const float>(data)).sumSimd(false);
+template <typename T, typename Acc = typename DefaultAccumulator<T>::type>
+class BasicSimpleVectorOperations : public BasicVectorOperationsBase<T> {
+public:
+    using BasicVectorOperationsBase<T>::BasicVectorOperationsBase;
+
+    Acc sum1(bool Time = true) const;
+    Acc product1(bool Time = true) const;
+    void adjacent_difference2(std::vector<T>& diff, bool Time = true) const;
+    Acc sumSimd(bool Time = true) const;
+    Acc productSimd(bool Time = true) const;
+    void adjacent_differenceSimd(std::vector<T>& diff, bool Time = true) const;
+};
+
+template <typename T, typename Acc = typename DefaultAccumulator<T>::type>
+class BasicMultiThreadVectorOperations : public BasicVectorOperationsBase<T> {
+private:
+    ThreadPool& pool;
+public:
+    BasicMultiThreadVectorOperations(const std::vector<T>& vec, ThreadPool& pool = ThreadPool::Global()) : BasicVectorOperationsBase<T>(vec), pool(pool) {}
+    BasicMultiThreadVectorOperations(std::span<const T> view, ThreadPool& pool = ThreadPool::Global()) : BasicVectorOperationsBase<T>(view), pool(pool) {}
+
+    Acc ComputeSumThreadPool(bool Time = true) const;
+    Acc ComputeProductThreadPool(bool Time = true) const;
+    void ComputeAdjDiffThreadPool(std::vector<T>& diff, bool Time = true) const;
 };
 
-class SimpleVectorOperations : public VectorOperationsBase {
+extern template class BasicSimpleVectorOperations<float, float>;
+extern template class BasicSimpleVectorOperations<float, double>;
+extern template class BasicSimpleVectorOperations<std::int64_t, CheckedInt64>;
+extern template class BasicMultiThreadVectorOperations<float, float>;
+extern template class BasicMultiThreadVectorOperations<float, double>;
+extern template class BasicMultiThreadVectorOperations<std::int64_t, CheckedInt64>;
+
+template <>
+class BasicSimpleVectorOperations<double, double> : public VectorOperationsBase {
 public:
-    SimpleVectorOperations(const std::vector<double>& vec) : VectorOperationsBase(vec) {}
+    BasicSimpleVectorOperations(const std::vector<double>& vec) : VectorOperationsBase(vec) {}
+    BasicSimpleVectorOperations(std::span<const double> view) : VectorOperationsBase(view) {}
 
     double sum1(bool Time = true) const;
     double sum2(bool Time = true) const;
@@ -24,13 +98,48 @@ public:
     void adjacent_difference1(std::vector<double>& diff, bool Time = true) const;
     void adjacent_difference2(std::vector<double>& diff, bool Time = true) const;
     void adjacent_difference3(std::unique_ptr<double[]>& diff, bool Time = true) const;
+    // Methods 18-20 run the SIMD kernels of the best instruction set of the host (see SimdKernels.h)
+    double sumSimd(bool Time = true) const;
+    double productSimd(bool Time = true) const;
+    void adjacent_differenceSimd(std::vector<double>& diff, bool Time = true) const;
+    // Method 21: Neumaier summation on SIMD lanes, about as accurate as method 3 at close to the speed of method 18
+    double NeumaierSummationSimd(bool Time = true) const;
+    // Method 22: pairwise summation over SIMD-summed blocks, error grows with log2(N) instead of N
+    double PairwiseSummation(bool Time = true) const;
+    // Method 56: exact sum correctly rounded to nearest (one rounding, whatever the order), see Superaccumulator.h;
+    // the reference the other summation methods are checked against
+    double ExactSum(bool Time = true) const;
+    // Method 26: overflow-safe product as (sign, mantissa, exponent), see ScaledProduct.h
+    ScaledProduct productScaled(bool Time = true) const;
+    // Method 28: the statistics selected by `flags` (StatisticFlags) in one pass over the data
+    VectorStatistics Statistics(unsigned int flags = StatAll, bool Time = true) const;
+    // Methods 30 and 31: inclusive (out[i] = init + vec[0] + ... + vec[i]) and exclusive (out[i] = init + vec[0] + ... + vec[i - 1])
+    // prefix sums with the SIMD kernels. Method 7 applied to the inclusive scan (init = 0) gives vec back, up to rounding.
+    void inclusive_scanSimd(std::vector<double>& out, double init = 0.0, bool Time = true) const;
+    void exclusive_scanSimd(std::vector<double>& out, double init = 0.0, bool Time = true) const;
+    // Methods 58 and 59: adjacent difference as method 20 without allocating, for repeated calls. Method 58 writes to
+    // caller memory not overlapping vec (false if diff.size() differs from the size), method 59 to a buffer of `arena`,
+    // recycled when the lease is dropped. Large outputs are written with non-temporal stores (UseNonTemporalStores).
+    bool adjacent_differenceInto(std::span<double> diff, bool Time = true) const;
+    BufferArena::Lease adjacent_differenceArena(BufferArena& arena, bool Time = true) const;
 };
 
-class MultiThreadVectorOperations : public VectorOperationsBase {
+using SimpleVectorOperations = BasicSimpleVectorOperations<double>;
+
+// Methods 9-14 create NumOfSpawnedThreads threads on every call (hardware_concurrency() unless set);
+// methods 15 and up dispatch through `pool`, a persistent ThreadPool (the process-wide one unless
+// another is given), and keep their per-thread partial results in CacheLinePadded slots.
+template <>
+class BasicMultiThreadVectorOperations<double, double> : public VectorOperationsBase {
 private:
     std::atomic<double> sum{0.0};
+    ThreadPool& pool;
+    unsigned int NumOfSpawnedThreads = std::max(1u, std::thread::hardware_concurrency());
 public:
-    MultiThreadVectorOperations(const std::vector<double>& vec) : VectorOperationsBase(vec) {}
+    BasicMultiThreadVectorOperations(const std::vector<double>& vec, ThreadPool& pool = ThreadPool::Global()) : VectorOperationsBase(vec), pool(pool) {}
+    BasicMultiThreadVectorOperations(std::span<const double> view, ThreadPool& pool = ThreadPool::Global()) : VectorOperationsBase(view), pool(pool) {}
+
+    void SetNumOfSpawnedThreads(unsigned int NumOfThreads) { NumOfSpawnedThreads = std::max(1u, NumOfThreads); }
 
     double ComputeSumMultiThreadSum1(bool Time = true);
     double ComputeSumMultiThreadSum2(bool Time = true);
@@ -39,6 +148,36 @@ public:
     double ComputeSumMultiThreadProduct(bool Time = true);
     void ComputeAdjDiffMultiThread1(std::vector<double>& diff, bool Time = true) const;
     void ComputeAdjDiffMultiThread2(std::vector<double>& diff, bool Time = true) const;
+    double ComputeSumThreadPool(bool Time = true) const;
+    double ComputeProductThreadPool(bool Time = true) const;
+    void ComputeAdjDiffThreadPool(std::vector<double>& diff, bool Time = true) const;
+    double ComputeCompensatedSumThreadPool(bool Time = true) const;
+    // Method 57: method 56 on the pool, per-thread superaccumulators merged exactly (same bits for any pool size)
+    double ComputeExactSumThreadPool(bool Time = true) const;
+    // Methods 24 and 25 give the same bits for any pool size, scheduling order and SIMD level:
+    // fixed 8192-element blocks reduced by the ordered SIMD kernels, then a fixed pairwise tree over the blocks
+    double ComputeSumDeterministic(bool Time = true) const;
+    double ComputeProductDeterministic(bool Time = true) const;
+    ScaledProduct ComputeProductScaledThreadPool(bool Time = true) const;
+    VectorStatistics ComputeStatisticsThreadPool(unsigned int flags = StatAll, bool Time = true) const;
+    // Methods 32 and 33: the scans of methods 30 and 31 on the pool, in two passes over the data: the chunks are summed,
+    // the chunk sums are scanned into per-chunk offsets, then every chunk is scanned starting from its offset
+    void ComputeInclusiveScanThreadPool(std::vector<double>& out, double init = 0.0, bool Time = true) const;
+    void ComputeExclusiveScanThreadPool(std::vector<double>& out, double init = 0.0, bool Time = true) const;
+    // Method 34, the in-place adjacent difference, is AdjDiffInPlace (ThreadPool.h): it writes to caller memory, which a
+    // view object must never do to the data it reads
+    // Methods 41-44: sum, product, inclusive scan (as method 32) and adjacent difference (as method 17, diff is resized)
+    // on the work-stealing scheduler (ThreadPool::ParallelForStealing) in cache-sized chunks (AdaptiveGrain) instead
+    // of one static chunk per thread. Per-chunk results are merged in chunk order, so the results do not depend on
+    // which thread ran which chunk.
+    double ComputeSumWorkStealing(bool Time = true) const;
+    double ComputeProductWorkStealing(bool Time = true) const;
+    void ComputeInclusiveScanWorkStealing(std::vector<double>& out, double init = 0.0, bool Time = true) const;
+    void ComputeAdjDiffWorkStealing(std::vector<double>& diff, bool Time = true) const;
+    // Method 60: method 17 into caller memory as method 58, without allocating
+    bool ComputeAdjDiffThreadPoolInto(std::span<double> diff, bool Time = true) const;
 };
 
+using MultiThreadVectorOperations = BasicMultiThreadVectorOperations<double>;
+
 #endif
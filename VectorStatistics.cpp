@@ -0,0 +1,85 @@
+#include "VectorStatistics.h"
+#include <algorithm>
+#include <limits>
+
+double VectorStatistics::Variance(bool Sample) const {
+	if (count < (Sample ? 2u : 1u)) {
+		return 0.0;
+	}
+	return m2 / static_cast<double>(Sample ? count - 1 : count);
+}
+
+void VectorStatistics::Merge(const VectorStatistics& other) {
+	if (other.count == 0) {
+		return;
+	}
+	if (count == 0) {
+		*this = other;
+		return;
+	}
+	const double n = static_cast<double>(count + other.count);
+	if (flags & (StatMean | StatVariance)) {
+		// Chan et al.: combine (count, mean, m2) of two disjoint parts
+		const double delta = other.mean - mean;
+		mean += delta * (static_cast<double>(other.count) / n);
+		m2 += other.m2 + delta * delta * (static_cast<double>(count) * static_cast<double>(other.count) / n);
+	}
+	if (flags & StatSum) {
+		sum += other.sum;
+	}
+	if (flags & StatCompensatedSum) {
+		compensated_sum.Merge(other.compensated_sum);
+	}
+	if (flags & StatProduct) {
+		product *= other.product;
+	}
+	if (flags & StatMinMax) {
+		// Ties keep this part's index: it comes first
+		if (other.min_max.min < min_max.min || min_max.min_index == std::numeric_limits<std::size_t>::max()) {
+			min_max.min = other.min_max.min;
+			min_max.min_index = other.min_max.min_index;
+		}
+		if (other.min_max.max > min_max.max || min_max.max_index == std::numeric_limits<std::size_t>::max()) {
+			min_max.max = other.min_max.max;
+			min_max.max_index = other.min_max.max_index;
+		}
+	}
+	count += other.count;
+}
+
+VectorStatistics ComputeStatistics(const double* data, std::size_t size, unsigned int flags, std::size_t IndexOffset) {
+	const SimdKernels& kernels = BestSimdKernels();
+	VectorStatistics result;
+	result.flags = flags;
+	result.min_max = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+		std::numeric_limits<std::size_t>::max(), std::numeric_limits<std::size_t>::max()};
+
+	for (std::size_t start = 0; start < size; start += VectorStatistics::BlockSize) {
+		const double* block = data + start;
+		const std::size_t n = std::min(VectorStatistics::BlockSize, size - start);
+		VectorStatistics partial;
+		partial.flags = flags;
+		partial.count = n;
+		if (flags & (StatSum | StatMean | StatVariance)) {
+			partial.sum = kernels.sum(block, n);
+			partial.mean = partial.sum / static_cast<double>(n);
+		}
+		if (flags & StatVariance) {
+			partial.m2 = kernels.squared_deviation(block, n, partial.mean);
+		}
+		if (flags & StatCompensatedSum) {
+			partial.compensated_sum = kernels.compensated_sum(block, n);
+		}
+		if (flags & StatProduct) {
+			partial.product = kernels.product(block, n);
+		}
+		if (flags & StatMinMax) {
+			partial.min_max = kernels.min_max(block, n);
+			// A block without a usable element keeps the "none" index so that later blocks can still win
+			partial.min_max.min_index = partial.min_max.min_index == n ? std::numeric_limits<std::size_t>::max() : partial.min_max.min_index + start + IndexOffset;
+			partial.min_max.max_index = partial.min_max.max_index == n ? std::numeric_limits<std::size_t>::max() : partial.min_max.max_index + start + IndexOffset;
+		}
+		result.Merge(partial);
+	}
+	return result;
+}
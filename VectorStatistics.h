@@ -0,0 +1,45 @@
+#ifndef VECTORSTATISTICS_H
+#define VECTORSTATISTICS_H
+
+#include "SimdKernels.h"
+#include <cstddef>
+
+// Statistics a fused pass can compute; combine them with |
+enum StatisticFlags : unsigned int {
+    StatSum = 1,             // plain sum (SIMD accumulators, like method 18)
+    StatCompensatedSum = 2,  // Neumaier sum (like method 21)
+    StatProduct = 4,         // plain product (like method 19), no overflow protection
+    StatMinMax = 8,          // min and max with the index of their first occurrence, NaNs ignored
+    StatMean = 16,
+    StatVariance = 32,       // also gives the mean
+    StatAll = 63
+};
+
+// Result of one fused pass over a vector. Only the fields of the requested statistics are meaningful;
+// min_index/max_index are SIZE_MAX when no element qualifies (empty or all-NaN data).
+// The data is streamed once: each block of BlockSize elements is read from memory once and every requested
+// kernel runs on it while it is still in L1. Mean and variance are kept as (count, mean, m2) per block,
+// m2 being the sum of squared deviations from the block mean, and blocks are merged with Chan's
+// parallel form of Welford's update, which is also how per-thread results are merged.
+struct VectorStatistics {
+    static constexpr std::size_t BlockSize = 512;
+
+    unsigned int flags = 0;
+    std::size_t count = 0;
+    double sum = 0.0;
+    CompensatedSum compensated_sum;
+    double product = 1.0;
+    MinMaxIndex min_max{};
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    // Population variance (divides by count), or sample variance (count - 1) if Sample is set
+    double Variance(bool Sample = false) const;
+    // Appends the statistics of the elements that follow this one's; other's indices must already be absolute
+    void Merge(const VectorStatistics& other);
+};
+
+// Fused statistics of data[0, size); IndexOffset is added to the min/max indices
+VectorStatistics ComputeStatistics(const double* data, std::size_t size, unsigned int flags, std::size_t IndexOffset = 0);
+
+#endif
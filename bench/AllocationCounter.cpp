@@ -0,0 +1,49 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::size_t> Allocations{0};
+}
+
+std::size_t HeapAllocations() {
+	return Allocations.load(std::memory_order_relaxed);
+}
+
+// Replace the global operator new of VectorOperationBench, plain and over-aligned (CacheLinePadded slots);
+// new[] and the nothrow forms call these
+void* operator new(std::size_t size) {
+	Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size ? size : 1)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	Allocations.fetch_add(1, std::memory_order_relaxed);
+	const std::size_t align = static_cast<std::size_t>(alignment);
+	if (void* memory = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
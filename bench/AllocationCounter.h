@@ -0,0 +1,12 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+// Allocations made through operator new, plain or over-aligned (and so new[] and the nothrow forms), since the
+// process started.
+// The counting operator new is in AllocationCounter.cpp, linked into VectorOperationBench only: the library and the
+// test binary keep the default allocator.
+std::size_t HeapAllocations();
+
+#endif
@@ -0,0 +1,295 @@
+// Benchmark binary, separate from the test executable (see "Benchmark harness" in the README).
+// Build: g++ -std=c++20 -O2 -fopenmp -I. bench/*.cpp $(ls *.cpp | grep -v '^main.cpp$') -o VectorOperationBench
+#include "BenchmarkHarness.h"
+#include "VectorOperations.h"
+#include "AllocationCounter.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <span>
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <memory>
+#include <thread>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+#include <unistd.h>
+#include <stdexcept>
+
+namespace
+{
+	// Results of the reductions, so the calls are not optimized away
+	volatile double Sink = 0.0;
+
+	struct Settings {
+		std::size_t MinSize = 1000;
+		std::size_t MaxSize = 100000000;
+		std::vector<unsigned int> Threads;
+		bool Hot = true;
+		bool Cold = false;
+		bool Allocations = false;
+		std::string Filter;
+		std::string JsonPath;
+		std::string CsvPath;
+		std::string BaselinePath;
+		double Threshold = 0.05;
+		BenchmarkOptions Options;
+	};
+
+	void Usage() {
+		std::cout << "Usage: VectorOperationBench [options]\n"
+			<< "  --min-size N, --max-size N  sweep N over the powers of ten in [min, max] (default 1e3 to 1e8, min >= 1, max <= 1e9)\n"
+			<< "  --threads 1,2,4             pool sizes of the multithreaded cases (default 1 and the hardware threads)\n"
+			<< "  --cache hot|cold|both       data left in cache, or caches flushed before every sample (default hot)\n"
+			<< "  --filter text               only the cases whose name contains text\n"
+			<< "  --max-seconds s             sampling budget per case (default 2)\n"
+			<< "  --precision p               target relative standard error of the median (default 0.01)\n"
+			<< "  --json path, --csv path     write the results\n"
+			<< "  --compare baseline.csv      flag regressions against a CSV written by --csv; exit code 1 if any\n"
+			<< "  --threshold t               relative slowdown counted as a regression (default 0.05)\n"
+			<< "  --counters                  one more profiled call per case: hardware counters, thread startup and skew\n"
+			<< "                              (needs a build with -DVECTOROPERATIONS_PERF and perf events allowed)\n"
+			<< "  --allocations               instead of the sweep, time and heap allocations per call of the adjacent\n"
+			<< "                              difference into a new vector vs. reused memory (methods 7, 17, 20, 44, 58-60)\n";
+	}
+
+	// Whole value of a size option ("1e6" is accepted); throws std::invalid_argument for text, trailing characters or a negative value
+	std::size_t ParseSize(const std::string& value) {
+		std::size_t parsed = 0;
+		const double size = std::stod(value, &parsed);
+		if (parsed != value.size() || !(size >= 0.0) || size > 1e18) {
+			throw std::invalid_argument(value);
+		}
+		return static_cast<std::size_t>(size);
+	}
+
+	// False (the usage is printed) for --help, an unknown option, a missing or malformed value, or --min-size 0
+	bool Parse(int argc, char* argv[], Settings& settings) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string option = argv[i];
+			if (option == "--help") {
+				return false;
+			}
+			if (option == "--counters") {
+				settings.Options.Counters = true;
+				continue;
+			}
+			if (option == "--allocations") {
+				settings.Allocations = true;
+				continue;
+			}
+			if (i + 1 >= argc) {
+				std::cerr << "Missing value for " << option << "\n";
+				return false;
+			}
+			const std::string value = argv[++i];
+			try {
+				if (option == "--min-size") settings.MinSize = ParseSize(value);
+				else if (option == "--max-size") settings.MaxSize = std::min<std::size_t>(ParseSize(value), 1000000000);
+				else if (option == "--threads") {
+					settings.Threads.clear();
+					std::stringstream list(value);
+					for (std::string count; std::getline(list, count, ',');) {
+						settings.Threads.push_back(static_cast<unsigned int>(std::max(1, std::stoi(count))));
+					}
+				}
+				else if (option == "--cache") {
+					settings.Hot = value == "hot" || value == "both";
+					settings.Cold = value == "cold" || value == "both";
+				}
+				else if (option == "--filter") settings.Filter = value;
+				else if (option == "--max-seconds") settings.Options.MaxSeconds = std::stod(value);
+				else if (option == "--precision") settings.Options.RelativePrecision = std::stod(value);
+				else if (option == "--json") settings.JsonPath = value;
+				else if (option == "--csv") settings.CsvPath = value;
+				else if (option == "--compare") settings.BaselinePath = value;
+				else if (option == "--threshold") settings.Threshold = std::stod(value);
+				else {
+					std::cerr << "Unknown option " << option << "\n";
+					return false;
+				}
+			}
+			catch (const std::exception&) {
+				std::cerr << "Invalid value " << value << " for " << option << "\n";
+				return false;
+			}
+		}
+		// The sweep multiplies N by ten from MinSize, so it needs MinSize >= 1
+		if (settings.MinSize == 0) {
+			std::cerr << "--min-size must be at least 1\n";
+			return false;
+		}
+		if (settings.Threads.empty()) {
+			settings.Threads = {1};
+			if (std::thread::hardware_concurrency() > 1) {
+				settings.Threads.push_back(std::thread::hardware_concurrency());
+			}
+		}
+		return settings.Hot || settings.Cold;
+	}
+
+	// Cases of size N: single thread methods once, multithreaded methods once per pool
+	std::vector<BenchmarkCase> Cases(const std::vector<double>& data, std::vector<double>& out, const std::vector<std::unique_ptr<ThreadPool>>& pools) {
+		const std::size_t N = data.size(), Read = N * sizeof(double), ReadWrite = 2 * Read;
+		const std::span<const double> view(data);
+		std::vector<BenchmarkCase> cases = {
+			{"sum_accumulate", N, 1, Read, [=] { Sink = SimpleVectorOperations(view).sum2(false); }},
+			{"sum_simd", N, 1, Read, [=] { Sink = SimpleVectorOperations(view).sumSimd(false); }},
+			{"sum_neumaier_simd", N, 1, Read, [=] { Sink = SimpleVectorOperations(view).NeumaierSummationSimd(false); }},
+			{"sum_exact", N, 1, Read, [=] { Sink = SimpleVectorOperations(view).ExactSum(false); }},
+			{"product_simd", N, 1, Read, [=] { Sink = SimpleVectorOperations(view).productSimd(false); }},
+			{"adjacent_difference_simd", N, 1, ReadWrite, [=, &out] { SimpleVectorOperations(view).adjacent_differenceSimd(out, false); }},
+		};
+		for (const auto& pool : pools) {
+			ThreadPool* p = pool.get();
+			const unsigned int threads = p->size();
+			cases.push_back({"sum_thread_pool", N, threads, Read, [=] { Sink = MultiThreadVectorOperations(view, *p).ComputeSumThreadPool(false); }});
+			cases.push_back({"sum_work_stealing", N, threads, Read, [=] { Sink = MultiThreadVectorOperations(view, *p).ComputeSumWorkStealing(false); }});
+			cases.push_back({"sum_exact_thread_pool", N, threads, Read, [=] { Sink = MultiThreadVectorOperations(view, *p).ComputeExactSumThreadPool(false); }});
+			cases.push_back({"product_thread_pool", N, threads, Read, [=] { Sink = MultiThreadVectorOperations(view, *p).ComputeProductThreadPool(false); }});
+			cases.push_back({"adjacent_difference_thread_pool", N, threads, ReadWrite, [=, &out] { MultiThreadVectorOperations(view, *p).ComputeAdjDiffThreadPool(out, false); }});
+		}
+		return cases;
+	}
+
+	// (Output buffers) Adjacent difference into a new vector every call vs. into reused memory: a reused vector (method 20),
+	// caller memory (58), an arena buffer (59), the pool (17 vs. 60) and the work-stealing scheduler (44). Heap
+	// allocations per call are counted after a warm-up call, through operator new, plain and over-aligned
+	// (AllocationCounter.h), and the arena's own allocations.
+	void OutputAllocations() {
+		std::cout << "Time (ms) and heap allocations per call, adjacent difference outputs\n";
+		std::mt19937_64 engine(20);
+		std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+		for (std::size_t N : {100000, 10000000}) {
+			std::vector<double> V(N);
+			for (double& x : V) {
+				x = Uniform(engine);
+			}
+			SimpleVectorOperations operations{std::span<const double>(V)};
+			MultiThreadVectorOperations MToperations{std::span<const double>(V)};
+			// At least two threads, so the scheduler runs (and allocates its deques) even on one CPU
+			ThreadPool StealingPool(std::max(2u, std::thread::hardware_concurrency()));
+			MultiThreadVectorOperations Stealing{std::span<const double>(V), StealingPool};
+			std::vector<double> reused;
+			AlignedBuffer buffer(N);
+			BufferArena arena;
+			const std::size_t Calls = std::max<std::size_t>(5, 100000000 / N);
+			std::cout << "N = " << N << (UseNonTemporalStores(N) ? " (non-temporal stores)" : " (cached stores)") << "\n";
+			auto Report = [&](const char* Name, const std::function<void()>& call) {
+				call();
+				const std::size_t Before = HeapAllocations() + arena.Allocations();
+				const auto start = std::chrono::high_resolution_clock::now();
+				for (std::size_t i = 0; i < Calls; ++i) {
+					call();
+				}
+				const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / Calls;
+				const double Allocations = static_cast<double>(HeapAllocations() + arena.Allocations() - Before) / Calls;
+				std::cout << "  " << std::left << std::setw(34) << Name << std::right << std::setw(10) << ms << " ms, "
+					<< std::setw(8) << 2 * N * sizeof(double) / (ms * 1e6) << " GB/s, " << Allocations << " allocations\n";
+			};
+			Report("Method 7, new vector", [&] { std::vector<double> diff; operations.adjacent_difference2(diff, false); });
+			Report("Method 20, reused vector", [&] { operations.adjacent_differenceSimd(reused, false); });
+			Report("Method 58, aligned caller buffer", [&] { operations.adjacent_differenceInto(buffer.span(), false); });
+			Report("Method 59, arena", [&] { BufferArena::Lease diff = operations.adjacent_differenceArena(arena, false); });
+			Report("Method 17, new vector", [&] { std::vector<double> diff(N); MToperations.ComputeAdjDiffThreadPool(diff, false); });
+			Report("Method 60, aligned caller buffer", [&] { MToperations.ComputeAdjDiffThreadPoolInto(buffer.span(), false); });
+			Report("Method 44, work stealing, reused", [&] { Stealing.ComputeAdjDiffWorkStealing(reused, false); });
+		}
+	}
+
+	std::size_t PhysicalMemoryBytes() {
+		return static_cast<std::size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Settings settings;
+	if (!Parse(argc, argv, settings)) {
+		Usage();
+		return 2;
+	}
+	if (settings.Allocations) {
+		OutputAllocations();
+		return 0;
+	}
+	std::vector<std::unique_ptr<ThreadPool>> pools;
+	for (unsigned int threads : settings.Threads) {
+		pools.push_back(std::make_unique<ThreadPool>(threads));
+	}
+	std::vector<BenchmarkResult> results;
+	std::mt19937_64 engine(21);
+	std::uniform_real_distribution<double> distribution(0.999, 1.001); // keeps products finite at every size
+	std::cout << std::left << std::setw(34) << "case" << std::right << std::setw(12) << "N" << std::setw(8) << "threads" << std::setw(6) << "cache"
+		<< std::setw(9) << "samples" << std::setw(14) << "median ns" << std::setw(14) << "p95 ns" << std::setw(14) << "min ns"
+		<< std::setw(10) << "GB/s" << std::setw(12) << "elem/ns" << "\n";
+	for (std::size_t N = settings.MinSize; N <= settings.MaxSize; N *= 10) {
+		// Input and output vectors, plus headroom for the rest of the process
+		if (4 * N * sizeof(double) > PhysicalMemoryBytes()) {
+			std::cout << "N = " << N << " skipped: not enough memory\n";
+			break;
+		}
+		std::vector<double> data(N), out(N);
+		for (double& x : data) {
+			x = distribution(engine);
+		}
+		for (const BenchmarkCase& benchmark : Cases(data, out, pools)) {
+			if (benchmark.name.find(settings.Filter) == std::string::npos) {
+				continue;
+			}
+			for (bool cold : {false, true}) {
+				if (cold ? !settings.Cold : !settings.Hot) {
+					continue;
+				}
+				BenchmarkOptions options = settings.Options;
+				options.FlushCache = cold;
+				const BenchmarkResult r = RunBenchmark(benchmark, options);
+				std::cout << std::left << std::setw(34) << r.name << std::right << std::setw(12) << r.elements << std::setw(8) << r.threads
+					<< std::setw(6) << r.cache << std::setw(9) << r.samples << (r.stable ? " " : "*") << std::setw(13) << r.median_ns
+					<< std::setw(14) << r.p95_ns << std::setw(14) << r.min_ns << std::setw(10) << std::setprecision(4) << r.gb_per_s
+					<< std::setw(12) << r.elements_per_ns << std::setprecision(6) << "\n";
+				if (settings.Options.Counters) {
+					std::cout << "    ";
+					if (r.counts.valid) {
+						std::cout << "cycles " << r.counts.cycles << ", IPC " << std::setprecision(3) << r.counts.InstructionsPerCycle()
+							<< ", LLC misses " << r.counts.llc_misses << ", branch misses " << r.counts.branch_misses << std::setprecision(6) << ", ";
+					}
+					else {
+						std::cout << "no counters, ";
+					}
+					std::cout << "startup " << r.startup_ns << " ns, skew " << r.skew_ns << " ns\n";
+				}
+				results.push_back(r);
+			}
+		}
+	}
+	std::cout << "(* median not stable within the time budget)\n";
+	if (!settings.JsonPath.empty()) {
+		std::ofstream file(settings.JsonPath);
+		WriteBenchmarkJson(file, results);
+	}
+	if (!settings.CsvPath.empty()) {
+		std::ofstream file(settings.CsvPath);
+		WriteBenchmarkCsv(file, results);
+	}
+	if (settings.BaselinePath.empty()) {
+		return 0;
+	}
+	std::vector<BenchmarkResult> baseline;
+	if (!ReadBenchmarkCsv(settings.BaselinePath, baseline)) {
+		std::cerr << "Cannot read the baseline " << settings.BaselinePath << "\n";
+		return 2;
+	}
+	int regressions = 0;
+	for (const BenchmarkComparison& c : CompareBenchmarks(baseline, results, settings.Threshold)) {
+		std::cout << (c.regression ? "REGRESSION " : "           ") << std::left << std::setw(60) << c.key << std::right
+			<< std::setw(14) << c.baseline_ns << " -> " << std::setw(14) << c.current_ns << " ns (x" << std::setprecision(3) << c.ratio << ")"
+			<< std::setprecision(6) << "\n";
+		regressions += c.regression;
+	}
+	std::cout << regressions << " regression(s)\n";
+	return regressions > 0 ? 1 : 0;
+}
@@ -1,7 +1,44 @@
 #include "VectorOperations.h"
 #include "Tests.h"
+#include "Benchmarks.h"
+#include "AutoVectorOperations.h"
+#include <string>
 
-int main() {
+int main(int argc, char* argv[]) {
+	// Run the benchmarks instead of the tests: <executable> --bench
+	if (argc > 1 && std::string(argv[1]) == "--bench") {
+		bench1();
+		bench2();
+		bench3();
+		bench4();
+		bench5();
+		bench6();
+		bench7();
+		bench8();
+		bench9();
+		bench10();
+		bench11();
+		bench12();
+		bench13();
+		bench14();
+		bench15();
+		bench16();
+		bench17();
+		bench18();
+		bench19();
+		bench20();
+		bench21();
+		return 0;
+	}
+	// Measure the crossover table of AutoVectorOperations on this host and save it:
+	// <executable> --calibrate [path], the default path being CrossoverTable::DefaultPath()
+	if (argc > 1 && std::string(argv[1]) == "--calibrate") {
+		std::string path = argc > 2 ? argv[2] : CrossoverTable::DefaultPath();
+		CrossoverTable table = CrossoverTable::Calibrate();
+		std::cout << "Crossover sizes on " << table.NumOfThreads << " threads: sum " << table.SumThreshold << ", product "
+			<< table.ProductThreshold << ", adjacent difference " << table.AdjDiffThreshold << "\n";
+		return table.Save(path) ? 0 : 1;
+	}
 	// (Sanity Check) Vector of size 7 with positive and negative floating point of the same order of magnitude
 	// Making sure all 14 Methods Pass it
 	test1();
@@ -29,4 +66,79 @@ int main() {
 	// Results of all three agree for the V(11), but for V(10e6) and V(10e7) Methods 1 and 2 agree, but Method 3 is a bit different 
 	// which is the more acurrate version!
 	test5();
-}	
+	// (View mode) The operations run on a raw buffer through std::span without copying it,
+	// and must agree with the owning (copying) mode
+	test6();
+	// (Thread pool) Methods 15-17 dispatch through a persistent ThreadPool; checked against the single
+	// thread methods for several pool sizes, with and without CPU pinning, and for nested ParallelFor calls
+	test7();
+	// (Auto dispatch) AutoVectorOperations picks the single thread or thread pool kernel from the vector size;
+	// its results must match the single thread methods, and the crossover table must round-trip through its file
+	test8();
+	// (SIMD kernels) The scalar, SSE2, AVX2 and AVX-512 kernels behind methods 18-20 (those the host supports)
+	// must match methods 1, 4 and 7 within the tolerance documented in SimdKernels.h, exactly for the adjacent difference
+	test9();
+	// (Compensated summation) Methods 21-23 keep the small addends that the naive sum and Kahan's lose
+	// on {1e16, 1, -1e16} data, and stay within their error bounds on random data
+	test10();
+	// (Deterministic reductions) Methods 24 and 25 return the same bits for every pool size, run and SIMD level
+	test11();
+	// (Scaled product) Methods 26 and 27 keep products far beyond the double range as (sign, mantissa, exponent)
+	// and handle zeros, infinities and subnormals
+	test12();
+	// (Thread counts) Methods 9-14 with a chosen number of spawned threads, and the cache line padding of the slots
+	// the thread pool methods keep their partial results in
+	test13();
+	// (Fused statistics) Methods 28 and 29 compute sum, compensated sum, product, min/max with indices, mean and
+	// variance in one pass; they must match the separate computations, for any pool size
+	test14();
+	// (Prefix sums) Methods 30-33 against a sequential scan, for every instruction set and pool size, and the
+	// in-place adjacent difference (method 34) against method 7, with chunk boundaries everywhere
+	test15();
+	// (Element types) Float data with float and double accumulation, and int64 data with exact, overflow-checked
+	// sums and products, for every instruction set and pool size
+	test16();
+	// (Vector files) Binary file round trips, checksums, rejected files, and the streaming methods 35-37 on a
+	// mapped file against the in-memory methods
+	test17();
+	// (Incremental aggregates) Random point and run updates, NaNs and repeated extremes, each followed by a range
+	// query compared with the sum, product and min/max recomputed over that range
+	test18();
+	// (Lazy expressions) Diff, Scale, Add, Abs, Square and Skip chains reduced or evaluated on every backend,
+	// compared with the same steps materialized one vector at a time
+	test19();
+	// (Batched operations) Per-vector sums, products and adjacent differences of ragged batches (empty vectors,
+	// gaps, invalid offsets) vs. one SimpleVectorOperations per vector
+	test20();
+	// (Work stealing) Every chunk of the stealing scheduler runs once, with a stalled thread and nested calls;
+	// methods 41-44 vs. the static chunk methods 15-17 and 32
+	test21();
+	// (NUMA placement) NumaVector filled, copied and generated on the host topology and on a made-up two-node one;
+	// methods 45 and 46 vs. methods 15 and 17
+	test22();
+	// (Asynchronous operations) Methods 47-49: batched jobs sharing a pass, cancellation while queued and while
+	// running, callbacks, a coroutine awaiting a job and jobs left when the object is destroyed
+	test23();
+	// (Rolling windows) Methods 50-55 and RollingWindow vs. every window recomputed, with zeros, sign changes,
+	// infinities, NaNs and windows of 1, of the whole vector and larger than it
+	test24();
+	// (Exact summation) Methods 56 and 57 vs. sums known exactly: cancellation, ties, subnormals, overflow, infinities,
+	// NaNs, shuffled orders, every SIMD level and pool size
+	test25();
+	// (Benchmark harness) Quantiles and the median's error on known samples, a benchmark run to stability, the CSV
+	// baseline read back and regressions flagged only beyond the threshold and the noise
+	test26();
+	// (Performance counters) Profile summaries on known spans, profiled methods returning the same results with one span
+	// per task, nothing recorded while disabled or compiled out, and the counter columns of the benchmark CSV
+	test27();
+	// (Output buffers) Aligned and huge page buffers, arena reuse and growth, streaming kernels vs. plain ones at every
+	// output alignment and SIMD level, and methods 58-60 vs. method 7
+	test28();
+	// (Sharded operations) Methods 61-64 on local worker processes vs. the thread pool methods, from shared memory and
+	// from a vector file, with a killed and a hung worker replaced mid-call, callers on several threads sharing the
+	// workers, and shards computed by the coordinator
+	test29();
+	// (Fixed-size vectors) Methods 1-5 and 7 on std::array, unrolled at compile time: constant expressions, and bit for
+	// bit the results of SimpleVectorOperations on the data of tests 1-3 and random arrays of up to 64 elements
+	test30();
+}